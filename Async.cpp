@@ -0,0 +1,83 @@
+#include "Async.hpp"
+
+namespace matrix {
+
+namespace {
+
+// Function objects for the operations; the operands are captured by value.
+struct Multiply {
+    SquareMat operator()(const SquareMat& left, const SquareMat& right) const { return left * right; }
+};
+
+struct Add {
+    SquareMat operator()(const SquareMat& left, const SquareMat& right) const { return left + right; }
+};
+
+struct Determinant {
+    double operator()(const SquareMat& matrix) const { return !matrix; }
+};
+
+struct Power {
+    int exponent;
+    SquareMat operator()(const SquareMat& matrix) const { return matrix ^ exponent; }
+};
+
+struct Inverse {
+    SquareMat operator()(const SquareMat& matrix) const { return matrix.inverse(); }
+};
+
+} // namespace
+
+// Computes a product on the scheduler.
+Future<SquareMat> asyncMultiply(const SquareMat& left, const SquareMat& right, TaskScheduler& scheduler) {
+    return runAsync([left, right] { return Multiply()(left, right); }, scheduler);
+}
+
+// Computes the product of two futures.
+Future<SquareMat> asyncMultiply(const Future<SquareMat>& left, const Future<SquareMat>& right) {
+    return whenBoth(left, right, Multiply());
+}
+
+// Computes a sum on the scheduler.
+Future<SquareMat> asyncAdd(const SquareMat& left, const SquareMat& right, TaskScheduler& scheduler) {
+    return runAsync([left, right] { return Add()(left, right); }, scheduler);
+}
+
+// Computes the sum of two futures.
+Future<SquareMat> asyncAdd(const Future<SquareMat>& left, const Future<SquareMat>& right) {
+    return whenBoth(left, right, Add());
+}
+
+// Computes a determinant on the scheduler.
+Future<double> asyncDeterminant(const SquareMat& matrix, TaskScheduler& scheduler) {
+    return runAsync([matrix] { return Determinant()(matrix); }, scheduler);
+}
+
+// Computes the determinant of a future.
+Future<double> asyncDeterminant(const Future<SquareMat>& matrix) {
+    return matrix.then(Determinant());
+}
+
+// Computes a power on the scheduler.
+Future<SquareMat> asyncPower(const SquareMat& matrix, int exponent, TaskScheduler& scheduler) {
+    Power power = {exponent};
+    return runAsync([matrix, power] { return power(matrix); }, scheduler);
+}
+
+// Computes the power of a future.
+Future<SquareMat> asyncPower(const Future<SquareMat>& matrix, int exponent) {
+    Power power = {exponent};
+    return matrix.then(power);
+}
+
+// Computes an inverse on the scheduler.
+Future<SquareMat> asyncInverse(const SquareMat& matrix, TaskScheduler& scheduler) {
+    return runAsync([matrix] { return Inverse()(matrix); }, scheduler);
+}
+
+// Computes the inverse of a future.
+Future<SquareMat> asyncInverse(const Future<SquareMat>& matrix) {
+    return matrix.then(Inverse());
+}
+
+} // namespace matrix
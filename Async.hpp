@@ -0,0 +1,323 @@
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include "SquareMat.hpp"
+#include "TaskScheduler.hpp"
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace matrix {
+
+template <typename T> class Promise;
+
+/**
+ * @brief State shared by a Promise and its Futures: the value or exception, and the
+ * continuations waiting for it.
+ */
+template <typename T>
+class FutureState {
+private:
+    TaskScheduler* scheduler;
+    std::mutex mutex;
+    std::atomic<int> pending; // 1 until the value or exception is set.
+    bool done;
+    std::unique_ptr<T> value;
+    std::exception_ptr error;
+    std::vector<std::function<void()>> continuations;
+
+    FutureState(const FutureState&);
+    FutureState& operator=(const FutureState&);
+
+public:
+/**
+ * @brief Constructor for a state whose continuations run on the given scheduler.
+ */
+explicit FutureState(TaskScheduler& scheduler)
+    : scheduler(&scheduler), pending(1), done(false) {}
+
+/**
+ * @brief Gets the scheduler running the continuations.
+ */
+TaskScheduler& getScheduler() const { return *scheduler; }
+
+/**
+ * @brief Whether the value or exception is set.
+ */
+bool isReady() const { return pending.load() == 0; }
+
+/**
+ * @brief Blocks until the state is ready, running queued tasks of the scheduler meanwhile.
+ */
+void wait() { scheduler->waitFor(pending); }
+
+/**
+ * @brief Gets the value after wait(), rethrowing the exception if one was set.
+ */
+const T& get() {
+    wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return *value;
+}
+
+/**
+ * @brief Gets the exception after wait(), or a null pointer.
+ */
+std::exception_ptr getError() {
+    wait();
+    return error;
+}
+
+/**
+ * @brief Sets the value (result non-null) or the exception and queues the continuations.
+ */
+void complete(T* result, std::exception_ptr failure) {
+    std::unique_ptr<T> owned(result);
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (done) {
+            throw std::invalid_argument("Promise already satisfied.");
+        }
+        done = true;
+        value.swap(owned);
+        error = failure;
+        ready.swap(continuations);
+    }
+    pending.store(0);
+    scheduler->notifyAll();
+    for (size_t i = 0; i < ready.size(); ++i) {
+        scheduler->submit(ready[i]);
+    }
+}
+
+/**
+ * @brief Queues callback on the scheduler once the state is ready (immediately if it is).
+ */
+void whenReady(const std::function<void()>& callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!done) {
+            continuations.push_back(callback);
+            return;
+        }
+    }
+    scheduler->submit(callback);
+}
+};
+
+/**
+ * @brief The result of an asynchronous computation, shared between copies.
+ *
+ * Unlike std::future, a Future can be chained: then() attaches a continuation that runs on
+ * the TaskScheduler once the value is ready, so no thread blocks waiting for it. get() and
+ * wait() do block, but a worker thread calling them keeps running queued tasks, so waiting
+ * from inside a task cannot deadlock the pool. An exception thrown by the computation is
+ * rethrown by get() and skips the continuations, whose futures receive it instead.
+ */
+template <typename T>
+class Future {
+private:
+    std::shared_ptr<FutureState<T>> state;
+
+    explicit Future(const std::shared_ptr<FutureState<T>>& state) : state(state) {}
+
+    friend class Promise<T>;
+    template <typename U> friend class Future;
+
+public:
+/**
+ * @brief Whether the value or exception is available.
+ */
+bool isReady() const { return state->isReady(); }
+
+/**
+ * @brief Blocks until the value or exception is available.
+ */
+void wait() const { state->wait(); }
+
+/**
+ * @brief Waits and gets the value, rethrowing the exception of the computation.
+ */
+const T& get() const { return state->get(); }
+
+/**
+ * @brief Gets the scheduler running the continuations.
+ */
+TaskScheduler& getScheduler() const { return state->getScheduler(); }
+
+/**
+ * @brief Queues callback on the scheduler once the future is ready, failed or not.
+ */
+void onReady(const std::function<void()>& callback) const { state->whenReady(callback); }
+
+/**
+ * @brief Returns the future of function(value), run on the scheduler once the value is ready.
+ */
+template <typename F>
+Future<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type>
+then(F function) const;
+};
+
+/**
+ * @brief The producing side of a Future.
+ */
+template <typename T>
+class Promise {
+private:
+    std::shared_ptr<FutureState<T>> state;
+
+public:
+/**
+ * @brief Constructor for a promise whose future runs its continuations on the scheduler.
+ */
+explicit Promise(TaskScheduler& scheduler = TaskScheduler::instance())
+    : state(std::make_shared<FutureState<T>>(scheduler)) {}
+
+/**
+ * @brief Gets a future for the value.
+ */
+Future<T> getFuture() const { return Future<T>(state); }
+
+/**
+ * @brief Sets the value. Throws std::invalid_argument if the promise was already satisfied.
+ */
+void setValue(const T& value) const { state->complete(new T(value), std::exception_ptr()); }
+
+/**
+ * @brief Sets an exception, rethrown by the future.
+ */
+void setException(std::exception_ptr error) const { state->complete(nullptr, error); }
+};
+
+template <typename T>
+template <typename F>
+Future<typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type>
+Future<T>::then(F function) const {
+    typedef typename std::decay<decltype(std::declval<F&>()(std::declval<const T&>()))>::type R;
+    Promise<R> promise(getScheduler());
+    std::shared_ptr<FutureState<T>> source = state;
+    state->whenReady([source, promise, function]() mutable {
+        std::exception_ptr error = source->getError();
+        if (error) {
+            promise.setException(error);
+            return;
+        }
+        try {
+            promise.setValue(function(source->get()));
+        } catch (...) {
+            promise.setException(std::current_exception());
+        }
+    });
+    return promise.getFuture();
+}
+
+/**
+ * @brief Runs function() on the scheduler and returns the future of its result.
+ */
+template <typename F>
+Future<typename std::decay<decltype(std::declval<F&>()())>::type>
+runAsync(F function, TaskScheduler& scheduler = TaskScheduler::instance()) {
+    typedef typename std::decay<decltype(std::declval<F&>()())>::type R;
+    Promise<R> promise(scheduler);
+    scheduler.submit([promise, function]() mutable {
+        try {
+            promise.setValue(function());
+        } catch (...) {
+            promise.setException(std::current_exception());
+        }
+    });
+    return promise.getFuture();
+}
+
+/**
+ * @brief Returns the future of function(left value, right value), run on the scheduler of
+ * left once both are ready. An exception of either input is passed on.
+ */
+template <typename A, typename B, typename F>
+Future<typename std::decay<decltype(std::declval<F&>()(std::declval<const A&>(), std::declval<const B&>()))>::type>
+whenBoth(const Future<A>& left, const Future<B>& right, F function) {
+    typedef typename std::decay<decltype(std::declval<F&>()(std::declval<const A&>(), std::declval<const B&>()))>::type R;
+    Promise<R> promise(left.getScheduler());
+    // The second input to become ready runs the function.
+    std::shared_ptr<std::atomic<int>> remaining = std::make_shared<std::atomic<int>>(2);
+    std::function<void()> arrive = [left, right, promise, function, remaining]() mutable {
+        if (--*remaining != 0) {
+            return;
+        }
+        try {
+            promise.setValue(function(left.get(), right.get()));
+        } catch (...) {
+            promise.setException(std::current_exception());
+        }
+    };
+    left.onReady(arrive);
+    right.onReady(arrive);
+    return promise.getFuture();
+}
+
+/**
+ * @brief Computes left * right on the scheduler. The operands are copied, so they may
+ * change or go away before the product is ready.
+ */
+Future<SquareMat> asyncMultiply(const SquareMat& left, const SquareMat& right,
+                                TaskScheduler& scheduler = TaskScheduler::instance());
+
+/**
+ * @brief Computes the product of two futures once both are ready.
+ */
+Future<SquareMat> asyncMultiply(const Future<SquareMat>& left, const Future<SquareMat>& right);
+
+/**
+ * @brief Computes left + right on the scheduler.
+ */
+Future<SquareMat> asyncAdd(const SquareMat& left, const SquareMat& right,
+                           TaskScheduler& scheduler = TaskScheduler::instance());
+
+/**
+ * @brief Computes the sum of two futures once both are ready.
+ */
+Future<SquareMat> asyncAdd(const Future<SquareMat>& left, const Future<SquareMat>& right);
+
+/**
+ * @brief Computes the determinant (operator!) on the scheduler.
+ */
+Future<double> asyncDeterminant(const SquareMat& matrix, TaskScheduler& scheduler = TaskScheduler::instance());
+
+/**
+ * @brief Computes the determinant of a future matrix once it is ready.
+ */
+Future<double> asyncDeterminant(const Future<SquareMat>& matrix);
+
+/**
+ * @brief Computes matrix ^ exponent on the scheduler.
+ */
+Future<SquareMat> asyncPower(const SquareMat& matrix, int exponent,
+                             TaskScheduler& scheduler = TaskScheduler::instance());
+
+/**
+ * @brief Computes the power of a future matrix once it is ready.
+ */
+Future<SquareMat> asyncPower(const Future<SquareMat>& matrix, int exponent);
+
+/**
+ * @brief Computes the inverse on the scheduler.
+ */
+Future<SquareMat> asyncInverse(const SquareMat& matrix, TaskScheduler& scheduler = TaskScheduler::instance());
+
+/**
+ * @brief Computes the inverse of a future matrix once it is ready.
+ */
+Future<SquareMat> asyncInverse(const Future<SquareMat>& matrix);
+
+} // namespace matrix
+
+#endif // ASYNC_HPP
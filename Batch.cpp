@@ -0,0 +1,151 @@
+#include "Batch.hpp"
+#include "TaskScheduler.hpp"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+
+// Products of the interleaved kernel handled by one task, so that small batches stay serial.
+const long TASK_WORK = 1L << 18;
+
+// Multiplies the entries indices[begin, end), all of size n, BATCH_LANES at a time.
+// Element (r, c) of lane l lives at (r * n + c) * BATCH_LANES + l.
+void multiplyGroup(const std::vector<SquareMat>& left, const std::vector<SquareMat>& right,
+                   std::vector<SquareMat>& results, const std::vector<int>& indices,
+                   int begin, int end, int n) {
+    const int L = BATCH_LANES;
+    const size_t stride = static_cast<size_t>(n) * n * L;
+    std::vector<double> a(stride), b(stride), c(stride);
+    for (int first = begin; first < end; first += L) {
+        const int lanes = std::min(L, end - first);
+        if (lanes < L) {
+            // Unused lanes multiply zeros.
+            std::fill(a.begin(), a.end(), 0.0);
+            std::fill(b.begin(), b.end(), 0.0);
+        }
+        for (int l = 0; l < lanes; ++l) {
+            const SquareMat& x = left[indices[first + l]];
+            const SquareMat& y = right[indices[first + l]];
+            for (int r = 0; r < n; ++r) {
+                const double* xRow = x[r];
+                const double* yRow = y[r];
+                for (int col = 0; col < n; ++col) {
+                    a[(r * n + col) * L + l] = xRow[col];
+                    b[(r * n + col) * L + l] = yRow[col];
+                }
+            }
+        }
+        std::fill(c.begin(), c.end(), 0.0);
+        // i-k-j order with the lanes innermost; every loop body is one SIMD-wide operation.
+        for (int i = 0; i < n; ++i) {
+            double* out = &c[static_cast<size_t>(i) * n * L];
+            for (int k = 0; k < n; ++k) {
+                const double* scale = &a[(static_cast<size_t>(i) * n + k) * L];
+                const double* row = &b[static_cast<size_t>(k) * n * L];
+                for (int j = 0; j < n; ++j) {
+                    double* target = out + j * L;
+                    const double* source = row + j * L;
+                    for (int l = 0; l < L; ++l) {
+                        target[l] += scale[l] * source[l];
+                    }
+                }
+            }
+        }
+        for (int l = 0; l < lanes; ++l) {
+            SquareMat& z = results[indices[first + l]];
+            for (int r = 0; r < n; ++r) {
+                double* zRow = z[r];
+                for (int col = 0; col < n; ++col) {
+                    zRow[col] = c[(r * n + col) * L + l];
+                }
+            }
+        }
+    }
+}
+
+// Multiplies one pair of the batch directly into its result: rows longer than
+// BATCH_MAX_SIZE already fill the SIMD lanes on their own.
+void multiplyPair(const SquareMat& left, const SquareMat& right, SquareMat& result) {
+    const int n = left.getSize();
+    for (int i = 0; i < n; ++i) {
+        double* out = result[i];
+        std::fill(out, out + n, 0.0);
+        const double* row = left[i];
+        for (int k = 0; k < n; ++k) {
+            const double scale = row[k];
+            const double* source = right[k];
+            for (int j = 0; j < n; ++j) {
+                out[j] += scale * source[j];
+            }
+        }
+    }
+}
+
+} // namespace
+
+// Multiplies every pair of the batch on the shared scheduler.
+void multiplyBatch(const std::vector<SquareMat>& left, const std::vector<SquareMat>& right,
+                   std::vector<SquareMat>& results) {
+    multiplyBatch(left, right, results, TaskScheduler::instance());
+}
+
+// Multiplies every pair of the batch on the given scheduler.
+void multiplyBatch(const std::vector<SquareMat>& left, const std::vector<SquareMat>& right,
+                   std::vector<SquareMat>& results, TaskScheduler& scheduler) {
+    if (left.size() != right.size()) {
+        throw std::invalid_argument("Batches must have the same number of matrices.");
+    }
+    const int count = static_cast<int>(left.size());
+    // Group the entries by size; large entries are multiplied one by one.
+    std::map<int, std::vector<int>> groups;
+    for (int i = 0; i < count; ++i) {
+        if (left[i].getSize() != right[i].getSize()) {
+            throw std::invalid_argument("Matrices must have the same size for multiplication.");
+        }
+        groups[left[i].getSize()].push_back(i);
+    }
+    // Matrices of results that already have the right size are reused, so a batch
+    // computed repeatedly into the same vector allocates nothing.
+    results.resize(std::min(results.size(), left.size()), SquareMat(1));
+    for (int i = 0; i < count; ++i) {
+        if (i == static_cast<int>(results.size())) {
+            results.push_back(SquareMat(left[i].getSize()));
+        } else if (results[i].getSize() != left[i].getSize()) {
+            results[i] = SquareMat(left[i].getSize());
+        }
+    }
+
+    TaskGraph graph;
+    for (std::map<int, std::vector<int>>::const_iterator group = groups.begin(); group != groups.end(); ++group) {
+        const int n = group->first;
+        const std::vector<int>* indices = &group->second;
+        const int size = static_cast<int>(indices->size());
+        // Enough entries per task to amortize it, whole multiples of BATCH_LANES when interleaved.
+        const long perEntry = static_cast<long>(n) * n * n;
+        int entriesPerTask = static_cast<int>(std::max(1L, TASK_WORK / perEntry));
+        if (n <= BATCH_MAX_SIZE) {
+            entriesPerTask = (entriesPerTask + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+        }
+        for (int begin = 0; begin < size; begin += entriesPerTask) {
+            const int end = std::min(size, begin + entriesPerTask);
+            if (n <= BATCH_MAX_SIZE) {
+                graph.addTask([&left, &right, &results, indices, begin, end, n] {
+                    multiplyGroup(left, right, results, *indices, begin, end, n);
+                });
+            } else {
+                graph.addTask([&left, &right, &results, indices, begin, end] {
+                    for (int i = begin; i < end; ++i) {
+                        const int index = (*indices)[i];
+                        multiplyPair(left[index], right[index], results[index]);
+                    }
+                });
+            }
+        }
+    }
+    graph.run(scheduler);
+}
+
+} // namespace matrix
@@ -0,0 +1,44 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "SquareMat.hpp"
+#include <vector>
+
+namespace matrix {
+
+class TaskScheduler;
+
+/**
+ * @brief Number of batch entries multiplied side by side, one per SIMD lane.
+ */
+const int BATCH_LANES = 8;
+
+/**
+ * @brief Largest size multiplied with the interleaved kernel. Larger entries have rows wide
+ * enough to fill the SIMD lanes and are multiplied one by one, still without allocations.
+ */
+const int BATCH_MAX_SIZE = 16;
+
+/**
+ * @brief Computes results[i] = left[i] * right[i] for every i.
+ *
+ * Entries of the same size are packed BATCH_LANES at a time into an interleaved layout
+ * (element (r, c) of the BATCH_LANES matrices stored next to each other), so the innermost
+ * loop of the product runs across batch entries: it is as wide as a SIMD register whatever
+ * the matrix size, and the per-pair allocations and loop overheads of operator* are paid
+ * once per group. Groups are spread over the shared TaskScheduler. results is resized to
+ * the batch size (it must not be one of the inputs); left[i] and right[i] must have the
+ * same size.
+ */
+void multiplyBatch(const std::vector<SquareMat>& left, const std::vector<SquareMat>& right,
+                   std::vector<SquareMat>& results);
+
+/**
+ * @brief Computes the batch on the given scheduler.
+ */
+void multiplyBatch(const std::vector<SquareMat>& left, const std::vector<SquareMat>& right,
+                   std::vector<SquareMat>& results, TaskScheduler& scheduler);
+
+} // namespace matrix
+
+#endif // BATCH_HPP
@@ -0,0 +1,334 @@
+#include "Chain.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+
+// The structure of a factor or of an intermediate product.
+struct Shape {
+    bool dense;
+    Structure structure;
+    int bandwidth;
+};
+
+// Average number of stored elements per row.
+double rowWeight(const Shape& shape, int n) {
+    if (shape.dense) {
+        return n;
+    }
+    switch (shape.structure) {
+    case Structure::Diagonal:
+        return 1.0;
+    case Structure::Banded:
+        return std::min(n, 2 * shape.bandwidth + 1);
+    case Structure::LowerTriangular:
+    case Structure::UpperTriangular:
+        return (n + 1) / 2.0;
+    default:
+        return n;
+    }
+}
+
+// Whether the product of two structured shapes has a structure, and which one.
+bool structuredProduct(const Shape& left, const Shape& right, int n, Shape& product) {
+    if (left.dense || right.dense) {
+        return false;
+    }
+    product.dense = false;
+    return StructuredMat::productStructure(left.structure, left.bandwidth, right.structure, right.bandwidth,
+                                           n, product.structure, product.bandwidth);
+}
+
+// Shape of the product of two shapes.
+Shape productShape(const Shape& left, const Shape& right, int n) {
+    Shape product = {true, Structure::Diagonal, 0};
+    if (!structuredProduct(left, right, n, product)) {
+        product.dense = true;
+    }
+    return product;
+}
+
+// Estimated multiply-adds of a product: every stored element of row i of the left operand
+// scales a stored row of the right one. Structured operands whose product is dense are
+// multiplied with the lighter one kept structured and the other converted.
+double productCost(const Shape& left, const Shape& right, int n) {
+    const double leftWeight = rowWeight(left, n);
+    const double rightWeight = rowWeight(right, n);
+    Shape product = left;
+    if (!left.dense && !right.dense && !structuredProduct(left, right, n, product)) {
+        return static_cast<double>(n) * n * std::min(leftWeight, rightWeight);
+    }
+    return n * leftWeight * rightWeight;
+}
+
+// Dense buffers reused across the products of one evaluation, and the structured
+// intermediates, all freed with the workspace.
+class Workspace {
+private:
+    int size;
+    std::vector<SquareMat*> buffers;
+    std::vector<SquareMat*> available;
+    std::vector<StructuredMat*> structured;
+
+    Workspace(const Workspace&);
+    Workspace& operator=(const Workspace&);
+
+public:
+    explicit Workspace(int size) : size(size) {}
+
+    ~Workspace() {
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            delete buffers[i];
+        }
+        for (size_t i = 0; i < structured.size(); ++i) {
+            delete structured[i];
+        }
+    }
+
+    SquareMat* acquire() {
+        if (available.empty()) {
+            buffers.push_back(nullptr);
+            buffers.back() = new SquareMat(size);
+            return buffers.back();
+        }
+        SquareMat* buffer = available.back();
+        available.pop_back();
+        return buffer;
+    }
+
+    void release(SquareMat* buffer) {
+        if (buffer) {
+            available.push_back(buffer);
+        }
+    }
+
+    const StructuredMat* keep(const StructuredMat& matrix) {
+        structured.push_back(nullptr);
+        structured.back() = new StructuredMat(matrix);
+        return structured.back();
+    }
+};
+
+// An operand during evaluation: a factor, a structured intermediate or a workspace buffer.
+struct Value {
+    const SquareMat* dense;
+    const StructuredMat* structured;
+    SquareMat* buffer;
+};
+
+Shape shapeOf(const Value& value) {
+    Shape shape = {true, Structure::Diagonal, 0};
+    if (value.structured) {
+        shape.dense = false;
+        shape.structure = value.structured->getStructure();
+        shape.bandwidth = value.structured->getBandwidth();
+    }
+    return shape;
+}
+
+// Multiplies two values, releasing the buffers of the operands.
+Value multiplyValues(const Value& left, const Value& right, int n, Workspace& workspace) {
+    Value result = {nullptr, nullptr, nullptr};
+    const Shape leftShape = shapeOf(left);
+    const Shape rightShape = shapeOf(right);
+    Shape product = leftShape;
+    if (left.structured && right.structured) {
+        if (structuredProduct(leftShape, rightShape, n, product)) {
+            result.structured = workspace.keep(left.structured->multiplyStructured(*right.structured));
+            return result;
+        }
+        SquareMat* converted = workspace.acquire();
+        result.buffer = workspace.acquire();
+        if (rowWeight(leftShape, n) <= rowWeight(rightShape, n)) {
+            *converted = right.structured->toDense();
+            left.structured->multiplyInto(*converted, *result.buffer);
+        } else {
+            *converted = left.structured->toDense();
+            right.structured->multiplyLeftInto(*converted, *result.buffer);
+        }
+        workspace.release(converted);
+    } else {
+        result.buffer = workspace.acquire();
+        if (left.structured) {
+            left.structured->multiplyInto(*right.dense, *result.buffer);
+        } else if (right.structured) {
+            right.structured->multiplyLeftInto(*left.dense, *result.buffer);
+        } else {
+            gemm(1.0, *left.dense, *right.dense, 0.0, *result.buffer);
+        }
+    }
+    result.dense = result.buffer;
+    workspace.release(left.buffer);
+    workspace.release(right.buffer);
+    return result;
+}
+
+} // namespace
+
+// Constructor that creates an empty chain.
+MatrixChain::MatrixChain() : size(0) {}
+
+// Method to append a dense factor
+MatrixChain& MatrixChain::append(const SquareMat& matrix) {
+    if (!factors.empty() && matrix.getSize() != size) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    Factor factor = {&matrix, nullptr};
+    factors.push_back(factor);
+    size = matrix.getSize();
+    return *this;
+}
+
+// Method to append a structured factor
+MatrixChain& MatrixChain::append(const StructuredMat& matrix) {
+    if (!factors.empty() && matrix.getSize() != size) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    Factor factor = {nullptr, &matrix};
+    factors.push_back(factor);
+    size = matrix.getSize();
+    return *this;
+}
+
+// Method to get the number of factors
+int MatrixChain::getLength() const {
+    return static_cast<int>(factors.size());
+}
+
+// Private helper function for the classical matrix-chain dynamic program, with the shape
+// of every sub-chain (independent of its parenthesization) driving the costs.
+void MatrixChain::plan(std::vector<double>& cost, std::vector<int>& split) const {
+    const int k = getLength();
+    std::vector<Shape> shapes(static_cast<size_t>(k) * k);
+    cost.assign(static_cast<size_t>(k) * k, 0.0);
+    split.assign(static_cast<size_t>(k) * k, 0);
+    for (int i = 0; i < k; ++i) {
+        Value value = {factors[i].dense, factors[i].structured, nullptr};
+        shapes[i * k + i] = shapeOf(value);
+    }
+    for (int length = 2; length <= k; ++length) {
+        for (int i = 0; i + length - 1 < k; ++i) {
+            const int j = i + length - 1;
+            shapes[i * k + j] = productShape(shapes[i * k + i], shapes[(i + 1) * k + j], size);
+            // Ties keep the left-to-right order of operator*.
+            double best = -1.0;
+            for (int m = j - 1; m >= i; --m) {
+                const double candidate = cost[i * k + m] + cost[(m + 1) * k + j]
+                    + productCost(shapes[i * k + m], shapes[(m + 1) * k + j], size);
+                if (best < 0.0 || candidate < best) {
+                    best = candidate;
+                    split[i * k + j] = m;
+                }
+            }
+            cost[i * k + j] = best;
+        }
+    }
+}
+
+// Method to get the estimated cost of the chosen order
+double MatrixChain::getCost() const {
+    const int k = getLength();
+    if (k == 0) {
+        return 0.0;
+    }
+    std::vector<double> cost;
+    std::vector<int> split;
+    plan(cost, split);
+    return cost[k - 1];
+}
+
+// Method to get the estimated cost of the left-to-right order
+double MatrixChain::getLeftToRightCost() const {
+    double total = 0.0;
+    if (factors.empty()) {
+        return total;
+    }
+    Value first = {factors[0].dense, factors[0].structured, nullptr};
+    Shape accumulated = shapeOf(first);
+    for (size_t i = 1; i < factors.size(); ++i) {
+        Value next = {factors[i].dense, factors[i].structured, nullptr};
+        const Shape shape = shapeOf(next);
+        total += productCost(accumulated, shape, size);
+        accumulated = productShape(accumulated, shape, size);
+    }
+    return total;
+}
+
+// Private helper function to print a parenthesization.
+void MatrixChain::describe(const std::vector<int>& split, int i, int j, std::string& out) const {
+    if (i == j) {
+        out += std::to_string(i);
+        return;
+    }
+    const int m = split[i * getLength() + j];
+    out += "(";
+    describe(split, i, m, out);
+    out += " ";
+    describe(split, m + 1, j, out);
+    out += ")";
+}
+
+// Method to get the chosen order
+std::string MatrixChain::getOrder() const {
+    std::string out;
+    if (factors.empty()) {
+        return out;
+    }
+    std::vector<double> cost;
+    std::vector<int> split;
+    plan(cost, split);
+    describe(split, 0, getLength() - 1, out);
+    return out;
+}
+
+// Evaluates the chain: the sub-chains are computed depth first following the split table,
+// so at most one buffer per level of the tree is in use at a time.
+SquareMat MatrixChain::evaluate() const {
+    const int k = getLength();
+    if (k == 0) {
+        throw std::invalid_argument("Cannot evaluate an empty chain.");
+    }
+    std::vector<double> cost;
+    std::vector<int> split;
+    plan(cost, split);
+
+    Workspace workspace(size);
+    // Post-order traversal of the split tree with an explicit stack of ranges.
+    struct Range {
+        int i;
+        int j;
+        bool expanded;
+    };
+    std::vector<Range> pending;
+    std::vector<Value> values;
+    Range root = {0, k - 1, false};
+    pending.push_back(root);
+    while (!pending.empty()) {
+        Range range = pending.back();
+        pending.pop_back();
+        if (range.i == range.j) {
+            Value value = {factors[range.i].dense, factors[range.i].structured, nullptr};
+            values.push_back(value);
+        } else if (range.expanded) {
+            Value right = values.back();
+            values.pop_back();
+            Value left = values.back();
+            values.pop_back();
+            values.push_back(multiplyValues(left, right, size, workspace));
+        } else {
+            const int m = split[range.i * k + range.j];
+            Range combine = {range.i, range.j, true};
+            Range right = {m + 1, range.j, false};
+            Range left = {range.i, m, false};
+            pending.push_back(combine);
+            pending.push_back(right);
+            pending.push_back(left);
+        }
+    }
+    const Value& result = values.back();
+    return result.structured ? result.structured->toDense() : SquareMat(*result.dense);
+}
+
+} // namespace matrix
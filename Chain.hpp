@@ -0,0 +1,93 @@
+#ifndef CHAIN_HPP
+#define CHAIN_HPP
+
+#include "SquareMat.hpp"
+#include "StructuredMat.hpp"
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+/**
+ * @brief A product of several matrices, evaluated in the cheapest order.
+ *
+ * operator* evaluates a * b * c * ... strictly from the left. A MatrixChain collects the
+ * factors, dense or structured, and chooses the parenthesization with the lowest estimated
+ * cost by dynamic programming over the sub-chains (O(k^3) for k factors). The estimate
+ * counts the multiply-adds of each product from the average number of stored elements per
+ * row of its operands, and follows the structure of the intermediate results
+ * (StructuredMat::productStructure()): a chain of diagonal and banded factors stays banded
+ * until it meets a dense one. Dense intermediates are computed into a pool of buffers that
+ * are reused once consumed, so a chain allocates at most a few n x n matrices.
+ *
+ * The chain stores pointers: the factors must outlive it and stay unchanged until evaluate().
+ */
+class MatrixChain {
+private:
+    /**
+     * @brief A factor: exactly one of the pointers is set.
+     */
+    struct Factor {
+        const SquareMat* dense;
+        const StructuredMat* structured;
+    };
+
+    std::vector<Factor> factors;
+    int size;
+
+    /**
+     * @brief Fills the cost and split tables of every sub-chain [i, j], stored at i * k + j.
+     */
+    void plan(std::vector<double>& cost, std::vector<int>& split) const;
+
+    /**
+     * @brief Writes the parenthesization of the sub-chain [i, j].
+     */
+    void describe(const std::vector<int>& split, int i, int j, std::string& out) const;
+
+public:
+/**
+ * @brief Constructor that creates an empty chain.
+ */
+MatrixChain();
+
+/**
+ * @brief Appends a dense factor on the right. Returns the chain for chaining calls.
+ */
+MatrixChain& append(const SquareMat& matrix);
+
+/**
+ * @brief Appends a structured factor on the right.
+ */
+MatrixChain& append(const StructuredMat& matrix);
+
+/**
+ * @brief Gets the number of factors.
+ */
+int getLength() const;
+
+/**
+ * @brief Gets the estimated number of multiply-adds of the chosen order.
+ */
+double getCost() const;
+
+/**
+ * @brief Gets the estimated number of multiply-adds of the left-to-right order of operator*.
+ */
+double getLeftToRightCost() const;
+
+/**
+ * @brief Gets the chosen order, e.g. "(0 (1 2))" for a * (b * c), factors numbered from 0.
+ */
+std::string getOrder() const;
+
+/**
+ * @brief Evaluates the product in the chosen order. Throws std::invalid_argument if the
+ * chain is empty.
+ */
+SquareMat evaluate() const;
+};
+
+} // namespace matrix
+
+#endif // CHAIN_HPP
@@ -0,0 +1,145 @@
+#ifndef COROUTINE_HPP
+#define COROUTINE_HPP
+
+#include "Async.hpp"
+
+// Coroutines need C++20; the library itself builds as C++11 (make test20 builds the tests
+// as C++20). Included from an older standard this header declares nothing.
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+
+namespace matrix {
+
+/**
+ * @brief Awaiter that resumes the coroutine on a worker of a TaskScheduler.
+ */
+class ScheduleAwaiter {
+private:
+    TaskScheduler* scheduler;
+
+public:
+explicit ScheduleAwaiter(TaskScheduler& scheduler) : scheduler(&scheduler) {}
+
+bool await_ready() const noexcept { return false; }
+
+void await_suspend(std::coroutine_handle<> handle) const {
+    scheduler->submit([handle] { handle.resume(); });
+}
+
+void await_resume() const noexcept {}
+};
+
+/**
+ * @brief Moves the rest of the coroutine to a worker of the scheduler: co_await resumeOn(s).
+ */
+inline ScheduleAwaiter resumeOn(TaskScheduler& scheduler = TaskScheduler::instance()) {
+    return ScheduleAwaiter(scheduler);
+}
+
+/**
+ * @brief Awaiter that suspends the coroutine until a Future is ready, then resumes it on a
+ * worker of the future's scheduler. No thread waits in between.
+ */
+template <typename T>
+class FutureAwaiter {
+private:
+    Future<T> future;
+
+public:
+explicit FutureAwaiter(const Future<T>& future) : future(future) {}
+
+bool await_ready() const { return future.isReady(); }
+
+void await_suspend(std::coroutine_handle<> handle) const {
+    future.onReady([handle] { handle.resume(); });
+}
+
+/**
+ * @brief Gets a copy of the value (the awaiter ends with the co_await expression),
+ * rethrowing the exception of the computation.
+ */
+T await_resume() const { return future.get(); }
+};
+
+/**
+ * @brief Makes every Future awaitable, so the async operations (asyncMultiply for operator*,
+ * asyncPower for operator^, asyncDeterminant for operator!, ... or runAsync for any function)
+ * can be co_awaited directly.
+ */
+template <typename T>
+FutureAwaiter<T> operator co_await(const Future<T>& future) {
+    return FutureAwaiter<T>(future);
+}
+
+/**
+ * @brief The return type of a coroutine computing a T on the TaskScheduler.
+ *
+ * Calling the coroutine only queues it on the shared scheduler, and every co_await of a
+ * Future or Task suspends it without blocking any thread: it resumes on a worker once the
+ * awaited value is ready (or on a thread helping in TaskScheduler::waitFor(), e.g. in get()).
+ * The result is available through the Task, which is itself awaitable, so coroutines compose
+ * into pipelines:
+ *
+ *     Task<double> pipeline(SquareMat a, SquareMat b) {
+ *         SquareMat product = co_await asyncMultiply(~a, b);
+ *         co_return co_await asyncDeterminant(product);
+ *     }
+ *
+ * Parameters should be taken by value: the coroutine runs after the call returns. An
+ * exception escaping the coroutine is rethrown by get() and by the co_await of the Task.
+ */
+template <typename T>
+class Task {
+private:
+    Future<T> future;
+
+    explicit Task(const Future<T>& future) : future(future) {}
+
+public:
+/**
+ * @brief The coroutine promise: its result is forwarded to a Promise of the async API.
+ */
+class promise_type {
+private:
+    Promise<T> promise;
+
+public:
+Task get_return_object() { return Task(promise.getFuture()); }
+
+ScheduleAwaiter initial_suspend() { return ScheduleAwaiter(TaskScheduler::instance()); }
+
+std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+
+void return_value(const T& value) { promise.setValue(value); }
+
+void unhandled_exception() { promise.setException(std::current_exception()); }
+};
+
+/**
+ * @brief Gets the future of the coroutine's result.
+ */
+const Future<T>& getFuture() const { return future; }
+
+/**
+ * @brief Whether the coroutine finished.
+ */
+bool isReady() const { return future.isReady(); }
+
+/**
+ * @brief Blocks until the coroutine finished and gets its result.
+ */
+const T& get() const { return future.get(); }
+
+/**
+ * @brief Awaits the result from another coroutine.
+ */
+FutureAwaiter<T> operator co_await() const { return FutureAwaiter<T>(future); }
+};
+
+} // namespace matrix
+
+#endif // __cplusplus >= 202002L
+
+#endif // COROUTINE_HPP
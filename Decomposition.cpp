@@ -0,0 +1,1230 @@
+#include "Decomposition.hpp"
+#include "TaskScheduler.hpp"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace matrix {
+
+namespace {
+
+// Returns true if the matrix is symmetric with a positive diagonal, the cheap
+// necessary conditions for a Cholesky factorization to exist.
+bool maybePositiveDefinite(const SquareMat& matrix) {
+    int n = matrix.getSize();
+    for (int i = 0; i < n; ++i) {
+        const double* row = matrix[i];
+        if (!(row[i] > 0.0)) {
+            return false;
+        }
+        for (int j = 0; j < i; ++j) {
+            if (row[j] != matrix[j][i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Product of the diagonal of factor as mantissa * 2^exponent, with the mantissa brought
+// back to [0.5, 1) after every element so that no partial product overflows or underflows.
+double diagonalProduct(const SquareMat& factor, long& exponent) {
+    double mantissa = 1.0;
+    exponent = 0;
+    for (int i = 0; i < factor.getSize(); ++i) {
+        int shift = 0;
+        mantissa = std::frexp(mantissa * factor[i][i], &shift);
+        exponent += shift;
+    }
+    return mantissa;
+}
+
+// Below this |1 + v^T A^-1 u| relative to 1 + |v^T A^-1 u|, a Sherman-Morrison update is
+// dominated by cancellation and InverseUpdater factors the matrix again.
+const double UPDATE_TOLERANCE = 1e-8;
+
+void checkIndex(int size, int index) {
+    if (index < 0 || index >= size) {
+        throw std::out_of_range("Index out of range.");
+    }
+}
+
+void checkRhsSize(int size, int rhsSize) {
+    if (size != rhsSize) {
+        throw std::invalid_argument("Right-hand side size must match the matrix size.");
+    }
+}
+
+// Serial right-looking blocked LU with partial pivoting, in place. Each step
+// factors a panel of blockSize columns, solves for the matching block row of U and
+// then updates the trailing matrix with one i-k-j product, where most of the time goes.
+template <typename T>
+void factorBlocked(BasicSquareMat<T>& lu, std::vector<int>& pivots, int& swapSign, bool& singular, int blockSize) {
+    const int n = lu.getSize();
+    for (int i = 0; i < n; ++i) {
+        pivots[i] = i;
+    }
+    for (int k0 = 0; k0 < n; k0 += blockSize) {
+        const int k1 = std::min(n, k0 + blockSize);
+
+        // Panel factorization of columns [k0, k1) with partial pivoting.
+        for (int j = k0; j < k1; ++j) {
+            int pivot = j;
+            T best = std::abs(lu[j][j]);
+            for (int i = j + 1; i < n; ++i) {
+                T candidate = std::abs(lu[i][j]);
+                if (candidate > best) {
+                    best = candidate;
+                    pivot = i;
+                }
+            }
+            if (pivot != j) {
+                std::swap_ranges(lu[j], lu[j] + n, lu[pivot]);
+                std::swap(pivots[j], pivots[pivot]);
+                swapSign = -swapSign;
+            }
+            const T* pivotRow = lu[j];
+            if (pivotRow[j] == T()) {
+                singular = true;
+                continue; // The column is already zero below the diagonal.
+            }
+            for (int i = j + 1; i < n; ++i) {
+                T* row = lu[i];
+                const T factor = row[j] / pivotRow[j];
+                row[j] = factor;
+                for (int c = j + 1; c < k1; ++c) {
+                    row[c] -= factor * pivotRow[c];
+                }
+            }
+        }
+
+        // Block row of U: U12 = L11^-1 * A12.
+        for (int i = k0 + 1; i < k1; ++i) {
+            T* row = lu[i];
+            for (int p = k0; p < i; ++p) {
+                const T factor = row[p];
+                const T* upper = lu[p];
+                for (int c = k1; c < n; ++c) {
+                    row[c] -= factor * upper[c];
+                }
+            }
+        }
+
+        // Trailing update: A22 -= L21 * U12.
+        for (int i = k1; i < n; ++i) {
+            T* row = lu[i];
+            for (int p = k0; p < k1; ++p) {
+                const T factor = row[p];
+                if (factor == T()) {
+                    continue;
+                }
+                const T* upper = lu[p];
+                for (int c = k1; c < n; ++c) {
+                    row[c] -= factor * upper[c];
+                }
+            }
+        }
+    }
+}
+
+// Solves L * U * x = P * b in double, the factors being double or float.
+template <typename T>
+std::vector<double> substituteVector(const BasicSquareMat<T>& lu, const std::vector<int>& pivots,
+                                     const std::vector<double>& rhs) {
+    const int n = lu.getSize();
+    std::vector<double> x(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = rhs[pivots[i]];
+    }
+    for (int i = 1; i < n; ++i) {
+        const T* lower = lu[i];
+        double sum = x[i];
+        for (int p = 0; p < i; ++p) {
+            sum -= lower[p] * x[p];
+        }
+        x[i] = sum;
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        const T* upper = lu[i];
+        double sum = x[i];
+        for (int p = i + 1; p < n; ++p) {
+            sum -= upper[p] * x[p];
+        }
+        x[i] = sum / upper[i];
+    }
+    return x;
+}
+
+// Solves L * U * X = B in place in double, B being already permuted by P.
+template <typename T>
+void substituteColumns(const BasicSquareMat<T>& lu, SquareMat& rhs) {
+    const int n = lu.getSize();
+    // L * Y = B, L having a unit diagonal.
+    for (int i = 1; i < n; ++i) {
+        double* row = rhs[i];
+        const T* lower = lu[i];
+        for (int p = 0; p < i; ++p) {
+            const double factor = lower[p];
+            const double* solved = rhs[p];
+            for (int c = 0; c < n; ++c) {
+                row[c] -= factor * solved[c];
+            }
+        }
+    }
+    // U * X = Y.
+    for (int i = n - 1; i >= 0; --i) {
+        double* row = rhs[i];
+        const T* upper = lu[i];
+        for (int p = i + 1; p < n; ++p) {
+            const double factor = upper[p];
+            const double* solved = rhs[p];
+            for (int c = 0; c < n; ++c) {
+                row[c] -= factor * solved[c];
+            }
+        }
+        const double diagonal = upper[i];
+        for (int c = 0; c < n; ++c) {
+            row[c] /= diagonal;
+        }
+    }
+}
+
+} // namespace
+
+// Factors the matrix, in parallel when it is large and threads are available.
+LUDecomposition::LUDecomposition(const SquareMat& matrix, int blockSize)
+    : lu(matrix), pivots(matrix.getSize()), swapSign(1), singular(false) {
+    if (blockSize <= 0) {
+        throw std::invalid_argument("Block size must be a positive integer.");
+    }
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    if (lu.getSize() >= PARALLEL_THRESHOLD && scheduler.getThreadCount() > 1) {
+        factorParallel(blockSize, scheduler);
+    } else {
+        factorSerial(blockSize);
+    }
+}
+
+// Factors the matrix in parallel on the given scheduler.
+LUDecomposition::LUDecomposition(const SquareMat& matrix, TaskScheduler& scheduler, int blockSize)
+    : lu(matrix), pivots(matrix.getSize()), swapSign(1), singular(false) {
+    if (blockSize <= 0) {
+        throw std::invalid_argument("Block size must be a positive integer.");
+    }
+    factorParallel(blockSize, scheduler);
+}
+
+// Private helper function with the serial right-looking blocked algorithm.
+void LUDecomposition::factorSerial(int blockSize) {
+    factorBlocked(lu, pivots, swapSign, singular, blockSize);
+}
+
+// Private helper function with the tiled parallel algorithm. For every step k there
+// is one panel task factoring block column k, one task per block column j > k that
+// applies the row swaps of the panel and solves for the U tile (k, j), and one task
+// per tile (i, j) of the trailing matrix subtracting L(i, k) * U(k, j). The panel of
+// step k + 1 only waits for the updates of its own block column, so it runs ahead
+// of the rest of the trailing update of step k and keeps the critical path short.
+// Every element sees the same operations in the same order as in factorSerial().
+void LUDecomposition::factorParallel(int blockSize, TaskScheduler& scheduler) {
+    const int n = lu.getSize();
+    const int blocks = (n + blockSize - 1) / blockSize;
+    std::vector<double*> rowPointers(n);
+    for (int i = 0; i < n; ++i) {
+        rowPointers[i] = lu[i];
+    }
+    std::vector<int> swaps(n); // Row r was swapped with row swaps[r] in its panel.
+    std::atomic<bool> zeroPivot(false);
+    double** a = rowPointers.data();
+    int* swapped = swaps.data();
+    std::atomic<bool>* zero = &zeroPivot;
+
+    TaskGraph graph;
+    // update[i][j] holds the task of tile (i, j) of the previous step, -1 if none.
+    std::vector<std::vector<int>> update(blocks, std::vector<int>(blocks, -1));
+    for (int k = 0; k < blocks; ++k) {
+        const int k0 = k * blockSize;
+        const int k1 = std::min(n, k0 + blockSize);
+
+        int panel = graph.addTask([=] {
+            for (int j = k0; j < k1; ++j) {
+                int pivot = j;
+                double best = std::fabs(a[j][j]);
+                for (int i = j + 1; i < n; ++i) {
+                    double candidate = std::fabs(a[i][j]);
+                    if (candidate > best) {
+                        best = candidate;
+                        pivot = i;
+                    }
+                }
+                swapped[j] = pivot;
+                if (pivot != j) {
+                    std::swap_ranges(a[j] + k0, a[j] + k1, a[pivot] + k0);
+                }
+                const double* pivotRow = a[j];
+                if (pivotRow[j] == 0.0) {
+                    zero->store(true);
+                    continue;
+                }
+                for (int i = j + 1; i < n; ++i) {
+                    double* row = a[i];
+                    const double factor = row[j] / pivotRow[j];
+                    row[j] = factor;
+                    for (int c = j + 1; c < k1; ++c) {
+                        row[c] -= factor * pivotRow[c];
+                    }
+                }
+            }
+        });
+        for (int i = k; i < blocks; ++i) {
+            if (update[i][k] >= 0) {
+                graph.addDependency(update[i][k], panel);
+            }
+        }
+
+        std::vector<int> solveTasks(blocks, -1);
+        for (int j = k + 1; j < blocks; ++j) {
+            const int j0 = j * blockSize;
+            const int j1 = std::min(n, j0 + blockSize);
+            solveTasks[j] = graph.addTask([=] {
+                for (int r = k0; r < k1; ++r) {
+                    if (swapped[r] != r) {
+                        std::swap_ranges(a[r] + j0, a[r] + j1, a[swapped[r]] + j0);
+                    }
+                }
+                for (int i = k0 + 1; i < k1; ++i) {
+                    double* row = a[i];
+                    for (int p = k0; p < i; ++p) {
+                        const double factor = row[p];
+                        const double* upper = a[p];
+                        for (int c = j0; c < j1; ++c) {
+                            row[c] -= factor * upper[c];
+                        }
+                    }
+                }
+            });
+            for (int i = k; i < blocks; ++i) {
+                if (update[i][j] >= 0) {
+                    graph.addDependency(update[i][j], solveTasks[j]);
+                }
+            }
+        }
+        // Released last, the solve of block column k + 1 runs first on the panel's worker.
+        for (int j = blocks - 1; j > k; --j) {
+            graph.addDependency(panel, solveTasks[j]);
+        }
+
+        for (int j = k + 1; j < blocks; ++j) {
+            const int j0 = j * blockSize;
+            const int j1 = std::min(n, j0 + blockSize);
+            for (int i = k + 1; i < blocks; ++i) {
+                const int i0 = i * blockSize;
+                const int i1 = std::min(n, i0 + blockSize);
+                update[i][j] = graph.addTask([=] {
+                    for (int r = i0; r < i1; ++r) {
+                        double* row = a[r];
+                        for (int p = k0; p < k1; ++p) {
+                            const double factor = row[p];
+                            if (factor == 0.0) {
+                                continue;
+                            }
+                            const double* upper = a[p];
+                            for (int c = j0; c < j1; ++c) {
+                                row[c] -= factor * upper[c];
+                            }
+                        }
+                    }
+                });
+                graph.addDependency(solveTasks[j], update[i][j]);
+            }
+        }
+    }
+    graph.run(scheduler);
+
+    // Apply the swaps of every panel to the L columns on its left, in order, and
+    // compose them into the permutation.
+    for (int i = 0; i < n; ++i) {
+        pivots[i] = i;
+    }
+    for (int r = 0; r < n; ++r) {
+        if (swaps[r] == r) {
+            continue;
+        }
+        const int left = (r / blockSize) * blockSize;
+        std::swap_ranges(a[r], a[r] + left, a[swaps[r]]);
+        std::swap(pivots[r], pivots[swaps[r]]);
+        swapSign = -swapSign;
+    }
+    singular = zeroPivot.load();
+}
+
+// Private helper function for forward and back substitution on every column of rhs.
+void LUDecomposition::substitute(SquareMat& rhs) const {
+    if (singular) {
+        throw std::invalid_argument("Matrix is singular.");
+    }
+    substituteColumns(lu, rhs);
+}
+
+// Method to get the size of the factored matrix
+int LUDecomposition::getSize() const {
+    return lu.getSize();
+}
+
+// Method to check if the factored matrix is singular
+bool LUDecomposition::isSingular() const {
+    return singular;
+}
+
+// Method to get the unit lower triangular factor
+SquareMat LUDecomposition::getLower() const {
+    const int n = lu.getSize();
+    SquareMat lower(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < i; ++j) {
+            lower[i][j] = lu[i][j];
+        }
+        lower[i][i] = 1.0;
+    }
+    return lower;
+}
+
+// Method to get the upper triangular factor
+SquareMat LUDecomposition::getUpper() const {
+    const int n = lu.getSize();
+    SquareMat upper(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = i; j < n; ++j) {
+            upper[i][j] = lu[i][j];
+        }
+    }
+    return upper;
+}
+
+// Method to get the row permutation
+const std::vector<int>& LUDecomposition::getPivots() const {
+    return pivots;
+}
+
+// Method to calculate the determinant
+double LUDecomposition::determinant() const {
+    long exponent = 0;
+    const double mantissa = scaledDeterminant(exponent);
+    // Beyond +-4096, ldexp saturates to inf or 0 anyway.
+    exponent = std::max(-4096L, std::min(4096L, exponent));
+    return std::ldexp(mantissa, static_cast<int>(exponent));
+}
+
+// Method to calculate the determinant as a signed mantissa and a power of two
+double LUDecomposition::scaledDeterminant(long& exponent) const {
+    exponent = 0;
+    if (singular) {
+        return 0.0;
+    }
+    return swapSign * diagonalProduct(lu, exponent);
+}
+
+// Method to calculate the logarithm of the determinant
+LogDeterminant LUDecomposition::logDeterminant() const {
+    LogDeterminant result;
+    long exponent = 0;
+    const double mantissa = scaledDeterminant(exponent);
+    if (mantissa == 0.0) {
+        result.sign = 0;
+        result.logAbs = -std::numeric_limits<double>::infinity();
+        return result;
+    }
+    result.sign = mantissa < 0.0 ? -1 : 1;
+    result.logAbs = std::log(std::fabs(mantissa)) + exponent * std::log(2.0);
+    return result;
+}
+
+// Solves A * x = b for a single right-hand side.
+std::vector<double> LUDecomposition::solve(const std::vector<double>& rhs) const {
+    checkRhsSize(lu.getSize(), static_cast<int>(rhs.size()));
+    if (singular) {
+        throw std::invalid_argument("Matrix is singular.");
+    }
+    return substituteVector(lu, pivots, rhs);
+}
+
+// Solves A * X = B for all the columns of B at once.
+SquareMat LUDecomposition::solve(const SquareMat& rhs) const {
+    const int n = lu.getSize();
+    checkRhsSize(n, rhs.getSize());
+    SquareMat x(n);
+    for (int i = 0; i < n; ++i) {
+        std::copy(rhs[pivots[i]], rhs[pivots[i]] + n, x[i]);
+    }
+    substitute(x);
+    return x;
+}
+
+// Calculates the inverse by solving A * X = I.
+SquareMat LUDecomposition::inverse() const {
+    const int n = lu.getSize();
+    SquareMat x(n);
+    for (int i = 0; i < n; ++i) {
+        x[i][pivots[i]] = 1.0;
+    }
+    substitute(x);
+    return x;
+}
+
+// Factors a symmetric positive definite matrix row by row: row i of L only needs
+// the rows above it, so every inner loop is a contiguous dot product.
+CholeskyDecomposition::CholeskyDecomposition(const SquareMat& matrix) : lower(matrix.getSize()) {
+    const int n = matrix.getSize();
+    for (int i = 0; i < n; ++i) {
+        double* row = lower[i];
+        const double* source = matrix[i];
+        for (int j = 0; j <= i; ++j) {
+            const double* other = lower[j];
+            double sum = source[j];
+            for (int p = 0; p < j; ++p) {
+                sum -= row[p] * other[p];
+            }
+            if (j < i) {
+                row[j] = sum / other[j];
+            } else if (sum > 0.0) {
+                row[i] = std::sqrt(sum);
+            } else {
+                throw std::invalid_argument("Matrix is not positive definite.");
+            }
+        }
+    }
+}
+
+// Method to get the size of the factored matrix
+int CholeskyDecomposition::getSize() const {
+    return lower.getSize();
+}
+
+// Method to get the lower triangular factor
+const SquareMat& CholeskyDecomposition::getLower() const {
+    return lower;
+}
+
+// Method to calculate the determinant
+double CholeskyDecomposition::determinant() const {
+    double product = 1.0;
+    for (int i = 0; i < lower.getSize(); ++i) {
+        product *= lower[i][i];
+    }
+    return product * product;
+}
+
+// Method to calculate the logarithm of the determinant
+LogDeterminant CholeskyDecomposition::logDeterminant() const {
+    LogDeterminant result;
+    result.sign = 1;
+    result.logAbs = 0.0;
+    for (int i = 0; i < lower.getSize(); ++i) {
+        result.logAbs += 2.0 * std::log(lower[i][i]);
+    }
+    return result;
+}
+
+// Solves A * x = b for a single right-hand side.
+std::vector<double> CholeskyDecomposition::solve(const std::vector<double>& rhs) const {
+    const int n = lower.getSize();
+    checkRhsSize(n, static_cast<int>(rhs.size()));
+    std::vector<double> x(rhs);
+    // L * y = b.
+    for (int i = 0; i < n; ++i) {
+        const double* row = lower[i];
+        double sum = x[i];
+        for (int p = 0; p < i; ++p) {
+            sum -= row[p] * x[p];
+        }
+        x[i] = sum / row[i];
+    }
+    // L^T * x = y, traversing L by rows.
+    for (int i = n - 1; i >= 0; --i) {
+        const double* row = lower[i];
+        x[i] /= row[i];
+        const double value = x[i];
+        for (int p = 0; p < i; ++p) {
+            x[p] -= row[p] * value;
+        }
+    }
+    return x;
+}
+
+// Solves A * X = B for all the columns of B at once.
+SquareMat CholeskyDecomposition::solve(const SquareMat& rhs) const {
+    const int n = lower.getSize();
+    checkRhsSize(n, rhs.getSize());
+    SquareMat x(rhs);
+    // L * Y = B.
+    for (int i = 0; i < n; ++i) {
+        double* target = x[i];
+        const double* row = lower[i];
+        for (int p = 0; p < i; ++p) {
+            const double factor = row[p];
+            const double* solved = x[p];
+            for (int c = 0; c < n; ++c) {
+                target[c] -= factor * solved[c];
+            }
+        }
+        for (int c = 0; c < n; ++c) {
+            target[c] /= row[i];
+        }
+    }
+    // L^T * X = Y.
+    for (int i = n - 1; i >= 0; --i) {
+        double* solved = x[i];
+        const double* row = lower[i];
+        for (int c = 0; c < n; ++c) {
+            solved[c] /= row[i];
+        }
+        for (int p = 0; p < i; ++p) {
+            const double factor = row[p];
+            double* target = x[p];
+            for (int c = 0; c < n; ++c) {
+                target[c] -= factor * solved[c];
+            }
+        }
+    }
+    return x;
+}
+
+// Calculates the inverse by solving A * X = I.
+SquareMat CholeskyDecomposition::inverse() const {
+    const int n = lower.getSize();
+    SquareMat identity(n);
+    for (int i = 0; i < n; ++i) {
+        identity[i][i] = 1.0;
+    }
+    return solve(identity);
+}
+
+// Factors the matrix with Householder reflections. Each reflector is applied to the
+// trailing columns row by row (w = v^T * A, then A -= tau * v * w) so the inner
+// loops stay contiguous in the row-major storage.
+QRDecomposition::QRDecomposition(const SquareMat& matrix)
+    : qr(matrix), tau(matrix.getSize(), 0.0), singular(false) {
+    const int n = qr.getSize();
+    std::vector<double> w(n);
+    for (int k = 0; k < n; ++k) {
+        double norm = 0.0;
+        for (int i = k; i < n; ++i) {
+            norm += qr[i][k] * qr[i][k];
+        }
+        norm = std::sqrt(norm);
+        if (norm == 0.0) {
+            singular = true;
+            continue; // H = I, the column is already zero below the diagonal.
+        }
+        const double head = qr[k][k];
+        const double beta = head > 0.0 ? -norm : norm;
+        tau[k] = (beta - head) / beta;
+        const double scale = 1.0 / (head - beta);
+        for (int i = k + 1; i < n; ++i) {
+            qr[i][k] *= scale;
+        }
+        qr[k][k] = beta;
+
+        // w = v^T * A(k:n, k+1:n), with v[k] = 1.
+        std::fill(w.begin() + k + 1, w.end(), 0.0);
+        for (int i = k; i < n; ++i) {
+            const double* row = qr[i];
+            const double v = i == k ? 1.0 : row[k];
+            for (int j = k + 1; j < n; ++j) {
+                w[j] += v * row[j];
+            }
+        }
+        for (int i = k; i < n; ++i) {
+            double* row = qr[i];
+            const double v = tau[k] * (i == k ? 1.0 : row[k]);
+            for (int j = k + 1; j < n; ++j) {
+                row[j] -= v * w[j];
+            }
+        }
+    }
+}
+
+// Private helper function to apply Q^T = H_{n-1} ... H_0 to every column of rhs.
+void QRDecomposition::applyQTranspose(SquareMat& rhs) const {
+    const int n = qr.getSize();
+    std::vector<double> w(n);
+    for (int k = 0; k < n; ++k) {
+        if (tau[k] == 0.0) {
+            continue;
+        }
+        std::copy(rhs[k], rhs[k] + n, w.begin());
+        for (int i = k + 1; i < n; ++i) {
+            const double v = qr[i][k];
+            const double* row = rhs[i];
+            for (int c = 0; c < n; ++c) {
+                w[c] += v * row[c];
+            }
+        }
+        for (int i = k; i < n; ++i) {
+            const double v = tau[k] * (i == k ? 1.0 : qr[i][k]);
+            double* row = rhs[i];
+            for (int c = 0; c < n; ++c) {
+                row[c] -= v * w[c];
+            }
+        }
+    }
+}
+
+// Private helper function to solve R * X = Y on every column of rhs.
+void QRDecomposition::backSubstitute(SquareMat& rhs) const {
+    if (singular) {
+        throw std::invalid_argument("Matrix is singular.");
+    }
+    const int n = qr.getSize();
+    for (int i = n - 1; i >= 0; --i) {
+        double* row = rhs[i];
+        const double* upper = qr[i];
+        for (int p = i + 1; p < n; ++p) {
+            const double factor = upper[p];
+            const double* solved = rhs[p];
+            for (int c = 0; c < n; ++c) {
+                row[c] -= factor * solved[c];
+            }
+        }
+        for (int c = 0; c < n; ++c) {
+            row[c] /= upper[i];
+        }
+    }
+}
+
+// Method to get the size of the factored matrix
+int QRDecomposition::getSize() const {
+    return qr.getSize();
+}
+
+// Method to check if the factored matrix is singular
+bool QRDecomposition::isSingular() const {
+    return singular;
+}
+
+// Method to get the orthogonal factor, the transpose of Q^T applied to the identity
+SquareMat QRDecomposition::getQ() const {
+    const int n = qr.getSize();
+    SquareMat q(n);
+    for (int i = 0; i < n; ++i) {
+        q[i][i] = 1.0;
+    }
+    applyQTranspose(q);
+    return ~q;
+}
+
+// Method to get the upper triangular factor
+SquareMat QRDecomposition::getR() const {
+    const int n = qr.getSize();
+    SquareMat r(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = i; j < n; ++j) {
+            r[i][j] = qr[i][j];
+        }
+    }
+    return r;
+}
+
+// Method to calculate the determinant
+double QRDecomposition::determinant() const {
+    if (singular) {
+        return 0.0;
+    }
+    double det = 1.0;
+    for (int i = 0; i < qr.getSize(); ++i) {
+        // Every non-trivial reflector has determinant -1.
+        det *= tau[i] == 0.0 ? qr[i][i] : -qr[i][i];
+    }
+    return det;
+}
+
+// Method to calculate the logarithm of the determinant
+LogDeterminant QRDecomposition::logDeterminant() const {
+    LogDeterminant result;
+    if (singular) {
+        result.sign = 0;
+        result.logAbs = -std::numeric_limits<double>::infinity();
+        return result;
+    }
+    result.sign = 1;
+    result.logAbs = 0.0;
+    for (int i = 0; i < qr.getSize(); ++i) {
+        const double diagonal = tau[i] == 0.0 ? qr[i][i] : -qr[i][i];
+        if (diagonal < 0.0) {
+            result.sign = -result.sign;
+        }
+        result.logAbs += std::log(std::fabs(diagonal));
+    }
+    return result;
+}
+
+// Solves A * x = b for a single right-hand side.
+std::vector<double> QRDecomposition::solve(const std::vector<double>& rhs) const {
+    const int n = qr.getSize();
+    checkRhsSize(n, static_cast<int>(rhs.size()));
+    if (singular) {
+        throw std::invalid_argument("Matrix is singular.");
+    }
+    std::vector<double> x(rhs);
+    for (int k = 0; k < n; ++k) {
+        if (tau[k] == 0.0) {
+            continue;
+        }
+        double dot = x[k];
+        for (int i = k + 1; i < n; ++i) {
+            dot += qr[i][k] * x[i];
+        }
+        dot *= tau[k];
+        x[k] -= dot;
+        for (int i = k + 1; i < n; ++i) {
+            x[i] -= qr[i][k] * dot;
+        }
+    }
+    for (int i = n - 1; i >= 0; --i) {
+        const double* upper = qr[i];
+        double sum = x[i];
+        for (int p = i + 1; p < n; ++p) {
+            sum -= upper[p] * x[p];
+        }
+        x[i] = sum / upper[i];
+    }
+    return x;
+}
+
+// Solves A * X = B for all the columns of B at once.
+SquareMat QRDecomposition::solve(const SquareMat& rhs) const {
+    checkRhsSize(qr.getSize(), rhs.getSize());
+    SquareMat x(rhs);
+    applyQTranspose(x);
+    backSubstitute(x);
+    return x;
+}
+
+// Calculates the inverse by solving A * X = I.
+SquareMat QRDecomposition::inverse() const {
+    const int n = qr.getSize();
+    SquareMat x(n);
+    for (int i = 0; i < n; ++i) {
+        x[i][i] = 1.0;
+    }
+    return solve(x);
+}
+
+// Factors the matrix in single precision.
+RefinedLUSolver::RefinedLUSolver(const SquareMat& matrix, int blockSize)
+    : matrix(matrix), lu(matrix.getSize()), pivots(matrix.getSize()), singular(false),
+      fallback(nullptr), iterations(0), fellBack(false) {
+    if (blockSize <= 0) {
+        throw std::invalid_argument("Block size must be a positive integer.");
+    }
+    const int n = matrix.getSize();
+    for (int i = 0; i < n; ++i) {
+        const double* in = matrix[i];
+        float* out = lu[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] = static_cast<float>(in[j]);
+        }
+    }
+    int swapSign = 1;
+    factorBlocked(lu, pivots, swapSign, singular, blockSize);
+    // Elements beyond the float range turn into infinities and NaNs.
+    for (int i = 0; i < n && !singular; ++i) {
+        singular = !std::isfinite(lu[i][i]);
+    }
+}
+
+// Destructor
+RefinedLUSolver::~RefinedLUSolver() {
+    delete fallback;
+}
+
+// Private helper function to get the double LU, computing it on first use.
+const LUDecomposition& RefinedLUSolver::getFallback() const {
+    if (!fallback) {
+        fallback = new LUDecomposition(matrix);
+    }
+    return *fallback;
+}
+
+// Method to get the size of the factored matrix
+int RefinedLUSolver::getSize() const {
+    return matrix.getSize();
+}
+
+// Solves A * x = b by refining the float solution in double.
+std::vector<double> RefinedLUSolver::solve(const std::vector<double>& rhs) const {
+    const int n = matrix.getSize();
+    checkRhsSize(n, static_cast<int>(rhs.size()));
+    iterations = 0;
+    fellBack = false;
+    if (!singular) {
+        const double tolerance = n * std::numeric_limits<double>::epsilon();
+        std::vector<double> x = substituteVector(lu, pivots, rhs);
+        std::vector<double> residual(n);
+        double previousStep = std::numeric_limits<double>::infinity();
+        while (iterations < MAX_ITERATIONS) {
+            bool converged = true;
+            for (int i = 0; i < n; ++i) {
+                const double* row = matrix[i];
+                double sum = rhs[i];
+                double scale = std::fabs(rhs[i]);
+                for (int j = 0; j < n; ++j) {
+                    sum -= row[j] * x[j];
+                    scale += std::fabs(row[j] * x[j]);
+                }
+                residual[i] = sum;
+                converged = converged && std::fabs(sum) <= tolerance * scale;
+            }
+            if (converged) {
+                return x;
+            }
+            std::vector<double> step = substituteVector(lu, pivots, residual);
+            double stepNorm = 0.0;
+            for (int i = 0; i < n; ++i) {
+                x[i] += step[i];
+                stepNorm = std::max(stepNorm, std::fabs(step[i]));
+            }
+            ++iterations;
+            // Converging steps shrink at least by half; anything else (NaN included) stalls.
+            if (!(stepNorm <= 0.5 * previousStep)) {
+                break;
+            }
+            previousStep = stepNorm;
+        }
+    }
+    fellBack = true;
+    return getFallback().solve(rhs);
+}
+
+// Solves A * X = B by refining the float solution in double.
+SquareMat RefinedLUSolver::solve(const SquareMat& rhs) const {
+    const int n = matrix.getSize();
+    checkRhsSize(n, rhs.getSize());
+    iterations = 0;
+    fellBack = false;
+    if (!singular) {
+        const double tolerance = n * std::numeric_limits<double>::epsilon();
+        SquareMat absMatrix(n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                absMatrix[i][j] = std::fabs(matrix[i][j]);
+            }
+        }
+        SquareMat x(n);
+        for (int i = 0; i < n; ++i) {
+            std::copy(rhs[pivots[i]], rhs[pivots[i]] + n, x[i]);
+        }
+        substituteColumns(lu, x);
+        double previousStep = std::numeric_limits<double>::infinity();
+        while (iterations < MAX_ITERATIONS) {
+            SquareMat residual = rhs - matrix * x;
+            SquareMat absX(n);
+            for (int i = 0; i < n; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    absX[i][j] = std::fabs(x[i][j]);
+                }
+            }
+            SquareMat scale = absMatrix * absX;
+            bool converged = true;
+            for (int i = 0; i < n && converged; ++i) {
+                for (int j = 0; j < n; ++j) {
+                    converged = converged &&
+                                std::fabs(residual[i][j]) <= tolerance * (scale[i][j] + std::fabs(rhs[i][j]));
+                }
+            }
+            if (converged) {
+                return x;
+            }
+            SquareMat step(n);
+            for (int i = 0; i < n; ++i) {
+                std::copy(residual[pivots[i]], residual[pivots[i]] + n, step[i]);
+            }
+            substituteColumns(lu, step);
+            double stepNorm = 0.0;
+            for (int i = 0; i < n; ++i) {
+                double* row = x[i];
+                const double* delta = step[i];
+                for (int j = 0; j < n; ++j) {
+                    row[j] += delta[j];
+                    stepNorm = std::max(stepNorm, std::fabs(delta[j]));
+                }
+            }
+            ++iterations;
+            if (!(stepNorm <= 0.5 * previousStep)) {
+                break;
+            }
+            previousStep = stepNorm;
+        }
+    }
+    fellBack = true;
+    return getFallback().solve(rhs);
+}
+
+// Method to get the number of refinement steps of the last solve
+int RefinedLUSolver::getIterations() const {
+    return iterations;
+}
+
+// Method to check if the last solve fell back to the double LU
+bool RefinedLUSolver::usedFallback() const {
+    return fellBack;
+}
+
+// Constructor that factors the matrix.
+InverseUpdater::InverseUpdater(const SquareMat& matrix)
+    : matrix(matrix), inv(matrix.getSize()), mantissa(0.0), exponent(0), singular(false), updates(0),
+      refreshInterval(matrix.getSize()), factorCount(0) {
+    refactor();
+}
+
+// Private helper function to factor the matrix again.
+void InverseUpdater::refactor() {
+    LUDecomposition lu(matrix);
+    ++factorCount;
+    updates = 0;
+    singular = lu.isSingular();
+    if (singular) {
+        mantissa = 0.0;
+        exponent = 0;
+        return;
+    }
+    inv = lu.inverse();
+    mantissa = lu.scaledDeterminant(exponent);
+}
+
+// Private helper function to apply a rank-one change: A^-1 -= x y^T / denominator.
+void InverseUpdater::update(const std::vector<double>& x, const std::vector<double>& y, double denominator) {
+    ++updates;
+    if (singular || (refreshInterval > 0 && updates >= refreshInterval)
+        || std::fabs(denominator) <= UPDATE_TOLERANCE * (1.0 + std::fabs(denominator - 1.0))) {
+        refactor();
+        return;
+    }
+    int shift = 0;
+    mantissa = std::frexp(mantissa * denominator, &shift);
+    exponent += shift;
+    const int n = matrix.getSize();
+    for (int i = 0; i < n; ++i) {
+        const double factor = x[i] / denominator;
+        if (factor != 0.0) {
+            double* row = inv[i];
+            for (int j = 0; j < n; ++j) {
+                row[j] -= factor * y[j];
+            }
+        }
+    }
+}
+
+// Method to get the size of the matrix
+int InverseUpdater::getSize() const {
+    return matrix.getSize();
+}
+
+// Method to get the current matrix
+const SquareMat& InverseUpdater::getMatrix() const {
+    return matrix;
+}
+
+// Method to get the inverse of the current matrix
+const SquareMat& InverseUpdater::getInverse() const {
+    if (singular) {
+        throw std::invalid_argument("Matrix is singular.");
+    }
+    return inv;
+}
+
+// Method to check if the current matrix is singular
+bool InverseUpdater::isSingular() const {
+    return singular;
+}
+
+// Method to get the determinant
+double InverseUpdater::determinant() const {
+    if (singular) {
+        return 0.0;
+    }
+    // Beyond +-4096, ldexp saturates to inf or 0 anyway.
+    return std::ldexp(mantissa, static_cast<int>(std::max(-4096L, std::min(4096L, exponent))));
+}
+
+// Method to get the logarithm of the determinant
+LogDeterminant InverseUpdater::logDeterminant() const {
+    LogDeterminant result;
+    if (singular) {
+        result.sign = 0;
+        result.logAbs = -std::numeric_limits<double>::infinity();
+        return result;
+    }
+    result.sign = mantissa < 0.0 ? -1 : 1;
+    result.logAbs = std::log(std::fabs(mantissa)) + exponent * std::log(2.0);
+    return result;
+}
+
+// Solves A * x = b by multiplying with the inverse.
+std::vector<double> InverseUpdater::solve(const std::vector<double>& rhs) const {
+    const int n = matrix.getSize();
+    checkRhsSize(n, static_cast<int>(rhs.size()));
+    const SquareMat& a = getInverse();
+    std::vector<double> x(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        const double* row = a[i];
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j) {
+            sum += row[j] * rhs[j];
+        }
+        x[i] = sum;
+    }
+    return x;
+}
+
+// Method to add u * v^T: x = A^-1 u and y^T = v^T A^-1 are two products with the inverse.
+void InverseUpdater::rankOneUpdate(const std::vector<double>& u, const std::vector<double>& v) {
+    const int n = matrix.getSize();
+    checkRhsSize(n, static_cast<int>(u.size()));
+    checkRhsSize(n, static_cast<int>(v.size()));
+    std::vector<double> x(n, 0.0);
+    std::vector<double> y(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        const double* row = inv[i];
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j) {
+            sum += row[j] * u[j];
+            y[j] += v[i] * row[j];
+        }
+        x[i] = sum;
+        double* target = matrix[i];
+        for (int j = 0; j < n; ++j) {
+            target[j] += u[i] * v[j];
+        }
+    }
+    double vx = 0.0;
+    for (int i = 0; i < n; ++i) {
+        vx += v[i] * x[i];
+    }
+    update(x, y, 1.0 + vx);
+}
+
+// Method to replace a row: u = e_row, so x is column row of the inverse.
+void InverseUpdater::replaceRow(int row, const std::vector<double>& values) {
+    const int n = matrix.getSize();
+    checkIndex(n, row);
+    checkRhsSize(n, static_cast<int>(values.size()));
+    std::vector<double> x(n);
+    std::vector<double> y(n, 0.0);
+    double* target = matrix[row];
+    for (int i = 0; i < n; ++i) {
+        const double* inverseRow = inv[i];
+        const double delta = values[i] - target[i];
+        x[i] = inverseRow[row];
+        for (int j = 0; j < n; ++j) {
+            y[j] += delta * inverseRow[j];
+        }
+    }
+    double vx = 0.0;
+    for (int i = 0; i < n; ++i) {
+        vx += (values[i] - target[i]) * x[i];
+    }
+    std::copy(values.begin(), values.end(), target);
+    update(x, y, 1.0 + vx);
+}
+
+// Method to replace a column: v = e_col, so y is row col of the inverse.
+void InverseUpdater::replaceColumn(int col, const std::vector<double>& values) {
+    const int n = matrix.getSize();
+    checkIndex(n, col);
+    checkRhsSize(n, static_cast<int>(values.size()));
+    std::vector<double> delta(n);
+    for (int i = 0; i < n; ++i) {
+        delta[i] = values[i] - matrix[i][col];
+        matrix[i][col] = values[i];
+    }
+    std::vector<double> x(n);
+    for (int i = 0; i < n; ++i) {
+        const double* row = inv[i];
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j) {
+            sum += row[j] * delta[j];
+        }
+        x[i] = sum;
+    }
+    std::vector<double> y(inv[col], inv[col] + n);
+    update(x, y, 1.0 + x[col]);
+}
+
+// Method to set one element: u = e_row and v = (value - a) e_col.
+void InverseUpdater::set(int row, int col, double value) {
+    const int n = matrix.getSize();
+    checkIndex(n, row);
+    checkIndex(n, col);
+    const double delta = value - matrix[row][col];
+    matrix[row][col] = value;
+    std::vector<double> x(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = inv[i][row];
+    }
+    std::vector<double> y(inv[col], inv[col] + n);
+    for (int j = 0; j < n; ++j) {
+        y[j] *= delta;
+    }
+    update(x, y, 1.0 + delta * x[col]);
+}
+
+// Method to get the number of updates between two factorizations
+int InverseUpdater::getRefreshInterval() const {
+    return refreshInterval;
+}
+
+// Method to set the number of updates between two factorizations
+void InverseUpdater::setRefreshInterval(int interval) {
+    if (interval < 0) {
+        throw std::invalid_argument("Refresh interval must not be negative.");
+    }
+    refreshInterval = interval;
+}
+
+// Method to get the number of factorizations
+int InverseUpdater::getFactorCount() const {
+    return factorCount;
+}
+
+// Solves A * x = b, preferring Cholesky for symmetric positive definite matrices.
+std::vector<double> solve(const SquareMat& matrix, const std::vector<double>& rhs) {
+    if (maybePositiveDefinite(matrix)) {
+        try {
+            return CholeskyDecomposition(matrix).solve(rhs);
+        } catch (const std::invalid_argument&) {
+            // Symmetric but indefinite: fall through to LU.
+        }
+    }
+    return LUDecomposition(matrix).solve(rhs);
+}
+
+// Solves A * X = B, preferring Cholesky for symmetric positive definite matrices.
+SquareMat solve(const SquareMat& matrix, const SquareMat& rhs) {
+    if (maybePositiveDefinite(matrix)) {
+        try {
+            return CholeskyDecomposition(matrix).solve(rhs);
+        } catch (const std::invalid_argument&) {
+            // Symmetric but indefinite: fall through to LU.
+        }
+    }
+    return LUDecomposition(matrix).solve(rhs);
+}
+
+// Solves A * x = b with the given precision.
+std::vector<double> solve(const SquareMat& matrix, const std::vector<double>& rhs, SolvePrecision precision) {
+    if (precision == SolvePrecision::Refined) {
+        return RefinedLUSolver(matrix).solve(rhs);
+    }
+    return solve(matrix, rhs);
+}
+
+// Solves A * X = B with the given precision.
+SquareMat solve(const SquareMat& matrix, const SquareMat& rhs, SolvePrecision precision) {
+    if (precision == SolvePrecision::Refined) {
+        return RefinedLUSolver(matrix).solve(rhs);
+    }
+    return solve(matrix, rhs);
+}
+
+} // namespace matrix
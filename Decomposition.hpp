@@ -0,0 +1,461 @@
+#ifndef DECOMPOSITION_HPP
+#define DECOMPOSITION_HPP
+
+#include "SquareMat.hpp"
+#include <vector>
+
+namespace matrix {
+
+class TaskScheduler;
+
+/**
+ * @brief LU factorization with partial pivoting, P * A = L * U.
+ *
+ * The factorization is computed once (O(n^3), blocked so the trailing update runs
+ * as a cache-friendly matrix product) and can then be reused for any number of
+ * right-hand sides at O(n^2) each. Large matrices are factored in parallel as a
+ * task graph on the TaskScheduler.
+ */
+class LUDecomposition {
+private:
+    SquareMat lu;             // L below the diagonal (unit diagonal implied), U on and above it.
+    std::vector<int> pivots;  // Row i of P * A is row pivots[i] of A.
+    int swapSign;             // +1 or -1, the sign of the permutation P.
+    bool singular;            // True if a zero pivot was met.
+
+    /**
+     * @brief Solves L * U * X = B in place, B being already permuted by P.
+     */
+    void substitute(SquareMat& rhs) const;
+
+    /**
+     * @brief Serial right-looking blocked factorization of lu.
+     */
+    void factorSerial(int blockSize);
+
+    /**
+     * @brief Tiled factorization of lu as a task graph: panel factorizations, triangular
+     * solves and trailing tile updates, with lookahead on the next panel.
+     */
+    void factorParallel(int blockSize, TaskScheduler& scheduler);
+
+public:
+/**
+ * @brief Minimum size for which the constructor factors in parallel.
+ */
+static const int PARALLEL_THRESHOLD = 256;
+
+/**
+ * @brief Factors the matrix. blockSize is the width of the panels of the blocked algorithm.
+ * Matrices of at least PARALLEL_THRESHOLD rows are factored in parallel on the shared
+ * scheduler when it has more than one thread.
+ */
+explicit LUDecomposition(const SquareMat& matrix, int blockSize = 64);
+
+/**
+ * @brief Factors the matrix in parallel on the given scheduler, whatever its size.
+ * The result is identical to the serial factorization with the same block size.
+ */
+LUDecomposition(const SquareMat& matrix, TaskScheduler& scheduler, int blockSize = 64);
+
+/**
+ * @brief Gets the size (dimension) of the factored matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Returns true if the factored matrix is singular.
+ */
+bool isSingular() const;
+
+/**
+ * @brief Gets the unit lower triangular factor L.
+ */
+SquareMat getLower() const;
+
+/**
+ * @brief Gets the upper triangular factor U.
+ */
+SquareMat getUpper() const;
+
+/**
+ * @brief Gets the row permutation: row i of P * A is row getPivots()[i] of A.
+ */
+const std::vector<int>& getPivots() const;
+
+/**
+ * @brief Calculates the determinant, the signed product of the diagonal of U. The product
+ * is renormalized along the way, so it overflows or underflows only if the result does.
+ */
+double determinant() const;
+
+/**
+ * @brief Calculates the determinant as mantissa * 2^exponent without overflow or underflow,
+ * returning the signed mantissa, of magnitude in [0.5, 1); 0, exponent 0, if A is singular.
+ * determinant() and logDeterminant() are both built on it.
+ */
+double scaledDeterminant(long& exponent) const;
+
+/**
+ * @brief Calculates the sign and the logarithm of the absolute value of the determinant,
+ * from the same renormalized product: one logarithm in total, finite for any nonsingular A.
+ */
+LogDeterminant logDeterminant() const;
+
+/**
+ * @brief Solves A * x = b. Throws std::invalid_argument if A is singular.
+ */
+std::vector<double> solve(const std::vector<double>& rhs) const;
+
+/**
+ * @brief Solves A * X = B for all the columns of B at once.
+ */
+SquareMat solve(const SquareMat& rhs) const;
+
+/**
+ * @brief Calculates the inverse of A by solving A * X = I.
+ */
+SquareMat inverse() const;
+};
+
+/**
+ * @brief Cholesky factorization A = L * L^T of a symmetric positive definite matrix.
+ *
+ * Half the work of LU and no pivoting. The constructor throws std::invalid_argument
+ * if the matrix is not symmetric positive definite.
+ */
+class CholeskyDecomposition {
+private:
+    SquareMat lower;
+
+public:
+/**
+ * @brief Factors the matrix, reading only its lower triangle.
+ */
+explicit CholeskyDecomposition(const SquareMat& matrix);
+
+/**
+ * @brief Gets the size (dimension) of the factored matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the lower triangular factor L.
+ */
+const SquareMat& getLower() const;
+
+/**
+ * @brief Calculates the determinant, the squared product of the diagonal of L.
+ */
+double determinant() const;
+
+/**
+ * @brief Calculates the logarithm of the determinant (which is always positive).
+ */
+LogDeterminant logDeterminant() const;
+
+/**
+ * @brief Solves A * x = b.
+ */
+std::vector<double> solve(const std::vector<double>& rhs) const;
+
+/**
+ * @brief Solves A * X = B for all the columns of B at once.
+ */
+SquareMat solve(const SquareMat& rhs) const;
+
+/**
+ * @brief Calculates the inverse of A.
+ */
+SquareMat inverse() const;
+};
+
+/**
+ * @brief Householder QR factorization A = Q * R.
+ *
+ * About twice the work of LU but unconditionally stable, which makes it the choice
+ * for badly conditioned systems. Q is kept as its Householder reflectors.
+ */
+class QRDecomposition {
+private:
+    SquareMat qr;             // R on and above the diagonal, reflectors (unit head implied) below.
+    std::vector<double> tau;  // Scaling of each reflector H = I - tau * v * v^T.
+    bool singular;            // True if R has a zero on its diagonal.
+
+    /**
+     * @brief Applies Q^T to every column of rhs in place.
+     */
+    void applyQTranspose(SquareMat& rhs) const;
+
+    /**
+     * @brief Solves R * X = Y in place.
+     */
+    void backSubstitute(SquareMat& rhs) const;
+
+public:
+/**
+ * @brief Factors the matrix.
+ */
+explicit QRDecomposition(const SquareMat& matrix);
+
+/**
+ * @brief Gets the size (dimension) of the factored matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Returns true if the factored matrix is singular.
+ */
+bool isSingular() const;
+
+/**
+ * @brief Gets the orthogonal factor Q.
+ */
+SquareMat getQ() const;
+
+/**
+ * @brief Gets the upper triangular factor R.
+ */
+SquareMat getR() const;
+
+/**
+ * @brief Calculates the determinant, the product of the diagonal of R times det(Q) = +-1.
+ */
+double determinant() const;
+
+/**
+ * @brief Calculates the sign and the logarithm of the absolute value of the determinant.
+ */
+LogDeterminant logDeterminant() const;
+
+/**
+ * @brief Solves A * x = b. Throws std::invalid_argument if A is singular.
+ */
+std::vector<double> solve(const std::vector<double>& rhs) const;
+
+/**
+ * @brief Solves A * X = B for all the columns of B at once.
+ */
+SquareMat solve(const SquareMat& rhs) const;
+
+/**
+ * @brief Calculates the inverse of A.
+ */
+SquareMat inverse() const;
+};
+
+/**
+ * @brief Solves linear systems with a single-precision LU factorization refined in double.
+ *
+ * The float factorization moves half the data of the double one. Every solve starts from
+ * the float solution and repeats x += LU^-1 * (b - A * x), the residual being computed in
+ * double, until every |r_i| is within n * epsilon of (|A| |x| + |b|)_i, a componentwise
+ * backward error at the level of double rounding; for well-conditioned matrices this
+ * takes a few O(n^2) steps. If the float factorization is singular, or the corrections stop
+ * shrinking (condition number near 1 / float epsilon), the solve falls back to a double LU,
+ * computed once and kept.
+ */
+class RefinedLUSolver {
+private:
+    SquareMat matrix;                   // The double matrix, for the residuals and the fallback.
+    BasicSquareMat<float> lu;           // Float L and U, stored like in LUDecomposition.
+    std::vector<int> pivots;
+    bool singular;                      // True if the float factorization met a zero pivot.
+    mutable LUDecomposition* fallback;  // Double LU, computed on the first fallback.
+    mutable int iterations;             // Refinement steps of the last solve.
+    mutable bool fellBack;              // Whether the last solve used the double LU.
+
+    /**
+     * @brief Gets the double LU, computing it on first use.
+     */
+    const LUDecomposition& getFallback() const;
+
+    RefinedLUSolver(const RefinedLUSolver&);
+    RefinedLUSolver& operator=(const RefinedLUSolver&);
+
+public:
+/**
+ * @brief Maximum number of refinement steps before falling back to the double LU.
+ */
+static const int MAX_ITERATIONS = 30;
+
+/**
+ * @brief Factors the matrix in single precision.
+ */
+explicit RefinedLUSolver(const SquareMat& matrix, int blockSize = 64);
+
+/**
+ * @brief Destructor for the RefinedLUSolver class.
+ */
+~RefinedLUSolver();
+
+/**
+ * @brief Gets the size (dimension) of the factored matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Solves A * x = b to double accuracy. Throws std::invalid_argument if A is singular.
+ */
+std::vector<double> solve(const std::vector<double>& rhs) const;
+
+/**
+ * @brief Solves A * X = B for all the columns of B at once, the residual B - A * X
+ * being computed with SquareMat::operator*.
+ */
+SquareMat solve(const SquareMat& rhs) const;
+
+/**
+ * @brief Gets the number of refinement steps of the last solve.
+ */
+int getIterations() const;
+
+/**
+ * @brief Returns true if the last solve fell back to the double LU.
+ */
+bool usedFallback() const;
+};
+
+/**
+ * @brief The inverse and determinant of a matrix, kept up to date through rank-one changes.
+ *
+ * The matrix is factored once (LU, O(n^3)); then each change A + u v^T, of which replacing a
+ * row or a column and setting an element are special cases, updates the inverse by the
+ * Sherman-Morrison formula and the determinant by the matrix determinant lemma,
+ * det(A + u v^T) = det(A) (1 + v^T A^-1 u), in O(n^2). When 1 + v^T A^-1 u nearly cancels,
+ * the update would be mostly rounding error, so the matrix is factored again instead; it also
+ * is every getRefreshInterval() updates (n by default, O(n^2) amortized), which bounds the
+ * drift of the inverse. While the matrix is singular every change refactors it.
+ */
+class InverseUpdater {
+private:
+    SquareMat matrix;
+    SquareMat inv;        // A^-1, unused while singular.
+    double mantissa;      // det A = mantissa * 2^exponent, |mantissa| in [0.5, 1).
+    long exponent;
+    bool singular;
+    int updates;          // Updates since the last factorization.
+    int refreshInterval;
+    int factorCount;
+
+    /**
+     * @brief Factors the matrix and recomputes the inverse and the determinant.
+     */
+    void refactor();
+
+    /**
+     * @brief Applies a change already made to the matrix, given x = A^-1 u, y^T = v^T A^-1
+     * and the denominator 1 + v^T A^-1 u of the old A.
+     */
+    void update(const std::vector<double>& x, const std::vector<double>& y, double denominator);
+
+public:
+/**
+ * @brief Factors the matrix. It may be singular.
+ */
+explicit InverseUpdater(const SquareMat& matrix);
+
+/**
+ * @brief Gets the size (dimension) of the matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the current matrix.
+ */
+const SquareMat& getMatrix() const;
+
+/**
+ * @brief Gets the inverse of the current matrix. Throws std::invalid_argument if it is singular.
+ */
+const SquareMat& getInverse() const;
+
+/**
+ * @brief Returns true if the current matrix is singular.
+ */
+bool isSingular() const;
+
+/**
+ * @brief Gets the determinant of the current matrix.
+ */
+double determinant() const;
+
+/**
+ * @brief Gets the sign and the logarithm of the absolute value of the determinant.
+ */
+LogDeterminant logDeterminant() const;
+
+/**
+ * @brief Solves A * x = b with the inverse, in O(n^2). Throws std::invalid_argument if A is
+ * singular.
+ */
+std::vector<double> solve(const std::vector<double>& rhs) const;
+
+/**
+ * @brief Adds u * v^T to the matrix.
+ */
+void rankOneUpdate(const std::vector<double>& u, const std::vector<double>& v);
+
+/**
+ * @brief Replaces a row of the matrix. Throws std::out_of_range for a bad index.
+ */
+void replaceRow(int row, const std::vector<double>& values);
+
+/**
+ * @brief Replaces a column of the matrix. Throws std::out_of_range for a bad index.
+ */
+void replaceColumn(int col, const std::vector<double>& values);
+
+/**
+ * @brief Sets one element of the matrix. Throws std::out_of_range for a bad index.
+ */
+void set(int row, int col, double value);
+
+/**
+ * @brief Gets the number of updates between two factorizations, 0 for none.
+ */
+int getRefreshInterval() const;
+
+/**
+ * @brief Sets the number of updates between two factorizations, 0 for none. Throws
+ * std::invalid_argument if negative.
+ */
+void setRefreshInterval(int interval);
+
+/**
+ * @brief Gets the number of LU factorizations done so far, the first one included.
+ */
+int getFactorCount() const;
+};
+
+/**
+ * @brief How the free solve functions factor the matrix.
+ */
+enum class SolvePrecision {
+    Double,  // Cholesky or LU in double.
+    Refined  // Float LU with iterative refinement in double (RefinedLUSolver).
+};
+
+/**
+ * @brief Solves A * x = b, using Cholesky when A is symmetric positive definite and LU otherwise.
+ */
+std::vector<double> solve(const SquareMat& matrix, const std::vector<double>& rhs);
+
+/**
+ * @brief Solves A * X = B, using Cholesky when A is symmetric positive definite and LU otherwise.
+ */
+SquareMat solve(const SquareMat& matrix, const SquareMat& rhs);
+
+/**
+ * @brief Solves A * x = b with the given precision.
+ */
+std::vector<double> solve(const SquareMat& matrix, const std::vector<double>& rhs, SolvePrecision precision);
+
+/**
+ * @brief Solves A * X = B with the given precision.
+ */
+SquareMat solve(const SquareMat& matrix, const SquareMat& rhs, SolvePrecision precision);
+
+} // namespace matrix
+
+#endif // DECOMPOSITION_HPP
@@ -0,0 +1,576 @@
+#include "Eigen.hpp"
+#include "TaskScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+
+// QL iterations allowed per eigenvalue; two or three are typical.
+const int QL_MAX_ITERATIONS = 30;
+
+// Rotations buffered by the QL sweeps before they are applied to the eigenvectors, and the
+// number of columns they are applied to at a time: a block of every row fits in L2, so
+// all the buffered sweeps reuse it instead of streaming the whole matrix once per sweep.
+const int ROTATION_BATCH = 8192;
+const int COLUMN_BLOCK = 64;
+
+// A Givens rotation of rows row and row + 1.
+struct Rotation {
+    int row;
+    double c;
+    double s;
+};
+
+// Applies the rotations in order to columns [begin, end) of w.
+void applyRotations(SquareMat& w, const std::vector<Rotation>& rotations, int begin, int end) {
+    for (size_t r = 0; r < rotations.size(); ++r) {
+        const double c = rotations[r].c;
+        const double s = rotations[r].s;
+        double* lower = w[rotations[r].row];
+        double* upper = w[rotations[r].row + 1];
+        for (int k = begin; k < end; ++k) {
+            const double h = upper[k];
+            upper[k] = s * lower[k] + c * h;
+            lower[k] = c * lower[k] - s * h;
+        }
+    }
+}
+
+// Applies and clears the buffered rotations, one column block at a time. Columns transform
+// independently, so the blocks run in parallel for large matrices.
+void flushRotations(SquareMat& w, std::vector<Rotation>& rotations) {
+    const int n = w.getSize();
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    if (n < SymmetricEigen::PARALLEL_THRESHOLD || scheduler.getThreadCount() < 2) {
+        for (int begin = 0; begin < n; begin += COLUMN_BLOCK) {
+            applyRotations(w, rotations, begin, std::min(n, begin + COLUMN_BLOCK));
+        }
+    } else {
+        TaskGraph graph;
+        for (int begin = 0; begin < n; begin += COLUMN_BLOCK) {
+            const int end = std::min(n, begin + COLUMN_BLOCK);
+            graph.addTask([&w, &rotations, begin, end] { applyRotations(w, rotations, begin, end); });
+        }
+        graph.run(scheduler);
+    }
+    rotations.clear();
+}
+
+// Householder reduction of the symmetric matrix v (row-major, n x n) to tridiagonal form
+// with diagonal d and subdiagonal e[1..n-1]; v is overwritten by the transpose of the
+// orthogonal transform. Working on the transpose keeps every inner loop along a row.
+void tridiagonalize(std::vector<double>& v, int n, std::vector<double>& d, std::vector<double>& e) {
+    for (int j = 0; j < n; ++j) {
+        d[j] = v[j * n + n - 1];
+    }
+    for (int i = n - 1; i > 0; --i) {
+        // Scale the row to avoid under/overflow of the reflector.
+        double scale = 0.0;
+        double h = 0.0;
+        for (int k = 0; k < i; ++k) {
+            scale += std::fabs(d[k]);
+        }
+        if (scale == 0.0) {
+            e[i] = d[i - 1];
+            for (int j = 0; j < i; ++j) {
+                d[j] = v[j * n + i - 1];
+                v[j * n + i] = 0.0;
+                v[i * n + j] = 0.0;
+            }
+        } else {
+            for (int k = 0; k < i; ++k) {
+                d[k] /= scale;
+                h += d[k] * d[k];
+            }
+            double f = d[i - 1];
+            double g = std::sqrt(h);
+            if (f > 0) {
+                g = -g;
+            }
+            e[i] = scale * g;
+            h -= f * g;
+            d[i - 1] = f - g;
+            for (int j = 0; j < i; ++j) {
+                e[j] = 0.0;
+            }
+            // e = A u, using the upper triangle only.
+            for (int j = 0; j < i; ++j) {
+                f = d[j];
+                v[i * n + j] = f;
+                g = e[j] + v[j * n + j] * f;
+                for (int k = j + 1; k <= i - 1; ++k) {
+                    g += v[j * n + k] * d[k];
+                    e[k] += v[j * n + k] * f;
+                }
+                e[j] = g;
+            }
+            f = 0.0;
+            for (int j = 0; j < i; ++j) {
+                e[j] /= h;
+                f += e[j] * d[j];
+            }
+            const double hh = f / (h + h);
+            for (int j = 0; j < i; ++j) {
+                e[j] -= hh * d[j];
+            }
+            // Rank-two update A -= u e^T + e u^T.
+            for (int j = 0; j < i; ++j) {
+                f = d[j];
+                g = e[j];
+                for (int k = j; k <= i - 1; ++k) {
+                    v[j * n + k] -= f * e[k] + g * d[k];
+                }
+                d[j] = v[j * n + i - 1];
+                v[j * n + i] = 0.0;
+            }
+        }
+        d[i] = h;
+    }
+    // Accumulate the reflectors.
+    for (int i = 0; i < n - 1; ++i) {
+        v[i * n + n - 1] = v[i * n + i];
+        v[i * n + i] = 1.0;
+        const double h = d[i + 1];
+        if (h != 0.0) {
+            for (int k = 0; k <= i; ++k) {
+                d[k] = v[(i + 1) * n + k] / h;
+            }
+            for (int j = 0; j <= i; ++j) {
+                double g = 0.0;
+                for (int k = 0; k <= i; ++k) {
+                    g += v[(i + 1) * n + k] * v[j * n + k];
+                }
+                for (int k = 0; k <= i; ++k) {
+                    v[j * n + k] -= g * d[k];
+                }
+            }
+        }
+        for (int k = 0; k <= i; ++k) {
+            v[(i + 1) * n + k] = 0.0;
+        }
+    }
+    for (int j = 0; j < n; ++j) {
+        d[j] = v[j * n + n - 1];
+        v[j * n + n - 1] = 0.0;
+    }
+    v[(n - 1) * n + n - 1] = 1.0;
+    e[0] = 0.0;
+}
+
+// Implicit QL iteration with Wilkinson shifts on the tridiagonal matrix (d, e). Row i of w is
+// the i-th column of the transform, so each rotation updates two contiguous rows; the
+// rotations are buffered and applied in batches by flushRotations().
+void diagonalize(SquareMat& w, int n, std::vector<double>& d, std::vector<double>& e) {
+    for (int i = 1; i < n; ++i) {
+        e[i - 1] = e[i];
+    }
+    e[n - 1] = 0.0;
+    const double eps = std::numeric_limits<double>::epsilon();
+    double f = 0.0;
+    double tst1 = 0.0;
+    std::vector<Rotation> rotations;
+    rotations.reserve(ROTATION_BATCH + n);
+    for (int l = 0; l < n; ++l) {
+        // Find the first negligible subdiagonal element.
+        tst1 = std::max(tst1, std::fabs(d[l]) + std::fabs(e[l]));
+        int m = l;
+        while (m < n - 1 && std::fabs(e[m]) > eps * tst1) {
+            ++m;
+        }
+        int iteration = 0;
+        while (m > l && std::fabs(e[l]) > eps * tst1) {
+            if (++iteration > QL_MAX_ITERATIONS) {
+                throw std::invalid_argument("Eigenvalue iteration did not converge.");
+            }
+            // Shift by the eigenvalue of the leading 2 x 2 block closer to d[l].
+            double g = d[l];
+            double p = (d[l + 1] - g) / (2.0 * e[l]);
+            double r = std::hypot(p, 1.0);
+            if (p < 0) {
+                r = -r;
+            }
+            d[l] = e[l] / (p + r);
+            d[l + 1] = e[l] * (p + r);
+            const double dl1 = d[l + 1];
+            double h = g - d[l];
+            for (int i = l + 2; i < n; ++i) {
+                d[i] -= h;
+            }
+            f += h;
+            // Chase the bulge with Givens rotations from m up to l.
+            p = d[m];
+            double c = 1.0;
+            double c2 = c;
+            double c3 = c;
+            const double el1 = e[l + 1];
+            double s = 0.0;
+            double s2 = 0.0;
+            for (int i = m - 1; i >= l; --i) {
+                c3 = c2;
+                c2 = c;
+                s2 = s;
+                g = c * e[i];
+                h = c * p;
+                r = std::hypot(p, e[i]);
+                e[i + 1] = s * r;
+                s = e[i] / r;
+                c = p / r;
+                p = c * d[i] - s * g;
+                d[i + 1] = h + s * (c * g + s * d[i]);
+                Rotation rotation = {i, c, s};
+                rotations.push_back(rotation);
+            }
+            p = -s * s2 * c3 * el1 * e[l] / dl1;
+            e[l] = s * p;
+            d[l] = c * p;
+            if (static_cast<int>(rotations.size()) >= ROTATION_BATCH) {
+                flushRotations(w, rotations);
+            }
+        }
+        d[l] += f;
+        e[l] = 0.0;
+    }
+    flushRotations(w, rotations);
+}
+
+
+// Jacobi sweeps allowed before the SVD gives up; convergence is quadratic once the columns
+// are nearly orthogonal.
+const int JACOBI_MAX_SWEEPS = 60;
+
+// Dot product of two rows with four independent partial sums.
+double rowDot(const double* x, const double* y, int count) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+    }
+    for (; i < count; ++i) {
+        s0 += x[i] * y[i];
+    }
+    return (s0 + s2) + (s1 + s3);
+}
+
+// Rotates rows x and y: x <- c x - s y, y <- s x + c y.
+void rotateRows(double* x, double* y, int count, double c, double s) {
+    for (int k = 0; k < count; ++k) {
+        const double h = x[k];
+        x[k] = c * h - s * y[k];
+        y[k] = s * h + c * y[k];
+    }
+}
+
+// Orthogonalizes the pair of rows p and q of w (columns of A), rotating the rows of v along
+// if given and updating the squared norms. Returns whether a rotation was applied.
+bool orthogonalizePair(SquareMat& w, SquareMat* v, std::vector<double>& norms, int p, int q, double tolerance) {
+    const int n = w.getSize();
+    const double alpha = norms[p];
+    const double beta = norms[q];
+    const double gamma = rowDot(w[p], w[q], n);
+    if (alpha <= 0.0 || beta <= 0.0 || std::fabs(gamma) <= tolerance * std::sqrt(alpha) * std::sqrt(beta)) {
+        return false;
+    }
+    // The rotation that zeroes gamma, with the smaller angle.
+    const double zeta = (beta - alpha) / (2.0 * gamma);
+    const double t = (zeta >= 0 ? 1.0 : -1.0) / (std::fabs(zeta) + std::hypot(1.0, zeta));
+    const double c = 1.0 / std::hypot(1.0, t);
+    const double s = c * t;
+    rotateRows(w[p], w[q], n, c, s);
+    if (v) {
+        rotateRows((*v)[p], (*v)[q], n, c, s);
+    }
+    norms[p] = alpha - t * gamma;
+    norms[q] = beta + t * gamma;
+    return true;
+}
+
+} // namespace
+
+// Checks the symmetry exactly.
+bool isSymmetric(const SquareMat& matrix) {
+    const int n = matrix.getSize();
+    for (int i = 0; i < n; ++i) {
+        const double* row = matrix[i];
+        for (int j = 0; j < i; ++j) {
+            if (row[j] != matrix[j][i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Constructor that reduces to tridiagonal form, diagonalizes and sorts the eigenpairs.
+SymmetricEigen::SymmetricEigen(const SquareMat& matrix) : size(matrix.getSize()), values(size), basis(size) {
+    if (!isSymmetric(matrix)) {
+        throw std::invalid_argument("Matrix must be symmetric.");
+    }
+    const int n = size;
+    std::vector<double> v(static_cast<size_t>(n) * n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            // The QL tests pass on infinite or NaN elements and return meaningless pairs.
+            if (!std::isfinite(matrix[i][j])) {
+                throw std::invalid_argument("Matrix has non-finite elements.");
+            }
+        }
+        std::copy(matrix[i], matrix[i] + n, v.begin() + static_cast<size_t>(i) * n);
+    }
+    std::vector<double> off(n);
+    tridiagonalize(v, n, values, off);
+    for (int i = 0; i < n; ++i) {
+        std::copy(v.begin() + static_cast<size_t>(i) * n, v.begin() + static_cast<size_t>(i + 1) * n, basis[i]);
+    }
+    diagonalize(basis, n, values, off);
+    // Selection sort, moving the eigenvector rows along.
+    for (int i = 0; i < n - 1; ++i) {
+        int smallest = i;
+        for (int j = i + 1; j < n; ++j) {
+            if (values[j] < values[smallest]) {
+                smallest = j;
+            }
+        }
+        if (smallest != i) {
+            std::swap(values[i], values[smallest]);
+            std::swap_ranges(basis[i], basis[i] + n, basis[smallest]);
+        }
+    }
+}
+
+// Method to get the size
+int SymmetricEigen::getSize() const {
+    return size;
+}
+
+// Method to get the eigenvalues
+const std::vector<double>& SymmetricEigen::getEigenvalues() const {
+    return values;
+}
+
+// Method to get the eigenvectors as columns
+SquareMat SymmetricEigen::getEigenvectors() const {
+    return ~basis;
+}
+
+// Method to get one eigenvector
+Vector SymmetricEigen::getEigenvector(int index) const {
+    if (index < 0 || index >= size) {
+        throw std::out_of_range("Index out of range.");
+    }
+    const double* row = basis[index];
+    return Vector(std::vector<double>(row, row + size));
+}
+
+// Method to calculate a power from the spectrum: V diag(lambda^k) V^T, symmetrized.
+SquareMat SymmetricEigen::power(int exponent) const {
+    SquareMat result(size);
+    power(exponent, result);
+    return result;
+}
+
+// Method to calculate the power into a matrix of the same size
+void SymmetricEigen::power(int exponent, SquareMat& result) const {
+    if (exponent < 0) {
+        throw std::invalid_argument("Exponent must be a non-negative integer.");
+    }
+    if (result.getSize() != size) {
+        throw std::invalid_argument("Result must have the size of the decomposed matrix.");
+    }
+    const int n = size;
+    SquareMat scaled(basis);
+    for (int i = 0; i < n; ++i) {
+        const double factor = std::pow(values[i], exponent);
+        double* row = scaled[i];
+        for (int k = 0; k < n; ++k) {
+            row[k] *= factor;
+        }
+    }
+    gemm(1.0, ~basis, scaled, 0.0, result);
+    for (int i = 0; i < n; ++i) {
+        double* row = result[i];
+        for (int j = 0; j < i; ++j) {
+            const double mean = 0.5 * (row[j] + result[j][i]);
+            row[j] = mean;
+            result[j][i] = mean;
+        }
+    }
+}
+
+// Constructor that runs the Jacobi sweeps on the columns of A, stored as the rows of left.
+SingularValueDecomposition::SingularValueDecomposition(const SquareMat& matrix, bool vectors)
+    : size(matrix.getSize()), sweeps(0), vectors(vectors), values(size), left(~matrix), right(size) {
+    const int n = size;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            if (!std::isfinite(left[i][j])) {
+                throw std::invalid_argument("Matrix has non-finite elements.");
+            }
+        }
+        right[i][i] = 1.0;
+    }
+    SquareMat* v = vectors ? &right : nullptr;
+    const double tolerance = n * std::numeric_limits<double>::epsilon();
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    const bool parallel = n >= PARALLEL_THRESHOLD && scheduler.getThreadCount() > 1;
+    // Round-robin tournament over an even number of players; a pair with the extra player of
+    // an odd size sits the round out.
+    const int players = n + (n % 2);
+    const int pairs = players / 2;
+    const int chunk = std::max(1, pairs / (4 * scheduler.getThreadCount()));
+    std::vector<double> norms(n);
+    bool rotated = true;
+    while (rotated) {
+        if (sweeps == JACOBI_MAX_SWEEPS) {
+            throw std::invalid_argument("Singular value iteration did not converge.");
+        }
+        ++sweeps;
+        rotated = false;
+        for (int i = 0; i < n; ++i) {
+            norms[i] = rowDot(left[i], left[i], n);
+        }
+        for (int round = 0; round < players - 1; ++round) {
+            std::vector<char> changed(pairs, 0);
+            auto body = [&, round](int begin, int end) {
+                for (int k = begin; k < end; ++k) {
+                    int p = k == 0 ? players - 1 : (round + k) % (players - 1);
+                    int q = (round - k + players - 1) % (players - 1);
+                    if (p > q) {
+                        std::swap(p, q);
+                    }
+                    if (q < n) {
+                        changed[k] = orthogonalizePair(left, v, norms, p, q, tolerance);
+                    }
+                }
+            };
+            if (parallel) {
+                TaskGraph graph;
+                for (int begin = 0; begin < pairs; begin += chunk) {
+                    const int end = std::min(pairs, begin + chunk);
+                    graph.addTask([&body, begin, end] { body(begin, end); });
+                }
+                graph.run(scheduler);
+            } else {
+                body(0, pairs);
+            }
+            for (int k = 0; k < pairs; ++k) {
+                rotated = rotated || changed[k];
+            }
+        }
+    }
+
+    // Singular values are the column norms; sort them in descending order with the vectors.
+    for (int i = 0; i < n; ++i) {
+        values[i] = std::sqrt(rowDot(left[i], left[i], n));
+    }
+    for (int i = 0; i < n - 1; ++i) {
+        int largest = i;
+        for (int j = i + 1; j < n; ++j) {
+            if (values[j] > values[largest]) {
+                largest = j;
+            }
+        }
+        if (largest != i) {
+            std::swap(values[i], values[largest]);
+            std::swap_ranges(left[i], left[i] + n, left[largest]);
+            std::swap_ranges(right[i], right[i] + n, right[largest]);
+        }
+    }
+    if (!vectors) {
+        return;
+    }
+    // u_i = A v_i / sigma_i; the vectors of zero singular values complete an orthonormal basis
+    // by Gram-Schmidt on the unit vectors.
+    int candidate = 0;
+    for (int i = 0; i < n; ++i) {
+        double* u = left[i];
+        if (values[i] > 0.0) {
+            for (int k = 0; k < n; ++k) {
+                u[k] /= values[i];
+            }
+            continue;
+        }
+        double norm = 0.0;
+        while (norm < 0.5) {
+            std::fill(u, u + n, 0.0);
+            u[candidate++] = 1.0;
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int j = 0; j < i; ++j) {
+                    const double projection = rowDot(left[j], u, n);
+                    for (int k = 0; k < n; ++k) {
+                        u[k] -= projection * left[j][k];
+                    }
+                }
+            }
+            norm = std::sqrt(rowDot(u, u, n));
+        }
+        for (int k = 0; k < n; ++k) {
+            u[k] /= norm;
+        }
+    }
+}
+
+// Private helper function to check that the vectors were computed.
+void SingularValueDecomposition::checkVectors() const {
+    if (!vectors) {
+        throw std::invalid_argument("Singular vectors were not computed.");
+    }
+}
+
+// Method to get the size
+int SingularValueDecomposition::getSize() const {
+    return size;
+}
+
+// Method to get the singular values
+const std::vector<double>& SingularValueDecomposition::getSingularValues() const {
+    return values;
+}
+
+// Method to get the left singular vectors as columns
+SquareMat SingularValueDecomposition::getU() const {
+    checkVectors();
+    return ~left;
+}
+
+// Method to get the right singular vectors as columns
+SquareMat SingularValueDecomposition::getV() const {
+    checkVectors();
+    return ~right;
+}
+
+// Method to get the number of sweeps
+int SingularValueDecomposition::getSweepCount() const {
+    return sweeps;
+}
+
+// Method to get the condition number
+double SingularValueDecomposition::getConditionNumber() const {
+    if (values.back() == 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return values.front() / values.back();
+}
+
+// Method to get the numerical rank
+int SingularValueDecomposition::getRank() const {
+    const double threshold = size * std::numeric_limits<double>::epsilon() * values.front();
+    int rank = 0;
+    while (rank < size && values[rank] > threshold) {
+        ++rank;
+    }
+    return rank;
+}
+
+// Computes the condition number without the singular vectors.
+double conditionNumber(const SquareMat& matrix) {
+    return SingularValueDecomposition(matrix, false).getConditionNumber();
+}
+
+} // namespace matrix
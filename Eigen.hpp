@@ -0,0 +1,161 @@
+#ifndef EIGEN_HPP
+#define EIGEN_HPP
+
+#include "SquareMat.hpp"
+#include "Vector.hpp"
+#include <vector>
+
+namespace matrix {
+
+/**
+ * @brief Whether the matrix equals its transpose exactly.
+ */
+bool isSymmetric(const SquareMat& matrix);
+
+/**
+ * @brief Eigendecomposition A = V diag(lambda) V^T of a symmetric matrix.
+ *
+ * Householder reduction to tridiagonal form, accumulating the reflectors into V, then the
+ * implicit QL iteration with Wilkinson shifts on the tridiagonal matrix, rotating V along
+ * (Wilkinson and Reinsch's tred2 and tql2). About 9 n^3 flops, whatever is done with the
+ * result afterwards: power() needs one more product for any exponent. The eigenvectors are
+ * kept as the rows of a matrix, so the reduction and every rotation of the QL sweeps run
+ * along contiguous rows. The rotations of several sweeps are buffered and applied to the
+ * eigenvectors one block of columns at a time, which stays in cache across the sweeps;
+ * for matrices of at least PARALLEL_THRESHOLD rows the blocks run on the TaskScheduler.
+ */
+class SymmetricEigen {
+private:
+    int size;
+    std::vector<double> values;  // Eigenvalues in ascending order.
+    SquareMat basis;             // Row i is the unit eigenvector of values[i].
+
+public:
+/**
+ * @brief Minimum size for which the eigenvector updates run in parallel.
+ */
+static const int PARALLEL_THRESHOLD = 256;
+
+/**
+ * @brief Constructor that decomposes the matrix. Throws std::invalid_argument if it is not
+ * symmetric, has non-finite elements or the QL iteration does not converge.
+ */
+explicit SymmetricEigen(const SquareMat& matrix);
+
+/**
+ * @brief Gets the size of the decomposed matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the eigenvalues in ascending order.
+ */
+const std::vector<double>& getEigenvalues() const;
+
+/**
+ * @brief Gets the matrix V whose column i is the eigenvector of eigenvalue i.
+ */
+SquareMat getEigenvectors() const;
+
+/**
+ * @brief Gets the unit eigenvector of eigenvalue index. Throws std::out_of_range.
+ */
+Vector getEigenvector(int index) const;
+
+/**
+ * @brief Calculates A^exponent = V diag(lambda^exponent) V^T with a single product, so the
+ * cost does not depend on the exponent. Throws std::invalid_argument for a negative exponent.
+ */
+SquareMat power(int exponent) const;
+
+/**
+ * @brief Calculates A^exponent into result, which must have the size of A and is
+ * overwritten. Throws std::invalid_argument for a negative exponent or another size.
+ */
+void power(int exponent, SquareMat& result) const;
+};
+
+/**
+ * @brief Singular value decomposition A = U diag(sigma) V^T.
+ *
+ * One-sided Jacobi (Hestenes): plane rotations applied to pairs of columns of A until all
+ * columns are orthogonal, to a relative tolerance of n * epsilon; the singular values are
+ * then the column norms, computed to high relative accuracy even when they are tiny. The
+ * columns are kept as rows, and each sweep visits the n (n - 1) / 2 pairs in n - 1 rounds of
+ * disjoint pairs (round-robin ordering), so the rotations of a round are independent and run
+ * in parallel on the TaskScheduler for matrices of at least PARALLEL_THRESHOLD rows. A
+ * sweep costs about 4 n^3 flops (7 n^3 with V); random matrices take 10 to 15 sweeps.
+ */
+class SingularValueDecomposition {
+private:
+    int size;
+    int sweeps;
+    bool vectors;
+    std::vector<double> values;  // Singular values in descending order.
+    SquareMat left;              // Row i is the left singular vector u_i.
+    SquareMat right;             // Row i is the right singular vector v_i.
+
+    /**
+     * @brief Throws std::invalid_argument if the singular vectors were not computed.
+     */
+    void checkVectors() const;
+
+public:
+/**
+ * @brief Minimum size for which the rotations of a round run in parallel.
+ */
+static const int PARALLEL_THRESHOLD = 256;
+
+/**
+ * @brief Constructor that decomposes the matrix. Without vectors, V is not accumulated and
+ * only the singular values are available. Throws std::invalid_argument if the matrix has
+ * non-finite elements or the iteration does not converge.
+ */
+explicit SingularValueDecomposition(const SquareMat& matrix, bool vectors = true);
+
+/**
+ * @brief Gets the size of the decomposed matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the singular values in descending order.
+ */
+const std::vector<double>& getSingularValues() const;
+
+/**
+ * @brief Gets U, whose columns are the left singular vectors. Throws std::invalid_argument
+ * if the vectors were not computed.
+ */
+SquareMat getU() const;
+
+/**
+ * @brief Gets V, whose columns are the right singular vectors. Throws std::invalid_argument
+ * if the vectors were not computed.
+ */
+SquareMat getV() const;
+
+/**
+ * @brief Gets the number of Jacobi sweeps done.
+ */
+int getSweepCount() const;
+
+/**
+ * @brief Gets the 2-norm condition number sigma_max / sigma_min, infinity if singular.
+ */
+double getConditionNumber() const;
+
+/**
+ * @brief Gets the number of singular values above n * epsilon * sigma_max.
+ */
+int getRank() const;
+};
+
+/**
+ * @brief Calculates the 2-norm condition number from the singular values alone.
+ */
+double conditionNumber(const SquareMat& matrix);
+
+} // namespace matrix
+
+#endif // EIGEN_HPP
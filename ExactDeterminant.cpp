@@ -0,0 +1,390 @@
+#include "ExactDeterminant.hpp"
+#include "ModMat.hpp"
+#include "TaskScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+
+// 128-bit arithmetic is a GCC/Clang extension; __extension__ keeps -pedantic quiet.
+__extension__ typedef __int128 Int128;
+__extension__ typedef unsigned __int128 UInt128;
+
+typedef std::vector<std::uint32_t> Digits;
+
+// Bareiss elimination on a copy of the matrix in the integer type Int. Unchecked, every
+// intermediate must be known to fit; checked, returns false as soon as one does not.
+template <typename Int>
+bool bareiss(const BasicSquareMat<std::int64_t>& matrix, bool checked, Int& det) {
+    const int n = matrix.getSize();
+    std::vector<Int> a(static_cast<size_t>(n) * n);
+    for (int i = 0; i < n; ++i) {
+        std::copy(matrix[i], matrix[i] + n, a.begin() + static_cast<size_t>(i) * n);
+    }
+    Int sign = 1;
+    Int previous = 1;
+    for (int k = 0; k < n - 1; ++k) {
+        Int* pivotRow = &a[static_cast<size_t>(k) * n];
+        if (pivotRow[k] == 0) {
+            int pivot = k + 1;
+            while (pivot < n && a[static_cast<size_t>(pivot) * n + k] == 0) {
+                ++pivot;
+            }
+            if (pivot == n) {
+                det = 0;
+                return true;
+            }
+            std::swap_ranges(pivotRow + k, pivotRow + n, &a[static_cast<size_t>(pivot) * n + k]);
+            sign = -sign;
+        }
+        for (int i = k + 1; i < n; ++i) {
+            Int* row = &a[static_cast<size_t>(i) * n];
+            for (int j = k + 1; j < n; ++j) {
+                if (checked) {
+                    Int x, y, difference;
+                    if (__builtin_mul_overflow(row[j], pivotRow[k], &x)
+                        || __builtin_mul_overflow(row[k], pivotRow[j], &y)
+                        || __builtin_sub_overflow(x, y, &difference)) {
+                        return false;
+                    }
+                    row[j] = difference / previous;
+                } else {
+                    row[j] = (row[j] * pivotRow[k] - row[k] * pivotRow[j]) / previous;
+                }
+            }
+        }
+        previous = pivotRow[k];
+    }
+    det = sign * a[static_cast<size_t>(n) * n - 1];
+    return true;
+}
+
+std::uint64_t mulMod(std::uint64_t x, std::uint64_t y, std::uint64_t modulus) {
+    return static_cast<std::uint64_t>(static_cast<UInt128>(x) * y % modulus);
+}
+
+std::uint64_t powMod(std::uint64_t base, std::uint64_t exponent, std::uint64_t modulus) {
+    std::uint64_t result = 1;
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result = mulMod(result, base, modulus);
+        }
+        base = mulMod(base, base, modulus);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+// Deterministic Miller-Rabin: these bases decide primality for every 64-bit odd n.
+bool isPrime(std::uint64_t n) {
+    const std::uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    std::uint64_t d = n - 1;
+    int twos = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        ++twos;
+    }
+    for (int b = 0; b < 12; ++b) {
+        std::uint64_t x = powMod(bases[b], d, n);
+        if (x == 1 || x == n - 1) {
+            continue;
+        }
+        bool composite = true;
+        for (int r = 1; r < twos && composite; ++r) {
+            x = mulMod(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// digits = digits * multiplier + addend.
+void mulAdd(Digits& digits, std::uint64_t multiplier, std::uint64_t addend) {
+    UInt128 carry = addend;
+    for (size_t i = 0; i < digits.size(); ++i) {
+        carry += static_cast<UInt128>(digits[i]) * multiplier;
+        digits[i] = static_cast<std::uint32_t>(carry);
+        carry >>= 32;
+    }
+    while (carry != 0) {
+        digits.push_back(static_cast<std::uint32_t>(carry));
+        carry >>= 32;
+    }
+}
+
+void trim(Digits& digits) {
+    while (!digits.empty() && digits.back() == 0) {
+        digits.pop_back();
+    }
+}
+
+// Compares two trimmed magnitudes: -1, 0 or 1.
+int compare(const Digits& a, const Digits& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// a - b for a >= b.
+Digits subtract(const Digits& a, const Digits& b) {
+    Digits result(a);
+    std::int64_t borrow = 0;
+    for (size_t i = 0; i < result.size(); ++i) {
+        std::int64_t value = static_cast<std::int64_t>(result[i]) - borrow - (i < b.size() ? b[i] : 0);
+        borrow = value < 0 ? 1 : 0;
+        result[i] = static_cast<std::uint32_t>(value + (borrow << 32));
+    }
+    trim(result);
+    return result;
+}
+
+Digits fromUnsigned(UInt128 value) {
+    Digits digits;
+    while (value != 0) {
+        digits.push_back(static_cast<std::uint32_t>(value));
+        value >>= 32;
+    }
+    return digits;
+}
+
+// The multi-modular determinant: residues modulo primes just below 2^62 whose product
+// exceeds 2 * 2^boundBits, lifted by Garner's mixed-radix form into the symmetric range.
+void multiModular(const BasicSquareMat<std::int64_t>& matrix, double boundBits, int& sign, Digits& magnitude,
+                  int& primeCount) {
+    std::vector<std::uint64_t> primes;
+    double bits = 0.0;
+    for (std::uint64_t candidate = (static_cast<std::uint64_t>(1) << 62) - 1; bits <= boundBits + 2.0; candidate -= 2) {
+        if (isPrime(candidate)) {
+            primes.push_back(candidate);
+            bits += std::log2(static_cast<double>(candidate));
+        }
+    }
+    const int count = static_cast<int>(primes.size());
+    std::vector<std::uint64_t> residues(count);
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    if (count > 1 && scheduler.getThreadCount() > 1) {
+        TaskGraph graph;
+        for (int i = 0; i < count; ++i) {
+            graph.addTask([&matrix, &primes, &residues, i] { residues[i] = !ModMat(matrix, primes[i]); });
+        }
+        graph.run(scheduler);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            residues[i] = !ModMat(matrix, primes[i]);
+        }
+    }
+
+    // x = v_0 + v_1 p_0 + v_2 p_0 p_1 + ..., each v_i in [0, p_i).
+    std::vector<std::uint64_t> mixed(count);
+    for (int i = 0; i < count; ++i) {
+        const std::uint64_t p = primes[i];
+        std::uint64_t value = 0;
+        std::uint64_t radix = 1;
+        for (int j = 0; j < i; ++j) {
+            value = (value + mulMod(mixed[j] % p, radix, p)) % p;
+            radix = mulMod(radix, primes[j] % p, p);
+        }
+        // radix^-1 = radix^(p-2) mod p.
+        const std::uint64_t difference = (residues[i] + p - value) % p;
+        mixed[i] = mulMod(difference, powMod(radix, p - 2, p), p);
+    }
+    // Horner from the last digit: x = ((v_(k-1) p_(k-2) + v_(k-2)) p_(k-3) + ...) p_0 + v_0.
+    Digits x(1, 0);
+    for (int i = count - 1; i >= 0; --i) {
+        mulAdd(x, primes[i], 0);
+        mulAdd(x, 1, mixed[i]);
+    }
+    trim(x);
+    Digits modulus(1, 1);
+    for (int i = 0; i < count; ++i) {
+        mulAdd(modulus, primes[i], 0);
+    }
+    trim(modulus);
+    Digits twice(x);
+    mulAdd(twice, 2, 0);
+    trim(twice);
+    primeCount = count;
+    if (x.empty()) {
+        sign = 0;
+        magnitude.clear();
+    } else if (compare(twice, modulus) > 0) {
+        sign = -1;
+        magnitude = subtract(modulus, x);
+    } else {
+        sign = 1;
+        magnitude = x;
+    }
+}
+
+} // namespace
+
+// Private constructor used by exactDeterminant().
+ExactDeterminant::ExactDeterminant(int sign, const std::vector<std::uint32_t>& magnitude, ExactMethod method,
+                                   int primeCount)
+    : sign(sign), magnitude(magnitude), method(method), primeCount(primeCount) {}
+
+// Method to get the sign
+int ExactDeterminant::getSign() const {
+    return sign;
+}
+
+// Method to get the method
+ExactMethod ExactDeterminant::getMethod() const {
+    return method;
+}
+
+// Method to get the number of primes
+int ExactDeterminant::getPrimeCount() const {
+    return primeCount;
+}
+
+// Method to get the number of bits of the magnitude
+int ExactDeterminant::getBitLength() const {
+    if (magnitude.empty()) {
+        return 0;
+    }
+    int bits = 32 * static_cast<int>(magnitude.size() - 1);
+    for (std::uint32_t top = magnitude.back(); top != 0; top >>= 1) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Method to check the range of std::int64_t, down to -2^63
+bool ExactDeterminant::fitsInt64() const {
+    const int bits = getBitLength();
+    return bits <= 63 || (bits == 64 && sign < 0 && magnitude[1] == 0x80000000u && magnitude[0] == 0);
+}
+
+// Method to convert to std::int64_t
+std::int64_t ExactDeterminant::toInt64() const {
+    if (!fitsInt64()) {
+        throw std::out_of_range("Determinant does not fit in 64 bits.");
+    }
+    std::uint64_t value = 0;
+    for (size_t i = magnitude.size(); i-- > 0;) {
+        value = (value << 32) | magnitude[i];
+    }
+    // Negate in unsigned arithmetic so that -2^63 does not overflow.
+    return static_cast<std::int64_t>(sign < 0 ? 0 - value : value);
+}
+
+// Method to convert to double
+double ExactDeterminant::toDouble() const {
+    double value = 0.0;
+    for (size_t i = magnitude.size(); i-- > 0;) {
+        value = value * 4294967296.0 + magnitude[i];
+    }
+    return sign < 0 ? -value : value;
+}
+
+// Method to get the decimal representation, nine digits per division.
+std::string ExactDeterminant::toString() const {
+    if (sign == 0) {
+        return "0";
+    }
+    Digits rest(magnitude);
+    std::vector<std::uint32_t> chunks;
+    while (!rest.empty()) {
+        std::uint64_t remainder = 0;
+        for (size_t i = rest.size(); i-- > 0;) {
+            const std::uint64_t current = (remainder << 32) | rest[i];
+            rest[i] = static_cast<std::uint32_t>(current / 1000000000u);
+            remainder = current % 1000000000u;
+        }
+        chunks.push_back(static_cast<std::uint32_t>(remainder));
+        trim(rest);
+    }
+    std::string result = sign < 0 ? "-" : "";
+    result += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        const std::string chunk = std::to_string(chunks[i]);
+        result += std::string(9 - chunk.size(), '0') + chunk;
+    }
+    return result;
+}
+
+// Overloads the equality operator (==).
+bool ExactDeterminant::operator==(const ExactDeterminant& other) const {
+    return sign == other.sign && magnitude == other.magnitude;
+}
+
+// Overloads the inequality operator (!=).
+bool ExactDeterminant::operator!=(const ExactDeterminant& other) const {
+    return !(*this == other);
+}
+
+// Overloads the output stream operator (<<).
+std::ostream& operator<<(std::ostream& os, const ExactDeterminant& det) {
+    return os << det.toString();
+}
+
+// Chooses the arithmetic from the Hadamard bound, falling back to the multi-modular method.
+ExactDeterminant exactDeterminant(const BasicSquareMat<std::int64_t>& matrix) {
+    const int n = matrix.getSize();
+    double boundBits = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double squares = 0.0;
+        for (int j = 0; j < n; ++j) {
+            const double value = static_cast<double>(matrix[i][j]);
+            squares += value * value;
+        }
+        if (squares == 0.0) {
+            return ExactDeterminant(0, Digits(), ExactMethod::Bareiss, 0);
+        }
+        boundBits += 0.5 * std::log2(squares);
+    }
+    // Margin for the rounding of the bound itself.
+    boundBits = boundBits * (1.0 + 1e-12) + 1e-6;
+
+    Int128 det = 0;
+    bool exact = true;
+    if (2.0 * boundBits + 1.0 < 62.0) {
+        std::int64_t narrow = 0;
+        bareiss(matrix, false, narrow);
+        det = narrow;
+    } else {
+        exact = bareiss(matrix, 2.0 * boundBits + 1.0 >= 126.0, det);
+    }
+    if (exact) {
+        const int sign = det > 0 ? 1 : det < 0 ? -1 : 0;
+        const UInt128 absolute = det < 0 ? 0 - static_cast<UInt128>(det) : static_cast<UInt128>(det);
+        return ExactDeterminant(sign, fromUnsigned(absolute), ExactMethod::Bareiss, 0);
+    }
+    int sign = 0;
+    Digits magnitude;
+    int primeCount = 0;
+    multiModular(matrix, boundBits, sign, magnitude, primeCount);
+    return ExactDeterminant(sign, magnitude, ExactMethod::MultiModular, primeCount);
+}
+
+// Converts the integer-valued elements and computes the exact determinant.
+ExactDeterminant exactDeterminant(const SquareMat& matrix) {
+    const int n = matrix.getSize();
+    BasicSquareMat<std::int64_t> integers(n);
+    for (int i = 0; i < n; ++i) {
+        const double* row = matrix[i];
+        std::int64_t* out = integers[i];
+        for (int j = 0; j < n; ++j) {
+            if (!(std::floor(row[j]) == row[j] && std::fabs(row[j]) < 9223372036854775808.0)) {
+                throw std::invalid_argument("Matrix elements must be integers below 2^63 in magnitude.");
+            }
+            out[j] = static_cast<std::int64_t>(row[j]);
+        }
+    }
+    return exactDeterminant(integers);
+}
+
+} // namespace matrix
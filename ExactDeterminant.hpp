@@ -0,0 +1,111 @@
+#ifndef EXACT_DETERMINANT_HPP
+#define EXACT_DETERMINANT_HPP
+
+#include "SquareMat.hpp"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace matrix {
+
+/**
+ * @brief How exactDeterminant() obtained its result.
+ */
+enum class ExactMethod {
+    Bareiss,      // Fraction-free elimination in 64-bit or 128-bit integers.
+    MultiModular  // Determinants modulo 62-bit primes, combined by the Chinese remainder theorem.
+};
+
+/**
+ * @brief An exact integer determinant of any magnitude, as a sign and base 2^32 digits.
+ */
+class ExactDeterminant {
+private:
+    int sign;                              // -1, 0 or 1.
+    std::vector<std::uint32_t> magnitude;  // Little-endian digits, without leading zeros.
+    ExactMethod method;
+    int primeCount;                        // Primes used by the multi-modular method, else 0.
+
+    ExactDeterminant(int sign, const std::vector<std::uint32_t>& magnitude, ExactMethod method, int primeCount);
+
+    friend ExactDeterminant exactDeterminant(const BasicSquareMat<std::int64_t>& matrix);
+
+public:
+/**
+ * @brief Gets the sign: -1, 0 or 1.
+ */
+int getSign() const;
+
+/**
+ * @brief Gets the method that computed the determinant.
+ */
+ExactMethod getMethod() const;
+
+/**
+ * @brief Gets the number of primes of the multi-modular method, 0 for Bareiss.
+ */
+int getPrimeCount() const;
+
+/**
+ * @brief Gets the number of bits of |det|, 0 for a zero determinant.
+ */
+int getBitLength() const;
+
+/**
+ * @brief Whether the determinant is representable as std::int64_t.
+ */
+bool fitsInt64() const;
+
+/**
+ * @brief Converts to std::int64_t. Throws std::out_of_range if it does not fit.
+ */
+std::int64_t toInt64() const;
+
+/**
+ * @brief Converts to double, to within a few ulps; infinite beyond its range.
+ */
+double toDouble() const;
+
+/**
+ * @brief Gets the decimal representation.
+ */
+std::string toString() const;
+
+/**
+ * @brief Overloads the equality operator (==): same value.
+ */
+bool operator==(const ExactDeterminant& other) const;
+
+/**
+ * @brief Overloads the inequality operator (!=).
+ */
+bool operator!=(const ExactDeterminant& other) const;
+};
+
+/**
+ * @brief Overloads the output stream operator (<<) to print the decimal value.
+ */
+std::ostream& operator<<(std::ostream& os, const ExactDeterminant& det);
+
+/**
+ * @brief Calculates the determinant of an integer matrix exactly, in O(n^3).
+ *
+ * The Hadamard bound H = prod ||row_i||_2 bounds every minor, so it picks the arithmetic of
+ * the fraction-free Bareiss elimination: 64-bit integers while 2 H^2 < 2^63, 128-bit ones
+ * while 2 H^2 < 2^127, and beyond, 128-bit ones with every product and difference checked
+ * for overflow (the bound is usually pessimistic). On overflow the determinant is computed
+ * modulo enough 62-bit primes for their product to exceed 2 H (ModMat's operator!, one task
+ * per prime on the TaskScheduler) and reconstructed with Garner's algorithm.
+ */
+ExactDeterminant exactDeterminant(const BasicSquareMat<std::int64_t>& matrix);
+
+/**
+ * @brief Calculates the determinant of an integer-valued double matrix exactly. Throws
+ * std::invalid_argument unless every element is an integer of magnitude below 2^63.
+ */
+ExactDeterminant exactDeterminant(const SquareMat& matrix);
+
+} // namespace matrix
+
+#endif // EXACT_DETERMINANT_HPP
@@ -0,0 +1,338 @@
+#include "Lazy.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+namespace matrix {
+
+namespace {
+
+// The n x n buffers of one evaluation: taken from the free list when possible, all freed
+// with the pool.
+class BufferPool {
+private:
+    int size;
+    std::vector<SquareMat*> buffers;
+    std::vector<SquareMat*> available;
+
+    BufferPool(const BufferPool&);
+    BufferPool& operator=(const BufferPool&);
+
+public:
+    explicit BufferPool(int size) : size(size) {}
+
+    ~BufferPool() {
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            delete buffers[i];
+        }
+    }
+
+    SquareMat* acquire() {
+        if (available.empty()) {
+            buffers.push_back(nullptr);
+            buffers.back() = new SquareMat(size);
+            return buffers.back();
+        }
+        SquareMat* buffer = available.back();
+        available.pop_back();
+        return buffer;
+    }
+
+    void release(SquareMat* buffer) {
+        available.push_back(buffer);
+    }
+
+    int getCount() const {
+        return static_cast<int>(buffers.size());
+    }
+};
+
+// Computes one node into out, which is distinct from the operands.
+void compute(LazyOp op, const SquareMat& a, const SquareMat* b, double scalar, int exponent, SquareMat& out) {
+    const int n = a.getSize();
+    switch (op) {
+    case LazyOp::Multiply:
+        gemm(1.0, a, *b, 0.0, out);
+        return;
+    case LazyOp::Divide:
+        out = a / scalar;
+        return;
+    case LazyOp::Modulo:
+        out = a % scalar;
+        return;
+    case LazyOp::Power:
+        out = a ^ exponent;
+        return;
+    case LazyOp::Transpose:
+        for (int i = 0; i < n; ++i) {
+            double* row = out[i];
+            for (int j = 0; j < n; ++j) {
+                row[j] = a[j][i];
+            }
+        }
+        return;
+    default:
+        break;
+    }
+    // Element-wise operations.
+    for (int i = 0; i < n; ++i) {
+        const double* x = a[i];
+        const double* y = b ? (*b)[i] : nullptr;
+        double* row = out[i];
+        switch (op) {
+        case LazyOp::Add:
+            for (int j = 0; j < n; ++j) {
+                row[j] = x[j] + y[j];
+            }
+            break;
+        case LazyOp::Subtract:
+            for (int j = 0; j < n; ++j) {
+                row[j] = x[j] - y[j];
+            }
+            break;
+        case LazyOp::Negate:
+            for (int j = 0; j < n; ++j) {
+                row[j] = -x[j];
+            }
+            break;
+        case LazyOp::Hadamard:
+            for (int j = 0; j < n; ++j) {
+                row[j] = x[j] * y[j];
+            }
+            break;
+        case LazyOp::Scale:
+            for (int j = 0; j < n; ++j) {
+                row[j] = x[j] * scalar;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace
+
+// Private constructor of a handle.
+LazyMat::LazyMat(LazyGraph* graph, int node) : graph(graph), node(node) {}
+
+// Private helper function to get the node of an operand, which must be in the same graph.
+int LazyMat::operand(const LazyMat& other) const {
+    if (other.graph != graph) {
+        throw std::invalid_argument("Lazy matrices must belong to the same graph.");
+    }
+    return other.node;
+}
+
+// Method to get the node identifier
+int LazyMat::getNode() const {
+    return node;
+}
+
+// Method to get the graph
+LazyGraph& LazyMat::getGraph() const {
+    return *graph;
+}
+
+// Overloads the addition operator (+).
+LazyMat LazyMat::operator+(const LazyMat& other) const {
+    return graph->makeNode(LazyOp::Add, node, operand(other), 0.0, 0);
+}
+
+// Overloads the subtraction operator (-).
+LazyMat LazyMat::operator-(const LazyMat& other) const {
+    return graph->makeNode(LazyOp::Subtract, node, operand(other), 0.0, 0);
+}
+
+// Overloads the unary minus operator (-).
+LazyMat LazyMat::operator-() const {
+    return graph->makeNode(LazyOp::Negate, node, -1, 0.0, 0);
+}
+
+// Overloads the multiplication operator (*).
+LazyMat LazyMat::operator*(const LazyMat& other) const {
+    return graph->makeNode(LazyOp::Multiply, node, operand(other), 0.0, 0);
+}
+
+// Overloads the multiplication operator (*) for scalar multiplication.
+LazyMat LazyMat::operator*(double scalar) const {
+    return graph->makeNode(LazyOp::Scale, node, -1, scalar, 0);
+}
+
+// Overloads the modulo operator (%) for element-wise multiplication.
+LazyMat LazyMat::operator%(const LazyMat& other) const {
+    return graph->makeNode(LazyOp::Hadamard, node, operand(other), 0.0, 0);
+}
+
+// Overloads the modulo operator (%) for a scalar.
+LazyMat LazyMat::operator%(double scalar) const {
+    if (scalar == 0.0) {
+        throw std::invalid_argument("Cannot perform modulo with a scalar of zero.");
+    }
+    return graph->makeNode(LazyOp::Modulo, node, -1, scalar, 0);
+}
+
+// Overloads the division operator (/) for a scalar.
+LazyMat LazyMat::operator/(double scalar) const {
+    if (scalar == 0.0) {
+        throw std::invalid_argument("Cannot divide by a scalar of zero.");
+    }
+    return graph->makeNode(LazyOp::Divide, node, -1, scalar, 0);
+}
+
+// Overloads the power operator (^).
+LazyMat LazyMat::operator^(int exponent) const {
+    return graph->makeNode(LazyOp::Power, node, -1, 0.0, exponent);
+}
+
+// Overloads the bitwise NOT operator (~) for transpose.
+LazyMat LazyMat::operator~() const {
+    return graph->makeNode(LazyOp::Transpose, node, -1, 0.0, 0);
+}
+
+// Overloads the multiplication operator (*) for scalar multiplication (scalar * matrix).
+LazyMat operator*(double scalar, const LazyMat& matrix) {
+    return matrix * scalar;
+}
+
+// Orders the keys of the deduplication map.
+bool LazyGraph::Key::operator<(const Key& other) const {
+    return std::tie(op, left, right, scalar, exponent)
+        < std::tie(other.op, other.left, other.right, other.scalar, other.exponent);
+}
+
+// Constructor that creates an empty graph.
+LazyGraph::LazyGraph() : size(0), requested(0), evaluated(0), buffersUsed(0) {}
+
+// Adds a leaf, once per matrix.
+LazyMat LazyGraph::input(const SquareMat& matrix) {
+    std::map<const SquareMat*, int>::const_iterator found = inputs.find(&matrix);
+    if (found != inputs.end()) {
+        return LazyMat(this, found->second);
+    }
+    if (!nodes.empty() && matrix.getSize() != size) {
+        throw std::invalid_argument("Matrices must have the same size.");
+    }
+    size = matrix.getSize();
+    Node node = {LazyOp::Input, -1, -1, 0.0, 0, &matrix};
+    nodes.push_back(node);
+    const int id = static_cast<int>(nodes.size()) - 1;
+    inputs[&matrix] = id;
+    return LazyMat(this, id);
+}
+
+// Private helper function to look up or create a node.
+LazyMat LazyGraph::makeNode(LazyOp op, int left, int right, double scalar, int exponent) {
+    ++requested;
+    if ((op == LazyOp::Add || op == LazyOp::Hadamard) && right < left) {
+        std::swap(left, right);
+    }
+    Key key = {static_cast<int>(op), left, right, 0, exponent};
+    std::memcpy(&key.scalar, &scalar, sizeof(scalar));
+    std::map<Key, int>::const_iterator found = index.find(key);
+    if (found != index.end()) {
+        return LazyMat(this, found->second);
+    }
+    Node node = {op, left, right, scalar, exponent, nullptr};
+    nodes.push_back(node);
+    const int id = static_cast<int>(nodes.size()) - 1;
+    index[key] = id;
+    return LazyMat(this, id);
+}
+
+// Method to get the number of nodes
+int LazyGraph::getNodeCount() const {
+    return static_cast<int>(nodes.size());
+}
+
+// Method to get the number of operators applied
+int LazyGraph::getRequestedCount() const {
+    return requested;
+}
+
+// Method to get the number of operations of the last evaluation
+int LazyGraph::getEvaluatedCount() const {
+    return evaluated;
+}
+
+// Method to get the number of buffers of the last evaluation
+int LazyGraph::getBufferCount() const {
+    return buffersUsed;
+}
+
+// Computes one expression.
+SquareMat LazyGraph::evaluate(const LazyMat& root) {
+    return evaluate(std::vector<LazyMat>(1, root)).front();
+}
+
+// Computes several expressions: prunes the nodes they do not depend on, finds the last use
+// of every node and recycles its buffer right after it.
+std::vector<SquareMat> LazyGraph::evaluate(const std::vector<LazyMat>& roots) {
+    const int count = getNodeCount();
+    std::vector<char> live(count, 0);
+    std::vector<char> kept(count, 0);
+    for (size_t r = 0; r < roots.size(); ++r) {
+        if (roots[r].graph != this) {
+            throw std::invalid_argument("Lazy matrices must belong to the same graph.");
+        }
+        live[roots[r].node] = 1;
+        kept[roots[r].node] = 1;
+    }
+    // Operands are always created before their users, so one backward pass marks them.
+    for (int v = count - 1; v >= 0; --v) {
+        if (live[v] && nodes[v].op != LazyOp::Input) {
+            live[nodes[v].left] = 1;
+            if (nodes[v].right >= 0) {
+                live[nodes[v].right] = 1;
+            }
+        }
+    }
+    std::vector<int> lastUse(count, -1);
+    for (int v = 0; v < count; ++v) {
+        if (live[v] && nodes[v].op != LazyOp::Input) {
+            lastUse[nodes[v].left] = v;
+            if (nodes[v].right >= 0) {
+                lastUse[nodes[v].right] = v;
+            }
+        }
+    }
+
+    BufferPool pool(size);
+    std::vector<const SquareMat*> values(count, nullptr);
+    std::vector<SquareMat*> owned(count, nullptr);
+    evaluated = 0;
+    for (int v = 0; v < count; ++v) {
+        if (!live[v]) {
+            continue;
+        }
+        const Node& node = nodes[v];
+        if (node.op == LazyOp::Input) {
+            values[v] = node.input;
+            continue;
+        }
+        SquareMat* out = pool.acquire();
+        compute(node.op, *values[node.left], node.right >= 0 ? values[node.right] : nullptr,
+                node.scalar, node.exponent, *out);
+        values[v] = out;
+        owned[v] = out;
+        ++evaluated;
+        const int operands[2] = {node.left, node.right};
+        for (int o = 0; o < 2; ++o) {
+            const int operand = operands[o];
+            if (operand >= 0 && owned[operand] && lastUse[operand] == v && !kept[operand]) {
+                pool.release(owned[operand]);
+                owned[operand] = nullptr;
+            }
+        }
+    }
+    buffersUsed = pool.getCount();
+
+    std::vector<SquareMat> results;
+    for (size_t r = 0; r < roots.size(); ++r) {
+        results.push_back(*values[roots[r].node]);
+    }
+    return results;
+}
+
+} // namespace matrix
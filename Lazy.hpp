@@ -0,0 +1,214 @@
+#ifndef LAZY_HPP
+#define LAZY_HPP
+
+#include "SquareMat.hpp"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace matrix {
+
+class LazyGraph;
+
+/**
+ * @brief The operation of a node of a LazyGraph.
+ */
+enum class LazyOp {
+    Input,     // A SquareMat given to LazyGraph::input().
+    Add,       // left + right
+    Subtract,  // left - right
+    Negate,    // -left
+    Multiply,  // left * right
+    Hadamard,  // left % right (element-wise product)
+    Scale,     // left * scalar
+    Divide,    // left / scalar
+    Modulo,    // left % scalar
+    Power,     // left ^ exponent
+    Transpose  // ~left
+};
+
+/**
+ * @brief A handle to a node of a LazyGraph. The operators mirror those of SquareMat but
+ * only add nodes to the graph; nothing is computed until LazyGraph::evaluate().
+ */
+class LazyMat {
+private:
+    LazyGraph* graph;
+    int node;
+
+    LazyMat(LazyGraph* graph, int node);
+
+    /**
+     * @brief Gets the node of another operand, throwing if it belongs to another graph.
+     */
+    int operand(const LazyMat& other) const;
+
+    friend class LazyGraph;
+
+public:
+/**
+ * @brief Gets the identifier of the node in its graph. Identical expressions share it.
+ */
+int getNode() const;
+
+/**
+ * @brief Gets the graph of the node.
+ */
+LazyGraph& getGraph() const;
+
+/**
+ * @brief Adds a node for the matrix addition.
+ */
+LazyMat operator+(const LazyMat& other) const;
+
+/**
+ * @brief Adds a node for the matrix subtraction.
+ */
+LazyMat operator-(const LazyMat& other) const;
+
+/**
+ * @brief Adds a node for the unary minus.
+ */
+LazyMat operator-() const;
+
+/**
+ * @brief Adds a node for the matrix multiplication.
+ */
+LazyMat operator*(const LazyMat& other) const;
+
+/**
+ * @brief Adds a node for the scalar multiplication.
+ */
+LazyMat operator*(double scalar) const;
+
+/**
+ * @brief Adds a node for the element-wise multiplication.
+ */
+LazyMat operator%(const LazyMat& other) const;
+
+/**
+ * @brief Adds a node for the modulo by a scalar. Throws std::invalid_argument for zero.
+ */
+LazyMat operator%(double scalar) const;
+
+/**
+ * @brief Adds a node for the division by a scalar. Throws std::invalid_argument for zero.
+ */
+LazyMat operator/(double scalar) const;
+
+/**
+ * @brief Adds a node for the power.
+ */
+LazyMat operator^(int exponent) const;
+
+/**
+ * @brief Adds a node for the transpose.
+ */
+LazyMat operator~() const;
+};
+
+/**
+ * @brief Adds a node for the scalar multiplication (scalar * matrix).
+ */
+LazyMat operator*(double scalar, const LazyMat& matrix);
+
+/**
+ * @brief An expression DAG of matrix operations, the opt-in lazy mode of SquareMat.
+ *
+ * Wrapping the inputs with input() makes the usual operators build nodes instead of
+ * computing. Nodes are deduplicated: an operator applied to the same operands (and scalar or
+ * exponent) returns the existing node, with the operands of + and element-wise % sorted, so
+ * (A * B) + (A * B) % C computes A * B once and every ~A is one transpose. evaluate()
+ * computes only the nodes the requested results depend on, in creation order (a topological
+ * order), and takes the buffer of every intermediate back into a pool right after its last
+ * use, so the number of n x n buffers follows the widest point of the DAG, not its size.
+ *
+ * The graph stores pointers to the inputs: they must outlive it and stay unchanged until
+ * evaluate().
+ */
+class LazyGraph {
+private:
+    struct Node {
+        LazyOp op;
+        int left;
+        int right;
+        double scalar;
+        int exponent;
+        const SquareMat* input;
+    };
+
+    // Identity of a node for the deduplication: op, operands, scalar bits and exponent.
+    struct Key {
+        int op;
+        int left;
+        int right;
+        std::uint64_t scalar;
+        int exponent;
+
+        bool operator<(const Key& other) const;
+    };
+
+    std::vector<Node> nodes;
+    std::map<Key, int> index;
+    std::map<const SquareMat*, int> inputs;
+    int size;
+    int requested;
+    int evaluated;
+    int buffersUsed;
+
+    LazyGraph(const LazyGraph&);
+    LazyGraph& operator=(const LazyGraph&);
+
+    /**
+     * @brief Returns the node for the operation, creating it if it does not exist yet.
+     */
+    LazyMat makeNode(LazyOp op, int left, int right, double scalar, int exponent);
+
+    friend class LazyMat;
+
+public:
+/**
+ * @brief Constructor that creates an empty graph.
+ */
+LazyGraph();
+
+/**
+ * @brief Adds a leaf for the matrix (the same matrix always gives the same leaf).
+ * Throws std::invalid_argument if its size differs from the other inputs.
+ */
+LazyMat input(const SquareMat& matrix);
+
+/**
+ * @brief Gets the number of distinct nodes, inputs included.
+ */
+int getNodeCount() const;
+
+/**
+ * @brief Gets the number of operators applied, before deduplication.
+ */
+int getRequestedCount() const;
+
+/**
+ * @brief Gets the number of operations computed by the last evaluate().
+ */
+int getEvaluatedCount() const;
+
+/**
+ * @brief Gets the number of n x n buffers used by the last evaluate().
+ */
+int getBufferCount() const;
+
+/**
+ * @brief Computes one expression.
+ */
+SquareMat evaluate(const LazyMat& root);
+
+/**
+ * @brief Computes several expressions together, sharing their common sub-expressions.
+ */
+std::vector<SquareMat> evaluate(const std::vector<LazyMat>& roots);
+};
+
+} // namespace matrix
+
+#endif // LAZY_HPP
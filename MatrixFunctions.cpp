@@ -0,0 +1,264 @@
+#include "MatrixFunctions.hpp"
+#include "Decomposition.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace matrix {
+
+namespace {
+
+// Largest ||A||_1 for which the Padé approximant of degree 3, 5, 7, 9 and 13 is accurate
+// to double precision (Higham, 2005, table 2.3).
+const int PADE_DEGREES[] = {3, 5, 7, 9, 13};
+const double PADE_THETA[] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                             2.097847961257068e0, 5.371920351148152e0};
+
+// Coefficients b_0 ... b_m of the Padé approximants.
+const double PADE3[] = {120.0, 60.0, 12.0, 1.0};
+const double PADE5[] = {30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0};
+const double PADE7[] = {17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0};
+const double PADE9[] = {17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0,
+                        2162160.0, 110880.0, 3960.0, 90.0, 1.0};
+const double PADE13[] = {64764752532480000.0, 32382376266240000.0, 7771770303897600.0,
+                         1187353796428800.0, 129060195264000.0, 10559470521600.0, 670442572800.0,
+                         33522128640.0, 1323241920.0, 40840800.0, 960960.0, 16380.0, 182.0, 1.0};
+
+// Gauss-Legendre nodes and weights on [0, 1] for log(I + R) = integral of R (I + t R)^-1.
+const int LOG_NODES = 7;
+const double LOG_NODE[] = {0.5 - 0.47455395617137924, 0.5 - 0.37076559279969723, 0.5 - 0.2029225756886986,
+                           0.5, 0.5 + 0.2029225756886986, 0.5 + 0.37076559279969723, 0.5 + 0.47455395617137924};
+const double LOG_WEIGHT[] = {0.06474248308443484, 0.13985269574463835, 0.19091502525255952, 0.2089795918367347,
+                             0.19091502525255952, 0.13985269574463835, 0.06474248308443484};
+
+// ||A - I||_1 at most this before the Padé logarithm.
+const double LOG_RADIUS = 0.25;
+
+const int SQRT_MAX_ITERATIONS = 100;
+const int LOG_MAX_ROOTS = 64;
+
+// Maximum column sum of absolute values.
+double norm1(const SquareMat& matrix) {
+    const int n = matrix.getSize();
+    std::vector<double> sums(n, 0.0);
+    for (int i = 0; i < n; ++i) {
+        const double* row = matrix[i];
+        for (int j = 0; j < n; ++j) {
+            sums[j] += std::fabs(row[j]);
+        }
+    }
+    double largest = 0.0;
+    for (int j = 0; j < n; ++j) {
+        largest = std::max(largest, sums[j]);
+    }
+    return largest;
+}
+
+// target += scale * matrix.
+void addScaled(SquareMat& target, double scale, const SquareMat& matrix) {
+    const int n = target.getSize();
+    for (int i = 0; i < n; ++i) {
+        double* out = target[i];
+        const double* in = matrix[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] += scale * in[j];
+        }
+    }
+}
+
+// target += scale * I.
+void addIdentity(SquareMat& target, double scale) {
+    for (int i = 0; i < target.getSize(); ++i) {
+        target[i][i] += scale;
+    }
+}
+
+// Returns left * right, counting the product.
+SquareMat product(const SquareMat& left, const SquareMat& right, FunctionCost& cost) {
+    SquareMat result(left.getSize());
+    gemm(1.0, left, right, 0.0, result);
+    ++cost.products;
+    return result;
+}
+
+// Computes the numerator terms U (odd) and V (even) of the Padé approximant of degree m.
+void padeTerms(const SquareMat& a, int m, SquareMat& u, SquareMat& v, FunctionCost& cost) {
+    const int n = a.getSize();
+    SquareMat a2 = product(a, a, cost);
+    SquareMat odd(n);
+    if (m == 13) {
+        const double* b = PADE13;
+        SquareMat a4 = product(a2, a2, cost);
+        SquareMat a6 = product(a4, a2, cost);
+        // U = A [A6 (b13 A6 + b11 A4 + b9 A2) + b7 A6 + b5 A4 + b3 A2 + b1 I]
+        SquareMat inner(n);
+        addScaled(inner, b[13], a6);
+        addScaled(inner, b[11], a4);
+        addScaled(inner, b[9], a2);
+        odd = product(a6, inner, cost);
+        addScaled(odd, b[7], a6);
+        addScaled(odd, b[5], a4);
+        addScaled(odd, b[3], a2);
+        addIdentity(odd, b[1]);
+        // V = A6 (b12 A6 + b10 A4 + b8 A2) + b6 A6 + b4 A4 + b2 A2 + b0 I
+        SquareMat evenInner(n);
+        addScaled(evenInner, b[12], a6);
+        addScaled(evenInner, b[10], a4);
+        addScaled(evenInner, b[8], a2);
+        v = product(a6, evenInner, cost);
+        addScaled(v, b[6], a6);
+        addScaled(v, b[4], a4);
+        addScaled(v, b[2], a2);
+        addIdentity(v, b[0]);
+    } else {
+        const double* b = m == 3 ? PADE3 : m == 5 ? PADE5 : m == 7 ? PADE7 : PADE9;
+        // Powers A^2, A^4, ..., A^(m-1); U = A sum b_(2k+1) A^2k, V = sum b_2k A^2k.
+        v = SquareMat(n);
+        addIdentity(odd, b[1]);
+        addIdentity(v, b[0]);
+        SquareMat power = a2;
+        for (int k = 2; k < m; k += 2) {
+            if (k > 2) {
+                power = product(power, a2, cost);
+            }
+            addScaled(odd, b[k + 1], power);
+            addScaled(v, b[k], power);
+        }
+    }
+    u = product(a, odd, cost);
+}
+
+} // namespace
+
+// Computes the exponential by scaling and squaring.
+SquareMat expm(const SquareMat& matrix, FunctionCost* cost) {
+    FunctionCost local = {0, 0, 0};
+    const int n = matrix.getSize();
+    const double norm = norm1(matrix);
+    if (!std::isfinite(norm)) {
+        throw std::invalid_argument("Matrix has non-finite elements.");
+    }
+    int degree = 13;
+    int squarings = 0;
+    for (int d = 0; d < 4; ++d) {
+        if (norm <= PADE_THETA[d]) {
+            degree = PADE_DEGREES[d];
+            break;
+        }
+    }
+    SquareMat a(matrix);
+    if (degree == 13 && norm > PADE_THETA[4]) {
+        squarings = static_cast<int>(std::ceil(std::log2(norm / PADE_THETA[4])));
+        a = a * std::ldexp(1.0, -squarings);
+    }
+    SquareMat u(n), v(n);
+    padeTerms(a, degree, u, v, local);
+    // r = (V - U)^-1 (V + U)
+    SquareMat denominator = v - u;
+    LUDecomposition lu(denominator);
+    ++local.solves;
+    SquareMat result = lu.solve(v + u);
+    for (int s = 0; s < squarings; ++s) {
+        result = product(result, result, local);
+    }
+    local.squarings = squarings;
+    if (cost) {
+        *cost = local;
+    }
+    return result;
+}
+
+// Computes the principal square root with the scaled product Denman-Beavers iteration:
+// M_0 = Y_0 = A, M_(k+1) = (I + (mu^2 M + mu^-2 M^-1) / 2) / 2, Y_(k+1) = mu Y (I + mu^-2 M^-1) / 2,
+// with mu = |det M|^(-1/2n) while M is far from I. M tends to I and Y to A^(1/2).
+SquareMat sqrtm(const SquareMat& matrix, FunctionCost* cost) {
+    FunctionCost local = {0, 0, 0};
+    const int n = matrix.getSize();
+    const double tolerance = std::sqrt(static_cast<double>(n)) * std::numeric_limits<double>::epsilon();
+    SquareMat m(matrix);
+    SquareMat y(matrix);
+    bool scaling = true;
+    double previous = std::numeric_limits<double>::infinity();
+    for (int iteration = 0; iteration < SQRT_MAX_ITERATIONS; ++iteration) {
+        LUDecomposition lu(m);
+        ++local.solves;
+        if (lu.isSingular()) {
+            throw std::invalid_argument("Matrix is singular; no principal square root computed.");
+        }
+        SquareMat inverse = lu.inverse();
+        double mu = 1.0;
+        if (scaling) {
+            mu = std::exp(-lu.logDeterminant().logAbs / (2.0 * n));
+        }
+        const double mu2 = mu * mu;
+        // Y <- mu / 2 * Y * (I + mu^-2 M^-1)
+        SquareMat factor(inverse);
+        factor = factor * (1.0 / mu2);
+        addIdentity(factor, 1.0);
+        y = product(y, factor, local) * (0.5 * mu);
+        // M <- (I + (mu^2 M + mu^-2 M^-1) / 2) / 2
+        SquareMat next = m * (0.25 * mu2);
+        addScaled(next, 0.25 / mu2, inverse);
+        addIdentity(next, 0.5);
+        m = next;
+
+        SquareMat distance(m);
+        addIdentity(distance, -1.0);
+        const double error = norm1(distance);
+        if (!std::isfinite(error)) {
+            break;
+        }
+        if (error <= tolerance || (error < 1e-8 && error > 0.5 * previous)) {
+            if (cost) {
+                *cost = local;
+            }
+            return y;
+        }
+        if (error < 1e-2) {
+            scaling = false;
+        }
+        previous = error;
+    }
+    throw std::invalid_argument("Square root iteration did not converge; the matrix may have "
+                                "eigenvalues on the closed negative real axis.");
+}
+
+// Computes the principal logarithm by inverse scaling and squaring.
+SquareMat logm(const SquareMat& matrix, FunctionCost* cost) {
+    FunctionCost local = {0, 0, 0};
+    const int n = matrix.getSize();
+    SquareMat x(matrix);
+    SquareMat r(x);
+    addIdentity(r, -1.0);
+    int roots = 0;
+    while (norm1(r) > LOG_RADIUS) {
+        if (roots == LOG_MAX_ROOTS) {
+            throw std::invalid_argument("Matrix logarithm did not converge.");
+        }
+        FunctionCost rootCost = {0, 0, 0};
+        x = sqrtm(x, &rootCost);
+        local.products += rootCost.products;
+        local.solves += rootCost.solves;
+        ++roots;
+        r = x;
+        addIdentity(r, -1.0);
+    }
+    // log(I + R) ~ sum w_j (I + t_j R)^-1 R, the Padé approximant of degree LOG_NODES.
+    SquareMat result(n);
+    for (int j = 0; j < LOG_NODES; ++j) {
+        SquareMat shifted = r * LOG_NODE[j];
+        addIdentity(shifted, 1.0);
+        LUDecomposition lu(shifted);
+        ++local.solves;
+        addScaled(result, LOG_WEIGHT[j], lu.solve(r));
+    }
+    local.squarings = roots;
+    if (cost) {
+        *cost = local;
+    }
+    return result * std::ldexp(1.0, roots);
+}
+
+} // namespace matrix
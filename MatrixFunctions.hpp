@@ -0,0 +1,52 @@
+#ifndef MATRIX_FUNCTIONS_HPP
+#define MATRIX_FUNCTIONS_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * @brief Work done by a matrix function, for comparing algorithms.
+ */
+struct FunctionCost {
+    int products;   // n x n matrix products.
+    int solves;     // LU factorizations, each followed by a solve or an inverse.
+    int squarings;  // Squarings (expm) or square roots (logm) of the scaling phase.
+};
+
+/**
+ * @brief Calculates the matrix exponential e^A.
+ *
+ * Scaling and squaring with Padé approximants (Higham, 2005): the smallest degree m in
+ * {3, 5, 7, 9, 13} whose bound on ||A||_1 guarantees double accuracy is used directly;
+ * beyond, A is scaled by 2^-s to meet the degree 13 bound and the result squared s times.
+ * The approximant costs 2 to 6 products and one LU solve, where a Taylor series needs
+ * about 20 terms for ||A|| = 1. cost, if given, receives the work done.
+ */
+SquareMat expm(const SquareMat& matrix, FunctionCost* cost = nullptr);
+
+/**
+ * @brief Calculates the principal square root, the X with X * X = A whose eigenvalues have
+ * positive real parts.
+ *
+ * Scaled product form of the Denman-Beavers iteration: one inverse and one product per
+ * step, quadratic convergence. Throws std::invalid_argument if A is singular or the
+ * iteration does not converge (A has eigenvalues on the closed negative real axis, so no
+ * real principal square root).
+ */
+SquareMat sqrtm(const SquareMat& matrix, FunctionCost* cost = nullptr);
+
+/**
+ * @brief Calculates the principal logarithm, the inverse of expm() for eigenvalues with
+ * imaginary parts in (-pi, pi).
+ *
+ * Inverse scaling and squaring: square roots are taken until ||A^(1/2^s) - I||_1 <= 0.25,
+ * then log(I + R) is evaluated as the degree 7 Padé approximant in partial fractions (one
+ * LU solve per Gauss-Legendre node) and multiplied by 2^s. Throws std::invalid_argument
+ * for the matrices sqrtm() rejects.
+ */
+SquareMat logm(const SquareMat& matrix, FunctionCost* cost = nullptr);
+
+} // namespace matrix
+
+#endif // MATRIX_FUNCTIONS_HPP
@@ -0,0 +1,177 @@
+#include "Memory.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace matrix {
+
+namespace {
+
+// Rounds up to whole huge pages, so that the last page of a buffer can be huge too.
+std::size_t mappedSize(std::size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+// mbind modes of <linux/mempolicy.h>.
+const int MPOL_BIND_MODE = 2;
+const int MPOL_INTERLEAVE_MODE = 3;
+
+// Nodes a policy mask can name.
+const int MAX_NODES = 1024;
+
+} // namespace
+
+// Maps huge pages, trying hugetlbfs, then transparent huge pages.
+void* allocatePages(std::size_t bytes, PageBacking preferred, PageBacking& obtained) {
+    obtained = PageBacking::Regular;
+#ifdef __linux__
+    if (preferred == PageBacking::Regular || preferred == PageBacking::Mapped || bytes == 0) {
+        return nullptr;
+    }
+    const std::size_t length = mappedSize(bytes);
+#ifdef MAP_HUGETLB
+    if (preferred == PageBacking::ExplicitHuge) {
+        void* buffer = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                            -1, 0);
+        if (buffer != MAP_FAILED) {
+            obtained = PageBacking::ExplicitHuge;
+            return buffer;
+        }
+    }
+#endif
+#ifdef MADV_HUGEPAGE
+    // Map one huge page more than needed and trim both ends to a huge page boundary:
+    // the kernel only uses huge pages for aligned 2 MiB ranges.
+    void* raw = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (address + HUGE_PAGE_SIZE - 1) & ~(static_cast<std::uintptr_t>(HUGE_PAGE_SIZE) - 1);
+    const std::size_t head = aligned - address;
+    char* buffer = static_cast<char*>(raw) + head;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (head < HUGE_PAGE_SIZE) {
+        munmap(buffer + length, HUGE_PAGE_SIZE - head);
+    }
+    if (madvise(buffer, length, MADV_HUGEPAGE) != 0) {
+        munmap(buffer, length);
+        return nullptr;
+    }
+    obtained = PageBacking::TransparentHuge;
+    return buffer;
+#else
+    return nullptr;
+#endif
+#else
+    (void)bytes;
+    (void)preferred;
+    return nullptr;
+#endif
+}
+
+// Maps ordinary pages, none of them touched yet.
+void* mapPages(std::size_t bytes, PageBacking& obtained) {
+    obtained = PageBacking::Regular;
+#ifdef __linux__
+    if (bytes == 0) {
+        return nullptr;
+    }
+    void* buffer = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        return nullptr;
+    }
+    obtained = PageBacking::Mapped;
+    return buffer;
+#else
+    (void)bytes;
+    return nullptr;
+#endif
+}
+
+// Unmaps a buffer of allocatePages() or mapPages().
+void releasePages(void* buffer, std::size_t bytes, PageBacking backing) {
+#ifdef __linux__
+    if (buffer) {
+        munmap(buffer, backing == PageBacking::Mapped ? bytes : mappedSize(bytes));
+    }
+#else
+    (void)buffer;
+    (void)bytes;
+    (void)backing;
+#endif
+}
+
+// Reads the highest node of a list like "0-1,3".
+int getNumaNodeCount() {
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    if (!(online >> list)) {
+        return 1;
+    }
+    int highest = 0;
+    int value = 0;
+    bool digits = false;
+    for (size_t i = 0; i <= list.size(); ++i) {
+        if (i < list.size() && list[i] >= '0' && list[i] <= '9') {
+            value = value * 10 + (list[i] - '0');
+            digits = true;
+        } else {
+            if (digits && value > highest) {
+                highest = value;
+            }
+            value = 0;
+            digits = false;
+        }
+    }
+    return highest + 1;
+}
+
+// Sets an mbind policy on the whole pages of a buffer.
+bool bindPages(void* buffer, std::size_t bytes, NumaPlacement placement, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+    if ((placement != NumaPlacement::Interleave && placement != NumaPlacement::Bind) || !buffer) {
+        return false;
+    }
+    const bool bind = placement == NumaPlacement::Bind;
+    if (bind && (node < 0 || node >= MAX_NODES)) {
+        return false;
+    }
+    const int first = bind ? node : 0;
+    const int last = bind ? node + 1 : std::min(getNumaNodeCount(), MAX_NODES);
+    const int bits = 8 * static_cast<int>(sizeof(unsigned long));
+    std::vector<unsigned long> mask(MAX_NODES / bits, 0);
+    for (int i = first; i < last; ++i) {
+        mask[i / bits] |= 1UL << (i % bits);
+    }
+    // Only pages entirely inside the buffer: the others may hold other allocations.
+    const std::uintptr_t page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(buffer);
+    const std::uintptr_t begin = (address + page - 1) / page * page;
+    const std::uintptr_t end = (address + bytes) / page * page;
+    if (end <= begin) {
+        return false;
+    }
+    const int mode = bind ? MPOL_BIND_MODE : MPOL_INTERLEAVE_MODE;
+    // The kernel reads maxnode - 1 bits of the mask.
+    return syscall(SYS_mbind, begin, end - begin, mode, mask.data(), static_cast<unsigned long>(MAX_NODES) + 1, 0)
+           == 0;
+#else
+    (void)buffer;
+    (void)bytes;
+    (void)placement;
+    (void)node;
+    return false;
+#endif
+}
+
+} // namespace matrix
@@ -0,0 +1,77 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <cstddef>
+
+namespace matrix {
+
+/**
+ * @brief Kind of pages backing the storage of a matrix.
+ */
+enum class PageBacking {
+    Regular,          // Ordinary heap allocation, 4 KiB pages.
+    TransparentHuge,  // Anonymous mapping advised with MADV_HUGEPAGE, aligned to 2 MiB.
+    ExplicitHuge,     // MAP_HUGETLB mapping from the reserved hugetlbfs pool.
+    Mapped            // Anonymous mapping of 4 KiB pages, fresh for NUMA placement.
+};
+
+/**
+ * @brief Where the pages of a new matrix are placed on a NUMA machine. Linux puts a page on
+ * the node of the thread that first writes it, unless a memory policy says otherwise.
+ */
+enum class NumaPlacement {
+    CallingThread,  // Zero-filled by the constructing thread: every page on its node.
+    FirstTouch,     // Zero-filled in parallel, in bands of rows run by the TaskScheduler.
+    Interleave,     // Pages spread round-robin over all nodes (mbind MPOL_INTERLEAVE).
+    Bind            // Pages on one node (mbind MPOL_BIND).
+};
+
+/**
+ * @brief Size of a huge page, to which mapped buffers are aligned and rounded.
+ */
+const std::size_t HUGE_PAGE_SIZE = static_cast<std::size_t>(2) << 20;
+
+/**
+ * @brief Maps a zero-filled buffer of at least bytes backed by huge pages.
+ *
+ * ExplicitHuge tries a MAP_HUGETLB mapping first, which needs pages reserved in
+ * /proc/sys/vm/nr_hugepages, then falls back to TransparentHuge: a mapping aligned to a huge
+ * page boundary and advised with MADV_HUGEPAGE, which the kernel backs with huge pages when
+ * transparent huge pages are in "always" or "madvise" mode. Returns nullptr, obtained being
+ * Regular, when neither works (or preferred is Regular or Mapped, or the platform is not Linux): the
+ * caller then allocates normally.
+ */
+void* allocatePages(std::size_t bytes, PageBacking preferred, PageBacking& obtained);
+
+/**
+ * @brief Maps a zero-filled buffer of at least bytes of ordinary pages, obtained being Mapped.
+ *
+ * Unlike heap memory, none of its pages has been touched yet and no memory policy applies to
+ * them, so first-touch placement and bindPages() decide where they go; unmapping drops the
+ * policy with the pages. Returns nullptr, obtained being Regular, where mapping fails or the
+ * platform is not Linux.
+ */
+void* mapPages(std::size_t bytes, PageBacking& obtained);
+
+/**
+ * @brief Unmaps a buffer returned by allocatePages() or mapPages() for the same number of
+ * bytes, backing being the one they obtained.
+ */
+void releasePages(void* buffer, std::size_t bytes, PageBacking backing);
+
+/**
+ * @brief Gets the number of NUMA nodes, from /sys/devices/system/node/online; 1 where unknown.
+ */
+int getNumaNodeCount();
+
+/**
+ * @brief Sets the memory policy of the whole pages inside a buffer, before they are first
+ * touched, with the mbind system call: Interleave over every node, or Bind to node. Returns
+ * false, leaving the pages to first-touch placement, for the other placements and where the
+ * call fails: node out of range, no NUMA support in the kernel, or not Linux.
+ */
+bool bindPages(void* buffer, std::size_t bytes, NumaPlacement placement, int node);
+
+} // namespace matrix
+
+#endif // MEMORY_HPP
@@ -0,0 +1,115 @@
+#include "MixedPrecision.hpp"
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+
+// i-k-j product of float matrices into out, one row of Acc sums at a time. The inner
+// loops run over plain arrays so the compiler vectorizes them, widening the float
+// products to Acc as it goes.
+template <typename Acc, typename Out>
+void multiplyRows(const FloatMat& left, const FloatMat& right, bool compensated, BasicSquareMat<Out>& out) {
+    const int n = left.getSize();
+    if (right.getSize() != n) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    std::vector<Acc> sum(n);
+    std::vector<Acc> compensation(compensated ? n : 0);
+    for (int i = 0; i < n; ++i) {
+        std::fill(sum.begin(), sum.end(), Acc());
+        std::fill(compensation.begin(), compensation.end(), Acc());
+        Acc* s = sum.data();
+        Acc* c = compensation.data();
+        const float* a = left[i];
+        for (int k = 0; k < n; ++k) {
+            const float scale = a[k];
+            if (scale == 0.0f) {
+                continue;
+            }
+            const float* b = right[k];
+            if (compensated) {
+                // Kahan summation: c keeps the low-order bits each addition drops.
+                for (int j = 0; j < n; ++j) {
+                    Acc term = scale * b[j] - c[j];
+                    Acc next = s[j] + term;
+                    c[j] = (next - s[j]) - term;
+                    s[j] = next;
+                }
+            } else {
+                // For Acc = double the float product is exact (24 + 24 significant bits <= 53).
+                for (int j = 0; j < n; ++j) {
+                    s[j] += static_cast<Acc>(scale) * b[j];
+                }
+            }
+        }
+        Out* result = out[i];
+        for (int j = 0; j < n; ++j) {
+            result[j] = static_cast<Out>(s[j]);
+        }
+    }
+}
+
+template <typename Out>
+void multiplyInto(const FloatMat& left, const FloatMat& right, Accumulation accumulation,
+                  BasicSquareMat<Out>& out) {
+    switch (accumulation) {
+    case Accumulation::Float:
+        multiplyRows<float>(left, right, false, out);
+        break;
+    case Accumulation::Compensated:
+        multiplyRows<float>(left, right, true, out);
+        break;
+    case Accumulation::Double:
+        multiplyRows<double>(left, right, false, out);
+        break;
+    }
+}
+
+} // namespace
+
+// Rounds a double matrix to float.
+FloatMat toFloat(const SquareMat& matrix) {
+    const int n = matrix.getSize();
+    FloatMat result(n);
+    for (int i = 0; i < n; ++i) {
+        const double* in = matrix[i];
+        float* out = result[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] = static_cast<float>(in[j]);
+        }
+    }
+    return result;
+}
+
+// Widens a float matrix to double.
+SquareMat toDouble(const FloatMat& matrix) {
+    const int n = matrix.getSize();
+    SquareMat result(n);
+    for (int i = 0; i < n; ++i) {
+        const float* in = matrix[i];
+        double* out = result[i];
+        for (int j = 0; j < n; ++j) {
+            out[j] = in[j];
+        }
+    }
+    return result;
+}
+
+// Multiplies float matrices with the selected accumulation, result in float.
+FloatMat multiply(const FloatMat& left, const FloatMat& right, Accumulation accumulation) {
+    FloatMat result(left.getSize());
+    multiplyInto(left, right, accumulation, result);
+    return result;
+}
+
+// Multiplies float matrices with the selected accumulation, result in double.
+SquareMat multiplyToDouble(const FloatMat& left, const FloatMat& right, Accumulation accumulation) {
+    SquareMat result(left.getSize());
+    multiplyInto(left, right, accumulation, result);
+    return result;
+}
+
+} // namespace matrix
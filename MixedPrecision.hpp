@@ -0,0 +1,47 @@
+#ifndef MIXED_PRECISION_HPP
+#define MIXED_PRECISION_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * @brief How the float products of a mixed-precision multiplication are summed.
+ */
+enum class Accumulation {
+    Float,       // Plain float sums: fastest, error grows with n * 2^-24.
+    Compensated, // Kahan-compensated float sums: error about 2^-24, independent of n.
+    Double       // Double sums of the (exact) float products: error about 2^-53 * n.
+};
+
+/**
+ * @brief Float matrix used as the storage of the mixed-precision products.
+ */
+typedef BasicSquareMat<float> FloatMat;
+
+/**
+ * @brief Rounds a double matrix to float, halving the memory traffic of later products.
+ */
+FloatMat toFloat(const SquareMat& matrix);
+
+/**
+ * @brief Widens a float matrix to double.
+ */
+SquareMat toDouble(const FloatMat& matrix);
+
+/**
+ * @brief Multiplies float matrices, summing the products as selected, and rounds the
+ * result to float.
+ */
+FloatMat multiply(const FloatMat& left, const FloatMat& right, Accumulation accumulation);
+
+/**
+ * @brief Multiplies float matrices, summing the products as selected, and keeps the
+ * result in double. With Accumulation::Double the only float rounding is the one of
+ * the operands.
+ */
+SquareMat multiplyToDouble(const FloatMat& left, const FloatMat& right, Accumulation accumulation);
+
+} // namespace matrix
+
+#endif // MIXED_PRECISION_HPP
@@ -0,0 +1,438 @@
+#include "ModMat.hpp"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace matrix {
+
+namespace {
+
+// 128-bit arithmetic is a GCC/Clang extension; __extension__ keeps -pedantic quiet.
+__extension__ typedef unsigned __int128 Wide;
+
+const Wide WIDE_MAX = ~static_cast<Wide>(0);
+
+// High 128 bits of the 256-bit product x * y.
+Wide mulHigh(Wide x, Wide y) {
+    const std::uint64_t x0 = static_cast<std::uint64_t>(x), x1 = static_cast<std::uint64_t>(x >> 64);
+    const std::uint64_t y0 = static_cast<std::uint64_t>(y), y1 = static_cast<std::uint64_t>(y >> 64);
+    const Wide p00 = static_cast<Wide>(x0) * y0;
+    const Wide p01 = static_cast<Wide>(x0) * y1;
+    const Wide p10 = static_cast<Wide>(x1) * y0;
+    const Wide p11 = static_cast<Wide>(x1) * y1;
+    const Wide middle = (p00 >> 64) + static_cast<std::uint64_t>(p01) + static_cast<std::uint64_t>(p10);
+    return p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64);
+}
+
+// Montgomery reduction: value * 2^-64 mod m, for value < m * 2^64.
+inline std::uint64_t redc(Wide value, std::uint64_t modulus, std::uint64_t inverse) {
+    const std::uint64_t factor = static_cast<std::uint64_t>(value) * inverse;
+    // value + factor * m < 2 * m * 2^64 <= 2^128 since m < 2^63, and is divisible by 2^64.
+    std::uint64_t result = static_cast<std::uint64_t>((value + static_cast<Wide>(factor) * modulus) >> 64);
+    return result >= modulus ? result - modulus : result;
+}
+
+// The reduction constants of a ModMat, copied into locals by the kernels.
+struct Reducer {
+    std::uint64_t modulus;
+    ModReduction reduction;
+    std::uint64_t montInverse;
+    std::uint64_t montR2;
+    Wide barrett;
+
+    // value mod m for any value the kernels accumulate.
+    std::uint64_t reduce(Wide value) const {
+        if (reduction == ModReduction::Montgomery) {
+            // redc divides by 2^64; multiplying by 2^128 and reducing again undoes it.
+            return redc(static_cast<Wide>(redc(value, modulus, montInverse)) * montR2, modulus, montInverse);
+        }
+        Wide remainder = value - mulHigh(value, barrett) * modulus; // At most 2m below the quotient error.
+        while (remainder >= modulus) {
+            remainder -= modulus;
+        }
+        return static_cast<std::uint64_t>(remainder);
+    }
+};
+
+// Inverse of value mod modulus by the extended Euclidean algorithm, 0 if there is none.
+std::uint64_t inverseMod(std::uint64_t value, std::uint64_t modulus) {
+    __extension__ typedef __int128 SignedWide;
+    SignedWide r0 = modulus, r1 = value;
+    SignedWide s0 = 0, s1 = 1;
+    while (r1 != 0) {
+        const SignedWide quotient = r0 / r1;
+        SignedWide next = r0 - quotient * r1;
+        r0 = r1;
+        r1 = next;
+        next = s0 - quotient * s1;
+        s0 = s1;
+        s1 = next;
+    }
+    if (r0 != 1) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(s0 < 0 ? s0 + modulus : s0);
+}
+
+// Collects the reduction constants of a ModMat.
+Reducer makeReducer(std::uint64_t modulus, ModReduction reduction, std::uint64_t montInverse,
+                    std::uint64_t montR2, std::uint64_t barrettHigh, std::uint64_t barrettLow) {
+    Reducer reducer;
+    reducer.modulus = modulus;
+    reducer.reduction = reduction;
+    reducer.montInverse = montInverse;
+    reducer.montR2 = montR2;
+    reducer.barrett = (static_cast<Wide>(barrettHigh) << 64) | barrettLow;
+    return reducer;
+}
+
+} // namespace
+
+// Private helper function to compute the reduction constants.
+void ModMat::prepareReduction() {
+    const Wide largestProduct = static_cast<Wide>(modulus - 1) * (modulus - 1);
+    Wide limit;
+    if (modulus % 2 == 1) {
+        reduction = ModReduction::Montgomery;
+        // Newton iteration doubles the correct low bits of m^-1 mod 2^64 each step.
+        std::uint64_t inverse = modulus;
+        for (int i = 0; i < 6; ++i) {
+            inverse *= 2 - modulus * inverse;
+        }
+        montInverse = 0 - inverse;
+        const std::uint64_t r = static_cast<std::uint64_t>((static_cast<Wide>(1) << 64) % modulus);
+        montR2 = static_cast<std::uint64_t>(static_cast<Wide>(r) * r % modulus);
+        barrettLow = barrettHigh = 0;
+        // redc needs its input below m * 2^64.
+        limit = (static_cast<Wide>(modulus) << 64) - modulus;
+    } else {
+        reduction = ModReduction::Barrett;
+        montInverse = montR2 = 0;
+        const Wide reciprocal = WIDE_MAX / modulus;
+        barrettLow = static_cast<std::uint64_t>(reciprocal);
+        barrettHigh = static_cast<std::uint64_t>(reciprocal >> 64);
+        limit = WIDE_MAX - modulus;
+    }
+    // A reduced carry plus chunk products must stay below the limit.
+    const Wide products = largestProduct == 0 ? static_cast<Wide>(size) : limit / largestProduct;
+    chunk = products >= static_cast<Wide>(size) ? size : static_cast<int>(products);
+}
+
+// Constructor that creates a zero matrix modulo modulus.
+ModMat::ModMat(int size, std::uint64_t modulus) : size(size), modulus(modulus), data(nullptr) {
+    if (size <= 0) {
+        throw std::invalid_argument("Matrix size must be a positive integer.");
+    }
+    if (modulus < 2 || modulus >= (static_cast<std::uint64_t>(1) << 63)) {
+        throw std::invalid_argument("Modulus must be in the range [2, 2^63).");
+    }
+    prepareReduction();
+    data = new std::uint64_t[static_cast<size_t>(size) * size]();
+}
+
+// Constructor that reduces an integer matrix modulo modulus.
+ModMat::ModMat(const BasicSquareMat<std::int64_t>& matrix, std::uint64_t modulus)
+    : ModMat(matrix.getSize(), modulus) {
+    for (int i = 0; i < size; ++i) {
+        const std::int64_t* row = matrix[i];
+        for (int j = 0; j < size; ++j) {
+            data[i * size + j] = reduceSigned(row[j]);
+        }
+    }
+}
+
+// Copy constructor
+ModMat::ModMat(const ModMat& other)
+    : size(other.size), modulus(other.modulus), data(nullptr), reduction(other.reduction),
+      montInverse(other.montInverse), montR2(other.montR2), barrettLow(other.barrettLow),
+      barrettHigh(other.barrettHigh), chunk(other.chunk) {
+    const size_t count = static_cast<size_t>(size) * size;
+    data = new std::uint64_t[count];
+    std::copy(other.data, other.data + count, data);
+}
+
+// Assignment operator
+ModMat& ModMat::operator=(const ModMat& other) {
+    if (this != &other) {
+        ModMat copy(other);
+        std::swap(size, copy.size);
+        std::swap(modulus, copy.modulus);
+        std::swap(data, copy.data);
+        reduction = copy.reduction;
+        montInverse = copy.montInverse;
+        montR2 = copy.montR2;
+        barrettLow = copy.barrettLow;
+        barrettHigh = copy.barrettHigh;
+        chunk = copy.chunk;
+    }
+    return *this;
+}
+
+// Destructor
+ModMat::~ModMat() {
+    delete[] data;
+}
+
+// Private helper function to reduce a signed value into [0, m).
+std::uint64_t ModMat::reduceSigned(std::int64_t value) const {
+    if (value >= 0) {
+        return static_cast<std::uint64_t>(value) % modulus;
+    }
+    // -(value + 1) cannot overflow, unlike -value for the smallest int64_t.
+    std::uint64_t magnitude = static_cast<std::uint64_t>(-(value + 1)) % modulus;
+    return modulus - 1 - magnitude;
+}
+
+// Private helper function to check operands of binary operators.
+void ModMat::checkCompatible(const ModMat& other, const char* operation) const {
+    if (size != other.size) {
+        throw std::invalid_argument(std::string("Matrices must have the same size for ") + operation + ".");
+    }
+    if (modulus != other.modulus) {
+        throw std::invalid_argument(std::string("Matrices must have the same modulus for ") + operation + ".");
+    }
+}
+
+// Method to get the value of an element
+std::uint64_t ModMat::get(int row, int col) const {
+    if (row < 0 || row >= size || col < 0 || col >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    return data[row * size + col];
+}
+
+// Method to set the value of an element
+void ModMat::set(int row, int col, std::int64_t value) {
+    if (row < 0 || row >= size || col < 0 || col >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    data[row * size + col] = reduceSigned(value);
+}
+
+// Method to get the size of the matrix
+int ModMat::getSize() const {
+    return size;
+}
+
+// Method to get the modulus
+std::uint64_t ModMat::getModulus() const {
+    return modulus;
+}
+
+// Method to get the reduction used by the products
+ModReduction ModMat::getReduction() const {
+    return reduction;
+}
+
+// Method to convert to an integer matrix
+BasicSquareMat<std::int64_t> ModMat::toMatrix() const {
+    BasicSquareMat<std::int64_t> result(size);
+    for (int i = 0; i < size; ++i) {
+        std::int64_t* row = result[i];
+        for (int j = 0; j < size; ++j) {
+            row[j] = static_cast<std::int64_t>(data[i * size + j]);
+        }
+    }
+    return result;
+}
+
+// Overloads the addition operator (+).
+ModMat ModMat::operator+(const ModMat& other) const {
+    ModMat result(*this);
+    result += other;
+    return result;
+}
+
+// Overloads the subtraction operator (-).
+ModMat ModMat::operator-(const ModMat& other) const {
+    ModMat result(*this);
+    result -= other;
+    return result;
+}
+
+// Overloads the unary minus operator (-).
+ModMat ModMat::operator-() const {
+    ModMat result(*this);
+    const size_t count = static_cast<size_t>(size) * size;
+    for (size_t i = 0; i < count; ++i) {
+        result.data[i] = data[i] == 0 ? 0 : modulus - data[i];
+    }
+    return result;
+}
+
+// Overloads the multiplication operator (*) for matrix multiplication.
+// i-k-j order like the dense SquareMat kernel, accumulating a row of exact 128-bit sums
+// that is reduced every chunk steps of k and once at the end.
+ModMat ModMat::operator*(const ModMat& other) const {
+    checkCompatible(other, "multiplication");
+    const Reducer reducer = makeReducer(modulus, reduction, montInverse, montR2, barrettHigh, barrettLow);
+
+    ModMat result(size, modulus);
+    std::vector<Wide> accumulator(size);
+    for (int i = 0; i < size; ++i) {
+        std::fill(accumulator.begin(), accumulator.end(), 0);
+        const std::uint64_t* left = data + i * size;
+        for (int kStart = 0; kStart < size; kStart += chunk) {
+            const int kEnd = std::min(size, kStart + chunk);
+            for (int k = kStart; k < kEnd; ++k) {
+                const std::uint64_t a = left[k];
+                if (a == 0) {
+                    continue;
+                }
+                const std::uint64_t* right = other.data + k * size;
+                for (int j = 0; j < size; ++j) {
+                    accumulator[j] += static_cast<Wide>(a) * right[j];
+                }
+            }
+            if (kEnd < size) {
+                for (int j = 0; j < size; ++j) {
+                    accumulator[j] = reducer.reduce(accumulator[j]);
+                }
+            }
+        }
+        std::uint64_t* out = result.data + i * size;
+        for (int j = 0; j < size; ++j) {
+            out[j] = reducer.reduce(accumulator[j]);
+        }
+    }
+    return result;
+}
+
+// Overloads the logical NOT operator (!) for the determinant mod m: Gaussian elimination
+// with an invertible pivot in every column.
+std::uint64_t ModMat::operator!() const {
+    const Reducer reducer = makeReducer(modulus, reduction, montInverse, montR2, barrettHigh, barrettLow);
+    std::vector<std::uint64_t> work(data, data + static_cast<size_t>(size) * size);
+    std::uint64_t det = 1 % modulus;
+    for (int k = 0; k < size; ++k) {
+        int pivot = -1;
+        bool nonZero = false;
+        std::uint64_t inverse = 0;
+        for (int i = k; i < size && pivot < 0; ++i) {
+            const std::uint64_t value = work[i * size + k];
+            if (value != 0) {
+                nonZero = true;
+                inverse = inverseMod(value, modulus);
+                if (inverse != 0) {
+                    pivot = i;
+                }
+            }
+        }
+        if (pivot < 0) {
+            if (nonZero) {
+                throw std::invalid_argument("Determinant needs invertible pivots; use a prime modulus.");
+            }
+            return 0;
+        }
+        std::uint64_t* pivotRow = work.data() + k * size;
+        if (pivot != k) {
+            std::swap_ranges(pivotRow + k, pivotRow + size, work.data() + pivot * size + k);
+            det = det == 0 ? 0 : modulus - det;
+        }
+        det = reducer.reduce(static_cast<Wide>(det) * pivotRow[k]);
+        for (int i = k + 1; i < size; ++i) {
+            std::uint64_t* row = work.data() + i * size;
+            if (row[k] == 0) {
+                continue;
+            }
+            // row -= factor * pivotRow, as row + (m - factor) * pivotRow.
+            const std::uint64_t negated = modulus - reducer.reduce(static_cast<Wide>(row[k]) * inverse);
+            for (int j = k + 1; j < size; ++j) {
+                row[j] = reducer.reduce(static_cast<Wide>(negated) * pivotRow[j] + row[j]);
+            }
+        }
+    }
+    return det;
+}
+
+// Overloads the multiplication operator (*) for scalar multiplication.
+ModMat ModMat::operator*(std::int64_t scalar) const {
+    const Wide factor = reduceSigned(scalar);
+    ModMat result(size, modulus);
+    const size_t count = static_cast<size_t>(size) * size;
+    for (size_t i = 0; i < count; ++i) {
+        result.data[i] = static_cast<std::uint64_t>(factor * data[i] % modulus);
+    }
+    return result;
+}
+
+// Overloads the bitwise XOR operator (^) for matrix exponentiation by repeated squaring.
+ModMat ModMat::operator^(long long exponent) const {
+    if (exponent < 0) {
+        throw std::invalid_argument("Exponent must be a non-negative integer.");
+    }
+    ModMat result(size, modulus);
+    for (int i = 0; i < size; ++i) {
+        result.data[i * size + i] = 1;
+    }
+    ModMat base(*this);
+    while (exponent > 0) {
+        if (exponent & 1) {
+            result *= base;
+        }
+        exponent >>= 1;
+        if (exponent > 0) {
+            base *= base;
+        }
+    }
+    return result;
+}
+
+// Overloads the equality operator (==).
+bool ModMat::operator==(const ModMat& other) const {
+    if (size != other.size || modulus != other.modulus) {
+        return false;
+    }
+    return std::equal(data, data + static_cast<size_t>(size) * size, other.data);
+}
+
+// Overloads the inequality operator (!=).
+bool ModMat::operator!=(const ModMat& other) const {
+    return !(*this == other);
+}
+
+// Overloads the compound addition assignment operator (+=).
+ModMat& ModMat::operator+=(const ModMat& other) {
+    checkCompatible(other, "addition");
+    const size_t count = static_cast<size_t>(size) * size;
+    for (size_t i = 0; i < count; ++i) {
+        // Both terms are below 2^63, so the sum cannot wrap.
+        std::uint64_t sum = data[i] + other.data[i];
+        data[i] = sum >= modulus ? sum - modulus : sum;
+    }
+    return *this;
+}
+
+// Overloads the compound subtraction assignment operator (-=).
+ModMat& ModMat::operator-=(const ModMat& other) {
+    checkCompatible(other, "subtraction");
+    const size_t count = static_cast<size_t>(size) * size;
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = data[i] >= other.data[i] ? data[i] - other.data[i] : data[i] + modulus - other.data[i];
+    }
+    return *this;
+}
+
+// Overloads the compound multiplication assignment operator (*=).
+ModMat& ModMat::operator*=(const ModMat& other) {
+    ModMat product = *this * other;
+    *this = product;
+    return *this;
+}
+
+// Overloads the output stream operator (<<) for the ModMat class.
+std::ostream& operator<<(std::ostream& os, const ModMat& matrix) {
+    os << "M_" << matrix.getSize() << "x" << matrix.getSize() << " mod " << matrix.getModulus() << ":\n";
+    for (int i = 0; i < matrix.getSize(); ++i) {
+        os << "[ ";
+        for (int j = 0; j < matrix.getSize(); ++j) {
+            os << matrix.get(i, j) << (j == matrix.getSize() - 1 ? "" : " ");
+        }
+        os << " ]\n";
+    }
+    return os;
+}
+
+} // namespace matrix
@@ -0,0 +1,179 @@
+#ifndef MOD_MAT_HPP
+#define MOD_MAT_HPP
+
+#include "SquareMat.hpp"
+#include <cstdint>
+
+namespace matrix {
+
+/**
+ * @brief How a ModMat reduces its products.
+ */
+enum class ModReduction {
+    Montgomery, // Odd moduli: REDC, two 64-bit multiplications per reduction.
+    Barrett     // Even moduli: multiplication by a precomputed 128-bit reciprocal.
+};
+
+/**
+ * @brief Represents a square matrix over the integers modulo m, for 2 <= m < 2^63.
+ *
+ * Elements are kept reduced in [0, m). The product accumulates the exact 128-bit sums
+ * of products and reduces them inside the kernel, as rarely as the modulus allows (once
+ * per element for m < 2^32), so A * B and A ^ k never overflow and never need a
+ * separate % pass.
+ */
+class ModMat {
+private:
+    int size;
+    std::uint64_t modulus;
+    std::uint64_t* data;       // Row-major, size * size reduced elements.
+    ModReduction reduction;
+    std::uint64_t montInverse; // -m^-1 mod 2^64 (Montgomery).
+    std::uint64_t montR2;      // 2^128 mod m (Montgomery).
+    std::uint64_t barrettLow;  // Low and high words of floor((2^128 - 1) / m) (Barrett).
+    std::uint64_t barrettHigh;
+    int chunk;                 // Products that can be accumulated before a reduction.
+
+    /**
+     * @brief Computes the reduction constants for the modulus.
+     */
+    void prepareReduction();
+
+    /**
+     * @brief Throws std::invalid_argument unless other has the same size and modulus.
+     */
+    void checkCompatible(const ModMat& other, const char* operation) const;
+
+    /**
+     * @brief Reduces a signed value into [0, m).
+     */
+    std::uint64_t reduceSigned(std::int64_t value) const;
+
+public:
+/**
+ * @brief Constructor that creates a zero matrix modulo modulus.
+ */
+ModMat(int size, std::uint64_t modulus);
+
+/**
+ * @brief Constructor that reduces an integer matrix modulo modulus (negative elements included).
+ */
+ModMat(const BasicSquareMat<std::int64_t>& matrix, std::uint64_t modulus);
+
+/**
+ * @brief Copy constructor for the ModMat class.
+ */
+ModMat(const ModMat& other);
+
+/**
+ * @brief Assignment operator for the ModMat class.
+ */
+ModMat& operator=(const ModMat& other);
+
+/**
+ * @brief Destructor for the ModMat class.
+ */
+~ModMat();
+
+/**
+ * @brief Gets the value of the element at the specified row and column, in [0, m).
+ */
+std::uint64_t get(int row, int col) const;
+
+/**
+ * @brief Sets the element at the specified row and column to value mod m.
+ */
+void set(int row, int col, std::int64_t value);
+
+/**
+ * @brief Gets the size (dimension) of the square matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the modulus.
+ */
+std::uint64_t getModulus() const;
+
+/**
+ * @brief Gets the reduction used for products, chosen by the parity of the modulus.
+ */
+ModReduction getReduction() const;
+
+/**
+ * @brief Converts to an integer matrix with the elements in [0, m).
+ */
+BasicSquareMat<std::int64_t> toMatrix() const;
+
+/**
+ * @brief Overloads the addition operator (+) for matrix addition mod m.
+ */
+ModMat operator+(const ModMat& other) const;
+
+/**
+ * @brief Overloads the subtraction operator (-) for matrix subtraction mod m.
+ */
+ModMat operator-(const ModMat& other) const;
+
+/**
+ * @brief Overloads the unary minus operator (-) for negation mod m.
+ */
+ModMat operator-() const;
+
+/**
+ * @brief Overloads the multiplication operator (*) for matrix multiplication mod m.
+ */
+ModMat operator*(const ModMat& other) const;
+
+/**
+ * @brief Overloads the multiplication operator (*) for scalar multiplication mod m.
+ */
+ModMat operator*(std::int64_t scalar) const;
+
+/**
+ * @brief Overloads the bitwise XOR operator (^) for matrix exponentiation mod m,
+ * by repeated squaring (O(log exponent) products).
+ */
+ModMat operator^(long long exponent) const;
+
+/**
+ * @brief Overloads the logical NOT operator (!) to calculate the determinant mod m, by
+ * Gaussian elimination in O(n^3). Throws std::invalid_argument if a column has non-zero
+ * elements but none invertible mod m (which cannot happen for a prime modulus).
+ */
+std::uint64_t operator!() const;
+
+/**
+ * @brief Overloads the equality operator (==): same size, modulus and elements.
+ */
+bool operator==(const ModMat& other) const;
+
+/**
+ * @brief Overloads the inequality operator (!=).
+ */
+bool operator!=(const ModMat& other) const;
+
+/**
+ * @brief Overloads the compound addition assignment operator (+=).
+ */
+ModMat& operator+=(const ModMat& other);
+
+/**
+ * @brief Overloads the compound subtraction assignment operator (-=).
+ */
+ModMat& operator-=(const ModMat& other);
+
+/**
+ * @brief Overloads the compound multiplication assignment operator (*=) for matrix multiplication.
+ */
+ModMat& operator*=(const ModMat& other);
+};
+
+/**
+ * @brief Overloads the output stream operator (<<) for the ModMat class.
+ */
+std::ostream& operator<<(std::ostream& os, const ModMat& matrix);
+
+} // namespace matrix
+
+#endif // MOD_MAT_HPP
@@ -1,12 +1,172 @@
 #include "SquareMat.hpp"
+#include "Decomposition.hpp"
+#include "Strassen.hpp"
+#include "Eigen.hpp"
+#include "ExactDeterminant.hpp"
+#include "TaskScheduler.hpp"
 #include <iostream>
-#include <cmath> // For std::pow
+#include <cmath>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+#include <memory>
+#include <new>
 
 namespace matrix {
 
+namespace {
+// Format selection state shared by all matrices. Atomics keep the counters
+// consistent when products run concurrently.
+std::atomic<int> formatMode(static_cast<int>(FormatMode::Automatic));
+std::atomic<double> sparseThreshold(0.1);
+std::atomic<int> strassenCrossover(0);
+std::atomic<int> spectralPowerThreshold(0);
+std::atomic<int> hugePages(static_cast<int>(PageBacking::Regular));
+std::atomic<std::size_t> hugePageThreshold(FormatPolicy::DEFAULT_HUGE_PAGE_THRESHOLD);
+std::atomic<int> numaPlacement(static_cast<int>(NumaPlacement::CallingThread));
+std::atomic<int> numaNode(0);
+std::atomic<unsigned long> denseProducts(0);
+std::atomic<unsigned long> sparseProducts(0);
+std::atomic<double> lastLeftDensity(1.0);
+std::atomic<double> lastRightDensity(1.0);
+std::atomic<int> lastFormat(static_cast<int>(StorageFormat::Dense));
+
+// Determinant by Gaussian elimination with partial pivoting, for float and complex.
+template <typename T>
+T pivotingDeterminant(BasicSquareMat<T> work) {
+    const int n = work.getSize();
+    T det = T(1);
+    for (int k = 0; k < n; ++k) {
+        int pivot = k;
+        for (int i = k + 1; i < n; ++i) {
+            if (std::abs(work[i][k]) > std::abs(work[pivot][k])) {
+                pivot = i;
+            }
+        }
+        if (work[pivot][k] == T()) {
+            return T();
+        }
+        if (pivot != k) {
+            std::swap_ranges(work[k] + k, work[k] + n, work[pivot] + k);
+            det = -det;
+        }
+        const T* pivotRow = work[k];
+        det *= pivotRow[k];
+        for (int i = k + 1; i < n; ++i) {
+            T* row = work[i];
+            const T factor = row[k] / pivotRow[k];
+            for (int j = k + 1; j < n; ++j) {
+                row[j] -= factor * pivotRow[j];
+            }
+        }
+    }
+    return det;
+}
+
+// Exact integer determinant (see exactDeterminant()), range-checked against T instead of
+// silently wrapping when it does not fit.
+template <typename T>
+T integerDeterminant(const BasicSquareMat<T>& matrix) {
+    const int n = matrix.getSize();
+    BasicSquareMat<std::int64_t> wide(n);
+    for (int i = 0; i < n; ++i) {
+        std::copy(matrix[i], matrix[i] + n, wide[i]);
+    }
+    const ExactDeterminant det = exactDeterminant(wide);
+    if (!det.fitsInt64() || det.toInt64() < std::numeric_limits<T>::min()
+        || det.toInt64() > std::numeric_limits<T>::max()) {
+        throw std::out_of_range("Determinant does not fit in the element type; use exactDeterminant().");
+    }
+    return static_cast<T>(det.toInt64());
+}
+
+// Zero-fills the elements of a new matrix in as many contiguous bands of rows as the
+// TaskScheduler has threads: the pages of a band are first touched, and so placed, by
+// whichever thread runs it. The pool steals work, so no band is tied to a given worker.
+template <typename T>
+void parallelFill(T* block, int size) {
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    const int bands = std::min(size, scheduler.getThreadCount());
+    if (bands < 2) {
+        std::uninitialized_fill(block, block + static_cast<size_t>(size) * size, T());
+        return;
+    }
+    TaskGraph graph;
+    for (int b = 0; b < bands; ++b) {
+        T* begin = block + static_cast<size_t>(size) * (static_cast<long>(size) * b / bands);
+        T* end = block + static_cast<size_t>(size) * (static_cast<long>(size) * (b + 1) / bands);
+        graph.addTask([begin, end] { std::uninitialized_fill(begin, end, T()); });
+    }
+    graph.run(scheduler);
+}
+
+// Power from the eigendecomposition: only symmetric double matrices qualify.
+template <typename T>
+bool hasSpectralPower(const BasicSquareMat<T>&) {
+    return false;
+}
+
+bool hasSpectralPower(const BasicSquareMat<double>& matrix) {
+    return isSymmetric(matrix);
+}
+
+template <typename T>
+bool spectralPower(const BasicSquareMat<T>&, int, BasicSquareMat<T>&) {
+    return false;
+}
+
+bool spectralPower(const BasicSquareMat<double>& matrix, int exponent, BasicSquareMat<double>& result) {
+    // Non-finite elements or no convergence: repeated squaring still has an answer.
+    try {
+        SymmetricEigen(matrix).power(exponent, result);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    return true;
+}
+
+// Element operations whose meaning depends on the element type. The primary
+// template covers float and double: modulo truncates both operands to int.
+template <typename T, bool Integral = std::is_integral<T>::value>
+struct ElementOps {
+    typedef T OrderType;
+    static OrderType order(T value) { return value; }
+    static bool isZeroModulus(T divisor) { return static_cast<int>(divisor) == 0; }
+    static T modulo(T value, T divisor) { return static_cast<int>(value) % static_cast<int>(divisor); }
+    static T determinant(const BasicSquareMat<T>& matrix) { return pivotingDeterminant(matrix); }
+};
+
+// Integers: exact modulo in the full range of T and an exact determinant.
+template <typename T>
+struct ElementOps<T, true> {
+    typedef T OrderType;
+    static OrderType order(T value) { return value; }
+    static bool isZeroModulus(T divisor) { return divisor == 0; }
+    static T modulo(T value, T divisor) { return value % divisor; }
+    static T determinant(const BasicSquareMat<T>& matrix) { return integerDeterminant(matrix); }
+};
+
+// Complex numbers: ordered by magnitude, no modulo.
+template <>
+struct ElementOps<std::complex<double>, false> {
+    typedef double OrderType;
+    static OrderType order(std::complex<double> value) { return std::abs(value); }
+    static bool isZeroModulus(std::complex<double>) { return false; }
+    static std::complex<double> modulo(std::complex<double>, std::complex<double>) {
+        throw std::invalid_argument("Modulo is not defined for complex matrices.");
+    }
+    static std::complex<double> determinant(const BasicSquareMat<std::complex<double>>& matrix) {
+        return pivotingDeterminant(matrix);
+    }
+};
+} // namespace
+
 // Private helper function to calculate the sum of all elements.
-double matrix::SquareMat::sum() const {
-    double totalSum = 0.0;
+template <typename T>
+T BasicSquareMat<T>::sum() const {
+    T totalSum = T();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             totalSum += data[i][j];
@@ -15,135 +175,255 @@ double matrix::SquareMat::sum() const {
     return totalSum;
 }
 
-// Private helper function to recursively calculate the determinant.
-double matrix::SquareMat::determinant() const {
+// Private helper function to calculate the determinant. Cofactor expansion is factorial
+// time, so it is only used up to 3x3, and never for integers, whose products could overflow.
+template <typename T>
+T BasicSquareMat<T>::determinant() const {
+    if (size > 3 || std::is_integral<T>::value) {
+        return largeDeterminant();
+    }
     if (size == 1) {
         return (*this)[0][0];
     }
     if (size == 2) {
         return (*this)[0][0] * (*this)[1][1] - (*this)[0][1] * (*this)[1][0];
     }
-    double det = 0.0;
+    T det = T();
     for (int j = 0; j < size; ++j) {
-        SquareMat sub = getSubMatrix(0, j);
-        det += (*this)[0][j] * std::pow(-1, j) * sub.determinant();
+        BasicSquareMat sub = getSubMatrix(0, j);
+        T sign = (j % 2 == 0) ? T(1) : T(-1);
+        det += (*this)[0][j] * sign * sub.determinant();
     }
     return det;
 }
 
-// Constructor that initializes a square matrix of the given size with zeros.
-SquareMat::SquareMat(int size) : size(size), data(nullptr) {
-    if (size <= 0) {
-        throw std::invalid_argument("Matrix size must be a positive integer.");
+// Private helper function for the determinant beyond 3x3, by the elimination
+// suited to the element type.
+template <typename T>
+T BasicSquareMat<T>::largeDeterminant() const {
+    return ElementOps<T>::determinant(*this);
+}
+
+// Double matrices use (and, when enabled, fill) the cached LU factorization.
+template <>
+double BasicSquareMat<double>::largeDeterminant() const {
+    if (luCache || factorCaching) {
+        return getLU().determinant();
     }
-    // Allocate memory for the array of row pointers
-    data = new double*[size];
-    
-    // Allocate memory for each row (array of doubles) and initialize to zero
+    return LUDecomposition(*this).determinant();
+}
+
+// Private helper function to count the non-zero elements.
+template <typename T>
+long BasicSquareMat<T>::nonZeroCount() const {
+    long count = 0;
     for (int i = 0; i < size; ++i) {
-        data[i] = new double[size];
-        if (!data[i]) {
-            // If allocation fails in the middle, release previously allocated memory
-            for (int j = 0; j < i; ++j) {
-                delete[] data[j];
-            }
-            delete[] data;
-            throw std::bad_alloc();
-        }
+        const T* row = data[i];
+        // Branch-free so the compiler can vectorize the comparison and the sum.
+        int rowCount = 0;
         for (int j = 0; j < size; ++j) {
-            data[i][j] = 0.0;
+            rowCount += (row[j] != T());
         }
+        count += rowCount;
     }
+    return count;
 }
 
-// Copy constructor
-SquareMat::SquareMat(const SquareMat& other) : size(other.size), data(nullptr) {
-    // Allocate memory for the new matrix
-    data = new double*[size];
-
+// Private helper function for the dense product kernel (i-k-j loop order).
+template <typename T>
+void BasicSquareMat<T>::multiplyDense(const BasicSquareMat& other, BasicSquareMat& result) const {
     for (int i = 0; i < size; ++i) {
-        data[i] = new double[size];
-        if (!data[i]) {
-            for (int j = 0; j < i; ++j) {
-                delete[] data[j];
+        T* out = result.data[i];
+        const T* left = data[i];
+        for (int k = 0; k < size; ++k) {
+            const T a = left[k];
+            const T* right = other.data[k];
+            for (int j = 0; j < size; ++j) {
+                out[j] += a * right[j];
             }
-            delete[] data;
-            throw std::bad_alloc();
         }
-        // Copy values from the other matrix
+    }
+}
+
+// Private helper function for the sparse product kernel.
+// The right operand is compressed to CSR and zeros of the left operand are skipped,
+// so the work is proportional to the number of non-zero products.
+template <typename T>
+void BasicSquareMat<T>::multiplySparse(const BasicSquareMat& other, BasicSquareMat& result) const {
+    std::vector<int> rowStart(size + 1, 0);
+    std::vector<int> columns;
+    std::vector<T> values;
+    for (int k = 0; k < size; ++k) {
         for (int j = 0; j < size; ++j) {
-            data[i][j] = other.data[i][j];
+            if (other.data[k][j] != T()) {
+                columns.push_back(j);
+                values.push_back(other.data[k][j]);
+            }
         }
+        rowStart[k + 1] = static_cast<int>(columns.size());
+    }
+    for (int i = 0; i < size; ++i) {
+        T* out = result.data[i];
+        const T* left = data[i];
+        for (int k = 0; k < size; ++k) {
+            const T a = left[k];
+            if (a == T()) {
+                continue;
+            }
+            for (int p = rowStart[k]; p < rowStart[k + 1]; ++p) {
+                out[columns[p]] += a * values[p];
+            }
+        }
+    }
+}
+
+// Private helper function to drop the cached factorization.
+template <typename T>
+void BasicSquareMat<T>::invalidateCache() {
+    if (luCache) {
+        delete luCache;
+        luCache = nullptr;
     }
 }
 
+// Constructor that initializes a square matrix of the given size with zeros.
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(int size)
+    : size(size), data(nullptr), backing(PageBacking::Regular), luCache(nullptr), factorCaching(false) {
+    if (size <= 0) {
+        throw std::invalid_argument("Matrix size must be a positive integer.");
+    }
+    allocate();
+}
+
+// Copy constructor
+template <typename T>
+BasicSquareMat<T>::BasicSquareMat(const BasicSquareMat& other)
+    : size(other.size), data(nullptr), backing(PageBacking::Regular), luCache(nullptr),
+      factorCaching(other.factorCaching) {
+    allocate();
+    std::copy(other.data[0], other.data[0] + static_cast<size_t>(size) * size, data[0]);
+}
+
 // Assignment operator
-SquareMat& SquareMat::operator=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator=(const BasicSquareMat& other) {
     if (this == &other) {
         return *this; // Handle self-assignment (mat = mat;)
     }
+    invalidateCache();
+    factorCaching = other.factorCaching;
     // If the sizes are different, need to deallocate current memory and allocate new
     if (size != other.size) {
-        for (int i = 0; i < size; ++i) {
-            delete[] data[i];
-        }
-        delete[] data;
+        release();
         size = other.size;
-        data = new double*[size];
-
-        for (int i = 0; i < size; ++i) {
-            data[i] = new double[size];
-            if (!data[i]) {
-                for (int j = 0; j < i; ++j) {
-                    delete[] data[j];
-                }
-                delete[] data;
-                throw std::bad_alloc();
-            }
-        }
-    }
-    // Copy values from the other matrix
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            data[i][j] = other.data[i][j];
-        }
+        allocate();
     }
+    std::copy(other.data[0], other.data[0] + static_cast<size_t>(size) * size, data[0]);
     return *this;
 }
 
 // Destructor
-SquareMat::~SquareMat() {
-    if (data) {
-        for (int i = 0; i < size; ++i) {
-            delete[] data[i];
+template <typename T>
+BasicSquareMat<T>::~BasicSquareMat() {
+    invalidateCache();
+    release();
+    size = 0;
+}
+
+// Private helper function to allocate the storage: one block, from huge pages when the
+// policy asks for them and the matrix is large enough. A block to be placed on NUMA nodes is
+// mapped rather than taken from the heap, whose pages may already be touched or carry the
+// policy of an earlier matrix; it is left untouched until the fill decides where its pages go.
+template <typename T>
+void BasicSquareMat<T>::allocate() {
+    const size_t count = static_cast<size_t>(size) * size;
+    const size_t bytes = count * sizeof(T);
+    const NumaPlacement placement = getNumaPlacement();
+    const bool placed = bytes >= NUMA_THRESHOLD && placement != NumaPlacement::CallingThread;
+    T* block = nullptr;
+    backing = PageBacking::Regular;
+    if (bytes >= getHugePageThreshold()) {
+        block = static_cast<T*>(allocatePages(bytes, getHugePages(), backing));
+    }
+    if (!block && placed) {
+        block = static_cast<T*>(mapPages(bytes, backing));
+    }
+    if (!block) {
+        block = static_cast<T*>(::operator new(bytes));
+    }
+    try {
+        data = new T*[size];
+        if (placed) {
+            bindPages(block, bytes, placement, getNumaNode());
+            parallelFill(block, size);
+        } else {
+            std::uninitialized_fill(block, block + count, T());
         }
+    } catch (...) {
         delete[] data;
         data = nullptr;
-        size = 0;
+        if (backing == PageBacking::Regular) {
+            ::operator delete(block);
+        } else {
+            releasePages(block, bytes, backing);
+        }
+        throw;
+    }
+    for (int i = 0; i < size; ++i) {
+        data[i] = block + static_cast<size_t>(i) * size;
+    }
+}
+
+// Private helper function to free the storage.
+template <typename T>
+void BasicSquareMat<T>::release() {
+    if (!data) {
+        return;
+    }
+    // Every element type is trivially destructible: only the memory is freed.
+    if (backing == PageBacking::Regular) {
+        ::operator delete(data[0]);
+    } else {
+        releasePages(data[0], static_cast<size_t>(size) * size * sizeof(T), backing);
     }
+    delete[] data;
+    data = nullptr;
 }
+
 // Method to get the value of a matrix element
-double SquareMat::get(int row, int col) const {
+template <typename T>
+T BasicSquareMat<T>::get(int row, int col) const {
     if (row < 0 || row >= size || col < 0 || col >= size) {
         throw std::out_of_range("Index out of bounds.");
     }
     return data[row][col];
 }
 // Method to set the value of a matrix element
-void SquareMat::set(int row, int col, double value) {
+template <typename T>
+void BasicSquareMat<T>::set(int row, int col, T value) {
     if (row < 0 || row >= size || col < 0 || col >= size) {
         throw std::out_of_range("Index out of bounds.");
     }
+    invalidateCache();
     data[row][col] = value;
 }
 
 // Method to get the size of the matrix
-int SquareMat::getSize() const {
+template <typename T>
+int BasicSquareMat<T>::getSize() const {
     return size;
 }
 
+// Method to get the pages backing the storage
+template <typename T>
+PageBacking BasicSquareMat<T>::getPageBacking() const {
+    return backing;
+}
+
 // Method to print the matrix
-void SquareMat::print() const {
+template <typename T>
+void BasicSquareMat<T>::print() const {
     std::cout << "M_" << size << "x" << size << "_:(R)" << std::endl;
     for (int i = 0; i < size; ++i) {
         std::cout << "[ ";
@@ -154,12 +434,122 @@ void SquareMat::print() const {
     }
 }
 
+// Method to get the fraction of non-zero elements
+template <typename T>
+double BasicSquareMat<T>::density() const {
+    return static_cast<double>(nonZeroCount()) / (static_cast<double>(size) * size);
+}
+
+// Static methods controlling the format selection of operator*
+void FormatPolicy::setFormatMode(FormatMode mode) {
+    formatMode.store(static_cast<int>(mode));
+}
+
+FormatMode FormatPolicy::getFormatMode() {
+    return static_cast<FormatMode>(formatMode.load());
+}
+
+void FormatPolicy::setSparseThreshold(double threshold) {
+    if (!(threshold >= 0.0 && threshold <= 1.0)) {
+        throw std::invalid_argument("Sparse threshold must be in the range [0, 1].");
+    }
+    sparseThreshold.store(threshold);
+}
+
+double FormatPolicy::getSparseThreshold() {
+    return sparseThreshold.load();
+}
+
+void FormatPolicy::setStrassenCrossover(int crossover) {
+    if (crossover < 0) {
+        throw std::invalid_argument("Strassen crossover must be a non-negative integer.");
+    }
+    strassenCrossover.store(crossover);
+}
+
+int FormatPolicy::getStrassenCrossover() {
+    return strassenCrossover.load();
+}
+
+void FormatPolicy::setSpectralPowerThreshold(int exponent) {
+    if (exponent < 0) {
+        throw std::invalid_argument("Spectral power threshold must be a non-negative integer.");
+    }
+    spectralPowerThreshold.store(exponent);
+}
+
+int FormatPolicy::getSpectralPowerThreshold() {
+    return spectralPowerThreshold.load();
+}
+
+void FormatPolicy::setHugePages(PageBacking backing) {
+    hugePages.store(static_cast<int>(backing));
+}
+
+PageBacking FormatPolicy::getHugePages() {
+    return static_cast<PageBacking>(hugePages.load());
+}
+
+void FormatPolicy::setHugePageThreshold(std::size_t bytes) {
+    hugePageThreshold.store(bytes);
+}
+
+std::size_t FormatPolicy::getHugePageThreshold() {
+    return hugePageThreshold.load();
+}
+
+void FormatPolicy::setNumaPlacement(NumaPlacement placement, int node) {
+    if (node < 0) {
+        throw std::invalid_argument("NUMA node must be a non-negative integer.");
+    }
+    numaNode.store(node);
+    numaPlacement.store(static_cast<int>(placement));
+}
+
+NumaPlacement FormatPolicy::getNumaPlacement() {
+    return static_cast<NumaPlacement>(numaPlacement.load());
+}
+
+int FormatPolicy::getNumaNode() {
+    return numaNode.load();
+}
+
+FormatStats FormatPolicy::getFormatStats() {
+    FormatStats stats;
+    stats.denseProducts = denseProducts.load();
+    stats.sparseProducts = sparseProducts.load();
+    stats.lastLeftDensity = lastLeftDensity.load();
+    stats.lastRightDensity = lastRightDensity.load();
+    stats.lastFormat = static_cast<StorageFormat>(lastFormat.load());
+    return stats;
+}
+
+void FormatPolicy::recordProduct(double leftDensity, double rightDensity, StorageFormat format) {
+    if (format == StorageFormat::Sparse) {
+        ++sparseProducts;
+    } else {
+        ++denseProducts;
+    }
+    lastLeftDensity.store(leftDensity);
+    lastRightDensity.store(rightDensity);
+    lastFormat.store(static_cast<int>(format));
+}
+
+void FormatPolicy::resetFormatStats() {
+    denseProducts.store(0);
+    sparseProducts.store(0);
+    lastLeftDensity.store(1.0);
+    lastRightDensity.store(1.0);
+    lastFormat.store(static_cast<int>(StorageFormat::Dense));
+}
+
 // Overloads the addition operator (+) for matrix addition.
-matrix::SquareMat matrix::SquareMat::operator+(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator+(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for addition.");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result.data[i][j] = this->data[i][j] + other.data[i][j];
@@ -169,11 +559,12 @@ matrix::SquareMat matrix::SquareMat::operator+(const SquareMat& other) const {
 }
 
 // Overloads the subtraction operator (-) for matrix subtraction.
-matrix::SquareMat matrix::SquareMat::operator-(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator-(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for subtraction.");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result.data[i][j] = this->data[i][j] - other.data[i][j];
@@ -183,8 +574,9 @@ matrix::SquareMat matrix::SquareMat::operator-(const SquareMat& other) const {
 }
 
 // Overloads the unary minus operator (-) for negation.
-matrix::SquareMat matrix::SquareMat::operator-() const {
-    SquareMat result(size);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator-() const {
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result.data[i][j] = -(this->data[i][j]);
@@ -193,15 +585,18 @@ matrix::SquareMat matrix::SquareMat::operator-() const {
     return result;
 }
 // Overloads the subscript operator [] for accessing rows (non-const version).
-double* matrix::SquareMat::operator[](int row) {
+template <typename T>
+T* BasicSquareMat<T>::operator[](int row) {
     if (row < 0 || row >= size) {
         throw std::out_of_range("Row index out of bounds.");
     }
+    invalidateCache(); // The caller may write through the returned row.
     return data[row];
 }
 
 // Overloads the subscript operator [] for accessing rows (const version).
-const double* matrix::SquareMat::operator[](int row) const {
+template <typename T>
+const T* BasicSquareMat<T>::operator[](int row) const {
     if (row < 0 || row >= size) {
         throw std::out_of_range("Row index out of bounds.");
     }
@@ -209,36 +604,49 @@ const double* matrix::SquareMat::operator[](int row) const {
 }
 
 // Overloads the equality operator (==) to compare two matrices based on the sum of their elements.
-bool matrix::SquareMat::operator==(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator==(const BasicSquareMat& other) const {
     return this->sum() == other.sum();
 }
 
 // Overloads the inequality operator (!=) for comparing two matrices.
-bool matrix::SquareMat::operator!=(const SquareMat& other) const {
+template <typename T>
+bool BasicSquareMat<T>::operator!=(const BasicSquareMat& other) const {
     return !(*this == other);
 }
 
 // Overloads the multiplication operator (*) for matrix multiplication.
-matrix::SquareMat matrix::SquareMat::operator*(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator*(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for multiplication.");
     }
-    SquareMat result(size);
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            double sum = 0.0;
-            for (int k = 0; k < size; ++k) {
-                sum += (*this)[i][k] * other[k][j];
-            }
-            result[i][j] = sum;
-        }
+    BasicSquareMat result(size);
+    // Scanning the densities costs O(n^2), negligible next to the O(n^3) product.
+    // Since the decision is taken per product, repeated products (e.g. operator^)
+    // fall back to the dense kernel once fill-in makes the operands dense.
+    FormatMode mode = getFormatMode();
+    double leftDensity = density();
+    double rightDensity = other.density();
+    bool useSparse = mode == FormatMode::ForceSparse ||
+                     (mode == FormatMode::Automatic &&
+                      leftDensity * rightDensity < getSparseThreshold());
+    int crossover = getStrassenCrossover();
+    if (useSparse) {
+        multiplySparse(other, result);
+    } else if (crossover > 0 && size > crossover) {
+        multiplyStrassen(*this, other, result, crossover);
+    } else {
+        multiplyDense(other, result);
     }
+    recordProduct(leftDensity, rightDensity, useSparse ? StorageFormat::Sparse : StorageFormat::Dense);
     return result;
 }
 
 // Overloads the multiplication operator (*) for scalar multiplication (matrix * scalar).
-matrix::SquareMat SquareMat::operator*(double scalar) const {
-    SquareMat result(size);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator*(T scalar) const {
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result[i][j] = (*this)[i][j] * scalar;
@@ -247,17 +655,13 @@ matrix::SquareMat SquareMat::operator*(double scalar) const {
     return result;
 }
 
-// Overloads the multiplication operator (*) for scalar multiplication (scalar * matrix).
-matrix::SquareMat operator*(double scalar, const SquareMat& matrix) {
-    return matrix * scalar; // Reuse the member operator for efficiency.
-}
-
 // Overloads the modulo operator (%) for element-wise matrix multiplication.
-matrix::SquareMat matrix::SquareMat::operator%(const SquareMat& other) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator%(const BasicSquareMat& other) const {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for element-wise multiplication.");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result[i][j] = (*this)[i][j] * other[i][j];
@@ -267,25 +671,27 @@ matrix::SquareMat matrix::SquareMat::operator%(const SquareMat& other) const {
 }
 
 // Overloads the modulo operator (%) for scalar modulo (matrix % scalar).
-matrix::SquareMat matrix::SquareMat::operator%(double scalar) const {
-    if (static_cast<int>(scalar) == 0) {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator%(T scalar) const {
+    if (ElementOps<T>::isZeroModulus(scalar)) {
         throw std::invalid_argument("Cannot perform modulo with a scalar of zero.");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
-            result[i][j] = static_cast<int>((*this)[i][j]) % static_cast<int>(scalar);
+            result[i][j] = ElementOps<T>::modulo((*this)[i][j], scalar);
         }
     }
     return result;
 }
 
 // Overloads the division operator (/) for scalar division (matrix / scalar).
-matrix::SquareMat matrix::SquareMat::operator/(double scalar) const {
-    if (scalar == 0.0) {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator/(T scalar) const {
+    if (scalar == T()) {
         throw std::invalid_argument("Cannot divide by a scalar of zero.");
     }
-    SquareMat result(size);
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result[i][j] = (*this)[i][j] / scalar;
@@ -294,68 +700,93 @@ matrix::SquareMat matrix::SquareMat::operator/(double scalar) const {
     return result;
 }
 
-// Overloads the bitwise XOR operator (^) for matrix exponentiation (simple implementation).
-matrix::SquareMat matrix::SquareMat::operator^(int exponent) const {
+// Overloads the bitwise XOR operator (^) for matrix exponentiation by repeated squaring.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator^(int exponent) const {
     if (exponent < 0) {
         throw std::invalid_argument("Exponent must be a non-negative integer.");
     }
 
     if (exponent == 0) {
         // Any matrix to the power of 0 is the identity matrix.
-        SquareMat result(size);
+        BasicSquareMat result(size);
         for (int i = 0; i < size; ++i) {
-            result[i][i] = 1.0;
+            result[i][i] = T(1);
         }
         return result;
     }
 
-    SquareMat result = *this; // Start with a copy of the original matrix.
+    const int threshold = getSpectralPowerThreshold();
+    if (threshold > 0 && exponent >= threshold && hasSpectralPower(*this)) {
+        BasicSquareMat result(size);
+        if (spectralPower(*this, exponent, result)) {
+            return result;
+        }
+    }
 
-    // Multiply the result by the original matrix (exponent - 1) times.
-    for (int i = 1; i < exponent; ++i) {
-        result = result * (*this);
+    // base = A^(2^bit); result starts as the power of the lowest set bit and collects the others.
+    BasicSquareMat base = *this;
+    while ((exponent & 1) == 0) {
+        base = base * base;
+        exponent >>= 1;
+    }
+    BasicSquareMat result = base;
+    exponent >>= 1;
+    while (exponent != 0) {
+        base = base * base;
+        if (exponent & 1) {
+            result = result * base;
+        }
+        exponent >>= 1;
     }
 
     return result;
 }
 
 // Overloads the pre-increment operator (++mat).
-matrix::SquareMat& matrix::SquareMat::operator++() {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator++() {
+    invalidateCache();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
-            data[i][j]++;
+            data[i][j] += T(1);
         }
     }
     return *this;
 }
 
 // Overloads the pre-decrement operator (--mat).
-matrix::SquareMat& matrix::SquareMat::operator--() {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator--() {
+    invalidateCache();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
-            data[i][j]--;
+            data[i][j] -= T(1);
         }
     }
     return *this;
 }
 
 // Overloads the post-increment operator (mat++).
-matrix::SquareMat matrix::SquareMat::operator++(int) {
-    SquareMat temp = *this; // Create a copy of the current matrix.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator++(int) {
+    BasicSquareMat temp = *this; // Create a copy of the current matrix.
     ++(*this);             // Call the pre-increment operator.
     return temp;           // Return the original copy.
 }
 
 // Overloads the post-decrement operator (mat--).
-matrix::SquareMat matrix::SquareMat::operator--(int) {
-    SquareMat temp = *this; // Create a copy of the current matrix.
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator--(int) {
+    BasicSquareMat temp = *this; // Create a copy of the current matrix.
     --(*this);             // Call the pre-decrement operator.
     return temp;           // Return the original copy.
 }
 
 // Overloads the bitwise NOT operator (~) for matrix transpose.
-matrix::SquareMat matrix::SquareMat::operator~() const {
-    SquareMat result(size);
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::operator~() const {
+    BasicSquareMat result(size);
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             result[j][i] = (*this)[i][j];
@@ -365,33 +796,38 @@ matrix::SquareMat matrix::SquareMat::operator~() const {
 }
 
 // Overloads the less than operator (<) to compare the sum of elements of two matrices.
-bool matrix::SquareMat::operator<(const SquareMat& other) const {
-    return this->sum() < other.sum();
+template <typename T>
+bool BasicSquareMat<T>::operator<(const BasicSquareMat& other) const {
+    return ElementOps<T>::order(this->sum()) < ElementOps<T>::order(other.sum());
 }
 
 // Overloads the greater than operator (>) to compare the sum of elements of two matrices.
-bool matrix::SquareMat::operator>(const SquareMat& other) const {
-    return this->sum() > other.sum();
+template <typename T>
+bool BasicSquareMat<T>::operator>(const BasicSquareMat& other) const {
+    return ElementOps<T>::order(this->sum()) > ElementOps<T>::order(other.sum());
 }
 
 // Overloads the less than or equal to operator (<=) to compare the sum of elements of two matrices.
-bool matrix::SquareMat::operator<=(const SquareMat& other) const {
-    return this->sum() <= other.sum();
+template <typename T>
+bool BasicSquareMat<T>::operator<=(const BasicSquareMat& other) const {
+    return ElementOps<T>::order(this->sum()) <= ElementOps<T>::order(other.sum());
 }
 
 // Overloads the greater than or equal to operator (>=) to compare the sum of elements of two matrices.
-bool matrix::SquareMat::operator>=(const SquareMat& other) const {
-    return this->sum() >= other.sum();
+template <typename T>
+bool BasicSquareMat<T>::operator>=(const BasicSquareMat& other) const {
+    return ElementOps<T>::order(this->sum()) >= ElementOps<T>::order(other.sum());
 }
 
 
 
 // Private helper function to create a sub-matrix.
-matrix::SquareMat matrix::SquareMat::getSubMatrix(int rowToRemove, int colToRemove) const {
+template <typename T>
+BasicSquareMat<T> BasicSquareMat<T>::getSubMatrix(int rowToRemove, int colToRemove) const {
     if (size <= 1) {
         throw std::invalid_argument("Cannot create a sub-matrix of a 1x1 or smaller matrix.");
     }
-    SquareMat subMatrix(size - 1);
+    BasicSquareMat subMatrix(size - 1);
     int currentRow = 0;
     for (int i = 0; i < size; ++i) {
         if (i != rowToRemove) {
@@ -409,15 +845,60 @@ matrix::SquareMat matrix::SquareMat::getSubMatrix(int rowToRemove, int colToRemo
 }
 
 // Overloads the logical NOT operator (!) to calculate the determinant of the matrix.
-double matrix::SquareMat::operator!() const {
+template <typename T>
+T BasicSquareMat<T>::operator!() const {
     return this->determinant();
 }
 
+// Calculates the sign and logarithm of the determinant through an LU factorization.
+template <>
+LogDeterminant BasicSquareMat<double>::logAbsDet() const {
+    if (luCache || factorCaching) {
+        return getLU().logDeterminant();
+    }
+    return LUDecomposition(*this).logDeterminant();
+}
+
+// Calculates the inverse of the matrix through an LU factorization.
+template <>
+BasicSquareMat<double> BasicSquareMat<double>::inverse() const {
+    if (luCache || factorCaching) {
+        return getLU().inverse();
+    }
+    return LUDecomposition(*this).inverse();
+}
+
+// Gets the LU factorization, computing and caching it on first use.
+template <>
+const LUDecomposition& BasicSquareMat<double>::getLU() const {
+    if (!luCache) {
+        luCache = new LUDecomposition(*this);
+    }
+    return *luCache;
+}
+
+// Checks if a factorization is cached.
+template <typename T>
+bool BasicSquareMat<T>::hasCachedFactorization() const {
+    return luCache != nullptr;
+}
+
+// Enables or disables caching of the factorization by operator! and inverse().
+template <typename T>
+void BasicSquareMat<T>::setFactorCaching(bool enabled) {
+    factorCaching = enabled;
+    if (!enabled) {
+        invalidateCache();
+    }
+}
+
 // Overloads the compound addition assignment operator (+=).
-matrix::SquareMat& matrix::SquareMat::operator+=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator+=(const BasicSquareMat& other) {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for addition assignment.");
     }
+    invalidateCache();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             data[i][j] += other[i][j];
@@ -427,10 +908,12 @@ matrix::SquareMat& matrix::SquareMat::operator+=(const SquareMat& other) {
 }
 
 // Overloads the compound subtraction assignment operator (-=).
-matrix::SquareMat& matrix::SquareMat::operator-=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator-=(const BasicSquareMat& other) {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for subtraction assignment.");
     }
+    invalidateCache();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             data[i][j] -= other[i][j];
@@ -440,20 +923,25 @@ matrix::SquareMat& matrix::SquareMat::operator-=(const SquareMat& other) {
 }
 
 // Overloads the compound multiplication assignment operator (*=) for matrix multiplication.
-matrix::SquareMat& matrix::SquareMat::operator*=(const SquareMat& other) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator*=(const BasicSquareMat& other) {
     if (size != other.size) {
         throw std::invalid_argument("Matrices must have the same size for multiplication assignment.");
     }
-    SquareMat temp = *this * other; // Use the regular multiplication operator.
-    *this = temp;                   // Assign the result back to this matrix.
+    BasicSquareMat temp = *this * other; // Use the regular multiplication operator.
+    // Copy the elements back, keeping the factor caching setting of this matrix.
+    invalidateCache();
+    std::copy(temp.data[0], temp.data[0] + static_cast<size_t>(size) * size, data[0]);
     return *this;
 }
 
 // Overloads the compound division assignment operator (/=) for scalar division.
-matrix::SquareMat& matrix::SquareMat::operator/=(double scalar) {
-    if (scalar == 0.0) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator/=(T scalar) {
+    if (scalar == T()) {
         throw std::invalid_argument("Cannot divide by a scalar of zero.");
     }
+    invalidateCache();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
             data[i][j] /= scalar;
@@ -463,22 +951,23 @@ matrix::SquareMat& matrix::SquareMat::operator/=(double scalar) {
 }
 
 // Overloads the compound modulo assignment operator (%=) for scalar modulo.
-matrix::SquareMat& matrix::SquareMat::operator%=(double scalar) {
-    if (static_cast<int>(scalar) == 0) {
+template <typename T>
+BasicSquareMat<T>& BasicSquareMat<T>::operator%=(T scalar) {
+    if (ElementOps<T>::isZeroModulus(scalar)) {
         throw std::invalid_argument("Cannot perform modulo with a scalar of zero.");
     }
-    SquareMat result(size); // Create a temporary matrix
+    invalidateCache();
     for (int i = 0; i < size; ++i) {
         for (int j = 0; j < size; ++j) {
-            result[i][j] = static_cast<int>(data[i][j]) % static_cast<int>(scalar);
+            data[i][j] = ElementOps<T>::modulo(data[i][j], scalar);
         }
     }
-    *this = result; // Copy the results back to the original matrix
     return *this;
 }
 
-// Overloads the output stream operator (<<) for the SquareMat class.
-std::ostream& operator<<(std::ostream& os, const SquareMat& matrix) {
+// Overloads the output stream operator (<<) for the BasicSquareMat class.
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicSquareMat<T>& matrix) {
     os << "M_" << matrix.getSize() << "x" << matrix.getSize() << ":\n";
     for (int i = 0; i < matrix.getSize(); ++i) {
         os << "[ ";
@@ -490,4 +979,70 @@ std::ostream& operator<<(std::ostream& os, const SquareMat& matrix) {
     return os;
 }
 
+// Computes C = alpha * A * B + beta * C with the i-k-j kernel, scaling each row of C
+// by beta just before accumulating into it.
+template <typename T>
+void gemm(T alpha, const BasicSquareMat<T>& a, const BasicSquareMat<T>& b, T beta, BasicSquareMat<T>& c) {
+    const int n = c.getSize();
+    if (a.getSize() != n || b.getSize() != n) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    if (&c == &a || &c == &b) {
+        BasicSquareMat<T> result(c);
+        gemm(alpha, a, b, beta, result);
+        c = result;
+        return;
+    }
+    std::vector<const T*> rows(n);
+    for (int k = 0; k < n; ++k) {
+        rows[k] = b[k];
+    }
+    for (int i = 0; i < n; ++i) {
+        T* out = c[i];
+        if (beta == T()) {
+            std::fill(out, out + n, T());
+        } else if (beta != T(1)) {
+            for (int j = 0; j < n; ++j) {
+                out[j] *= beta;
+            }
+        }
+        const T* left = a[i];
+        for (int k = 0; k < n; ++k) {
+            const T scale = alpha * left[k];
+            if (scale == T()) {
+                continue;
+            }
+            const T* right = rows[k];
+            for (int j = 0; j < n; ++j) {
+                out[j] += scale * right[j];
+            }
+        }
+    }
+}
+
+// The element types the library is compiled for.
+template class BasicSquareMat<float>;
+template class BasicSquareMat<double>;
+template class BasicSquareMat<std::int32_t>;
+template class BasicSquareMat<std::int64_t>;
+template class BasicSquareMat<std::complex<double>>;
+
+template void gemm(float, const BasicSquareMat<float>&, const BasicSquareMat<float>&, float,
+                   BasicSquareMat<float>&);
+template void gemm(double, const BasicSquareMat<double>&, const BasicSquareMat<double>&, double,
+                   BasicSquareMat<double>&);
+template void gemm(std::int32_t, const BasicSquareMat<std::int32_t>&, const BasicSquareMat<std::int32_t>&,
+                   std::int32_t, BasicSquareMat<std::int32_t>&);
+template void gemm(std::int64_t, const BasicSquareMat<std::int64_t>&, const BasicSquareMat<std::int64_t>&,
+                   std::int64_t, BasicSquareMat<std::int64_t>&);
+template void gemm(std::complex<double>, const BasicSquareMat<std::complex<double>>&,
+                   const BasicSquareMat<std::complex<double>>&, std::complex<double>,
+                   BasicSquareMat<std::complex<double>>&);
+
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMat<float>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMat<double>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMat<std::int32_t>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMat<std::int64_t>& matrix);
+template std::ostream& operator<<(std::ostream& os, const BasicSquareMat<std::complex<double>>& matrix);
+
 } // namespace matrix
\ No newline at end of file
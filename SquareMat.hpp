@@ -3,217 +3,510 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <complex>
+#include <cstdint>
+#include <cstddef>
+#include "Memory.hpp"
 
 namespace matrix {
 
 /**
- * @brief Represents a square matrix of double-precision floating-point numbers.
+ * @brief Storage format used by a matrix multiplication kernel.
+ */
+enum class StorageFormat {
+    Dense,  // Row-major n x n kernel.
+    Sparse  // Compressed sparse row (CSR) kernel that skips zero elements.
+};
+
+/**
+ * @brief Controls how operator* chooses between the dense and the sparse kernel.
+ */
+enum class FormatMode {
+    Automatic,   // Choose by density, see FormatPolicy::setSparseThreshold().
+    ForceDense,  // Always use the dense kernel.
+    ForceSparse  // Always convert to the compressed representation.
+};
+
+/**
+ * @brief Counters describing the format decisions taken by operator*.
+ */
+struct FormatStats {
+    unsigned long denseProducts;  // Products computed with the dense kernel.
+    unsigned long sparseProducts; // Products computed with the sparse kernel.
+    double lastLeftDensity;       // Density of the left operand of the last product.
+    double lastRightDensity;      // Density of the right operand of the last product.
+    StorageFormat lastFormat;     // Format chosen for the last product.
+};
+
+/**
+ * @brief Format selection of operator*, shared by the matrices of every element type.
+ */
+class FormatPolicy {
+protected:
+    /**
+     * @brief Records the decision taken by one product.
+     */
+    static void recordProduct(double leftDensity, double rightDensity, StorageFormat format);
+
+public:
+/**
+ * @brief Sets how operator* chooses between the dense and the sparse kernel.
+ */
+static void setFormatMode(FormatMode mode);
+
+/**
+ * @brief Gets the current format mode of operator*.
+ */
+static FormatMode getFormatMode();
+
+/**
+ * @brief Sets the density threshold of the automatic mode.
+ *
+ * The sparse kernel does work proportional to density(A) * density(B) * n^3, so it
+ * is chosen when that product is below the threshold. Must be in the range [0, 1].
+ */
+static void setSparseThreshold(double threshold);
+
+/**
+ * @brief Gets the density threshold of the automatic mode.
+ */
+static double getSparseThreshold();
+
+/**
+ * @brief Makes the dense kernel of operator* use multiplyStrassen() with this crossover
+ * for matrices larger than it. 0, the default, always uses the classical kernel.
+ */
+static void setStrassenCrossover(int crossover);
+
+/**
+ * @brief Gets the Strassen crossover of operator*, 0 if disabled.
+ */
+static int getStrassenCrossover();
+
+/**
+ * @brief Makes operator^ of symmetric double matrices compute powers of at least this
+ * exponent from a SymmetricEigen decomposition, at a cost independent of the exponent.
+ * The result is then accurate to rounding rather than a product of the exact elements.
+ * 0, the default, always uses repeated squaring.
+ */
+static void setSpectralPowerThreshold(int exponent);
+
+/**
+ * @brief Gets the exponent from which operator^ uses the eigendecomposition, 0 if disabled.
+ */
+static int getSpectralPowerThreshold();
+
+/**
+ * @brief Sets the pages that back the storage of matrices of at least the huge page
+ * threshold: TransparentHuge or ExplicitHuge try huge pages, falling back to regular ones
+ * (see allocatePages()); Regular, the default, always allocates from the heap. A large
+ * matrix then spans a few hundred TLB entries instead of one per 4 KiB page.
+ */
+static void setHugePages(PageBacking backing);
+
+/**
+ * @brief Gets the pages tried for large matrices.
+ */
+static PageBacking getHugePages();
+
+/**
+ * @brief Sets the storage size, in bytes, from which matrices try huge pages. The default,
+ * DEFAULT_HUGE_PAGE_THRESHOLD, is 32 MiB (a 2048 x 2048 double matrix).
+ */
+static void setHugePageThreshold(std::size_t bytes);
+
+/**
+ * @brief Gets the storage size from which matrices try huge pages.
+ */
+static std::size_t getHugePageThreshold();
+
+/**
+ * @brief Default storage size from which matrices try huge pages.
+ */
+static const std::size_t DEFAULT_HUGE_PAGE_THRESHOLD = static_cast<std::size_t>(32) << 20;
+
+/**
+ * @brief Sets where the pages of matrices of at least NUMA_THRESHOLD bytes go. CallingThread,
+ * the default, zero-fills them on the constructing thread, which puts them all on its node.
+ * FirstTouch zero-fills them in parallel on the shared TaskScheduler, in one contiguous band
+ * of rows per thread, so the pages spread over the nodes of the threads that run the bands.
+ * That spread is the only guarantee: bands are not tied to workers, and nothing makes a
+ * worker later read the rows it placed. Interleave and Bind set an mbind policy first (see bindPages()),
+ * then fill in parallel too; where the policy cannot be set (node out of range, no NUMA
+ * support) they fall back to FirstTouch. Except on huge pages, these three placements map
+ * the block (PageBacking::Mapped) instead of reusing heap pages that may be touched already.
+ * node is the node of Bind. Throws std::invalid_argument for a negative node.
+ */
+static void setNumaPlacement(NumaPlacement placement, int node = 0);
+
+/**
+ * @brief Gets the placement of the pages of large matrices.
+ */
+static NumaPlacement getNumaPlacement();
+
+/**
+ * @brief Gets the node of the Bind placement.
+ */
+static int getNumaNode();
+
+/**
+ * @brief Storage size from which the NUMA placement applies; smaller matrices are always
+ * filled by the constructing thread.
+ */
+static const std::size_t NUMA_THRESHOLD = static_cast<std::size_t>(4) << 20;
+
+/**
+ * @brief Returns the format decisions taken by operator* since the last reset.
+ */
+static FormatStats getFormatStats();
+
+/**
+ * @brief Resets the format decision counters.
+ */
+static void resetFormatStats();
+};
+
+class LUDecomposition;
+
+/**
+ * @brief A determinant kept as sign * exp(logAbs), which cannot overflow or underflow.
+ * A zero determinant has sign 0 and logAbs -infinity.
+ */
+struct LogDeterminant {
+    int sign;
+    double logAbs;
+};
+
+/**
+ * @brief Represents a square matrix of elements of type T.
+ *
+ * Instantiated for float, double, std::int32_t, std::int64_t and std::complex<double>.
+ * Every operator is the same template for all of them, so each element type gets its
+ * own kernels (float products vectorize over twice as many lanes as double ones), and
+ * integer matrices compute %, / and the determinant exactly in integer arithmetic.
+ * The factorization based members (inverse(), getLU()) exist for double only.
  */
-class SquareMat {
+template <typename T>
+class BasicSquareMat : public FormatPolicy {
 private:
     int size;
-    double** data;
+    T** data;                         // Row pointers into one contiguous row-major block.
+    PageBacking backing;              // Pages of the block, see FormatPolicy::setHugePages().
+    mutable LUDecomposition* luCache; // Cached factorization, dropped by every mutation.
+    bool factorCaching;               // Whether operator! and inverse() fill luCache.
+
+    /**
+     * @brief Drops the cached factorization. Called by every mutating method.
+     */
+    void invalidateCache();
+
+    /**
+     * @brief Allocates the zero-filled block and the row pointers for size rows, placing
+     * the pages as FormatPolicy::setNumaPlacement() says.
+     */
+    void allocate();
+
+    /**
+     * @brief Frees the block and the row pointers.
+     */
+    void release();
+
     /**
      * @brief Helper function to calculate the sum of all elements in the matrix.
      */
-    double sum() const;
+    T sum() const;
     /**
      * @brief Creates a sub-matrix by excluding a given row and column.
      */
-    SquareMat getSubMatrix(int rowToRemove, int colToRemove) const;
+    BasicSquareMat getSubMatrix(int rowToRemove, int colToRemove) const;
 
     /**
-     * @brief Recursively calculates the determinant of the matrix.
-     */
-    double determinant() const;
+     * @brief Calculates the determinant, directly up to 3x3 and by elimination beyond:
+     * LU for double, partial pivoting for float and complex, fraction-free for integers.
+     */
+    T determinant() const;
+
+    /**
+     * @brief Calculates the determinant of a matrix larger than 3x3.
+     */
+    T largeDeterminant() const;
+
+    /**
+     * @brief Counts the non-zero elements of the matrix.
+     */
+    long nonZeroCount() const;
+
+    /**
+     * @brief Computes this * other with the dense kernel into result.
+     */
+    void multiplyDense(const BasicSquareMat& other, BasicSquareMat& result) const;
+
+    /**
+     * @brief Computes this * other with other converted to CSR, skipping zeros of this.
+     */
+    void multiplySparse(const BasicSquareMat& other, BasicSquareMat& result) const;
 
 public:
 /**
  * @brief Constructor for the SquareMat class.
  */
-SquareMat(int size);
+BasicSquareMat(int size);
 
 /**
  * @brief Copy constructor for the SquareMat class.
  */
-SquareMat(const SquareMat& other);
+BasicSquareMat(const BasicSquareMat& other);
 
 /**
  * @brief Assignment operator for the SquareMat class.
  */
-SquareMat& operator=(const SquareMat& other);
+BasicSquareMat& operator=(const BasicSquareMat& other);
 
 /**
  * @brief Destructor for the SquareMat class.
  */
-~SquareMat();
+~BasicSquareMat();
 
 /**
  * @brief Gets the value of the element at the specified row and column.
  */
-double get(int row, int col) const;
+T get(int row, int col) const;
 
 /**
  * @brief Sets the value of the element at the specified row and column.
  */
-void set(int row, int col, double value);
+void set(int row, int col, T value);
 
 /**
  * @brief Gets the size (dimension) of the square matrix.
  */
 int getSize() const;
 
+/**
+ * @brief Gets the pages backing the storage of the matrix.
+ */
+PageBacking getPageBacking() const;
+
 /**
  * @brief Prints the matrix elements to the standard output.
  */
 void print() const;
 
+/**
+ * @brief Returns the fraction of non-zero elements, in the range [0, 1].
+ */
+double density() const;
+
 /**
  * @brief Overloads the addition operator (+) for matrix addition.
  */
-SquareMat operator+(const SquareMat& other) const;
+BasicSquareMat operator+(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the subtraction operator (-) for matrix subtraction.
  */
-SquareMat operator-(const SquareMat& other) const;
+BasicSquareMat operator-(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the unary minus operator (-) for negation.
  */
-SquareMat operator-() const;
+BasicSquareMat operator-() const;
 
 /**
  * @brief Overloads the subscript operator [] for accessing rows (non-const version).
  */
-double* operator[](int row);
+T* operator[](int row);
 
 /**
  * @brief Overloads the subscript operator [] for accessing rows (const version).
  */
-const double* operator[](int row) const;
+const T* operator[](int row) const;
 /**
  * @brief Overloads the equality operator (==) for comparing two matrices.
  */
-bool operator==(const SquareMat& other) const;
+bool operator==(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the inequality operator (!=) for comparing two matrices.
  */
-bool operator!=(const SquareMat& other) const;
+bool operator!=(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the multiplication operator (*) for matrix multiplication.
  */
-SquareMat operator*(const SquareMat& other) const;
+BasicSquareMat operator*(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the multiplication operator (*) for scalar multiplication (matrix * scalar).
  */
-SquareMat operator*(double scalar) const;
+BasicSquareMat operator*(T scalar) const;
 
 friend /**
  * @brief Overloads the multiplication operator (*) for scalar multiplication (scalar * matrix).
  */
-SquareMat operator*(double scalar, const SquareMat& matrix);
+BasicSquareMat operator*(T scalar, const BasicSquareMat& matrix) {
+    return matrix * scalar; // Reuse the member operator for efficiency.
+}
 
 /**
  * @brief Overloads the modulo operator (%) for element-wise matrix multiplication.
  */
-SquareMat operator%(const SquareMat& other) const;
+BasicSquareMat operator%(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the modulo operator (%) for scalar modulo (matrix % scalar).
  */
-SquareMat operator%(double scalar) const;
+BasicSquareMat operator%(T scalar) const;
 
 /**
  * @brief Overloads the division operator (/) for scalar division (matrix / scalar).
  */
-SquareMat operator/(double scalar) const;
+BasicSquareMat operator/(T scalar) const;
 
 /**
  * @brief Overloads the bitwise XOR operator (^) for matrix exponentiation (simple implementation).
  */
-SquareMat operator^(int exponent) const;
+BasicSquareMat operator^(int exponent) const;
 
 /**
  * @brief Overloads the pre-increment operator (++mat).
  */
-SquareMat& operator++();
+BasicSquareMat& operator++();
 
 /**
  * @brief Overloads the pre-decrement operator (--mat).
  */
-SquareMat& operator--();
+BasicSquareMat& operator--();
 
 /**
  * @brief Overloads the post-increment operator (mat++).
  */
-SquareMat operator++(int);
+BasicSquareMat operator++(int);
 
 /**
  * @brief Overloads the post-decrement operator (mat--).
  */
-SquareMat operator--(int);
+BasicSquareMat operator--(int);
 
 /**
  * @brief Overloads the bitwise NOT operator (~) for matrix transpose.
  */
-SquareMat operator~() const;
+BasicSquareMat operator~() const;
 
 /**
  * @brief Overloads the less than operator (<) to compare the sum of elements of two matrices.
  */
-bool operator<(const SquareMat& other) const;
+bool operator<(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the greater than operator (>) to compare the sum of elements of two matrices.
  */
-bool operator>(const SquareMat& other) const;
+bool operator>(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the less than or equal to operator (<=) to compare the sum of elements of two matrices.
  */
-bool operator<=(const SquareMat& other) const;
+bool operator<=(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the greater than or equal to operator (>=) to compare the sum of elements of two matrices.
  */
-bool operator>=(const SquareMat& other) const;
+bool operator>=(const BasicSquareMat& other) const;
 
 /**
  * @brief Overloads the logical NOT operator (!) to calculate the determinant of the matrix.
  */
-double operator!() const;
+T operator!() const;
+
+/**
+ * @brief Calculates the determinant as (sign, log |det|) from an LU factorization, which
+ * neither overflows nor underflows whatever the size: use it where operator! returns inf
+ * or 0. Large matrices are factored in parallel, and the cached factorization is used (or,
+ * with setFactorCaching(), filled) like operator!. SquareMat (double) only.
+ */
+LogDeterminant logAbsDet() const;
+
+/**
+ * @brief Calculates the inverse of the matrix through an LU factorization.
+ * Throws std::invalid_argument if the matrix is singular. SquareMat (double) only.
+ */
+BasicSquareMat inverse() const;
+
+/**
+ * @brief Gets the LU factorization of the matrix, computing and caching it on first use.
+ *
+ * The cache is dropped by every mutation (set, non-const operator[], ++, -- and the
+ * compound assignments); a row pointer obtained from operator[] before the call must
+ * not be written through afterwards. Not safe to call concurrently on one matrix.
+ * SquareMat (double) only.
+ */
+const LUDecomposition& getLU() const;
+
+/**
+ * @brief Returns true if a factorization is currently cached.
+ */
+bool hasCachedFactorization() const;
+
+/**
+ * @brief When enabled, operator! and inverse() cache the factorization they compute,
+ * so repeated calls on an unchanged matrix cost O(n^2) instead of O(n^3). The setting
+ * travels with the elements: a copy, by construction or assignment, takes the setting of
+ * its source (but never its cached factorization).
+ */
+void setFactorCaching(bool enabled);
 
 /**
  * @brief Overloads the compound addition assignment operator (+=).
  */
-SquareMat& operator+=(const SquareMat& other);
+BasicSquareMat& operator+=(const BasicSquareMat& other);
 
 /**
  * @brief Overloads the compound subtraction assignment operator (-=).
  */
-SquareMat& operator-=(const SquareMat& other);
+BasicSquareMat& operator-=(const BasicSquareMat& other);
 
 /**
  * @brief Overloads the compound multiplication assignment operator (*=) for matrix multiplication.
  */
-SquareMat& operator*=(const SquareMat& other);
+BasicSquareMat& operator*=(const BasicSquareMat& other);
 
 /**
  * @brief Overloads the compound division assignment operator (/=) for scalar division.
  */
-SquareMat& operator/=(double scalar);
+BasicSquareMat& operator/=(T scalar);
 
 /**
  * @brief Overloads the compound modulo assignment operator (%=) for scalar modulo.
  */
- SquareMat& operator%=(double scalar);
-
-friend std::ostream& operator<<(std::ostream& os, const SquareMat& matrix);
+ BasicSquareMat& operator%=(T scalar);
 };
+
+/**
+ * @brief The double-precision matrix used throughout the library.
+ */
+typedef BasicSquareMat<double> SquareMat;
+
+template <> LogDeterminant BasicSquareMat<double>::logAbsDet() const;
+template <> BasicSquareMat<double> BasicSquareMat<double>::inverse() const;
+template <> const LUDecomposition& BasicSquareMat<double>::getLU() const;
+template <> double BasicSquareMat<double>::largeDeterminant() const;
+
+/**
+ * @brief Computes C = alpha * A * B + beta * C in place, in one pass over C and without
+ * temporaries: C += A * B is gemm(1, A, B, 1, C) and C -= A * B is gemm(-1, A, B, 1, C).
+ *
+ * As in BLAS, beta = 0 overwrites C without reading it. If C is A or B the product is
+ * computed into a temporary first.
+ */
+template <typename T>
+void gemm(T alpha, const BasicSquareMat<T>& a, const BasicSquareMat<T>& b, T beta, BasicSquareMat<T>& c);
+
+/**
+ * @brief Overloads the output stream operator (<<) for the matrix classes.
+ */
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const BasicSquareMat<T>& matrix);
+
 } // namespace matrix
 
 #endif // SQUARE_MAT_HPP
\ No newline at end of file
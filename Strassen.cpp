@@ -0,0 +1,196 @@
+#include "Strassen.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace matrix {
+
+namespace {
+
+// Elements of workspace the recursion needs below size n: two half-size temporaries per level.
+size_t workspaceSize(int n, int crossover) {
+    size_t total = 0;
+    while (n > crossover) {
+        if (n % 2 == 1) {
+            --n;
+        }
+        n /= 2;
+        total += 2 * static_cast<size_t>(n) * n;
+    }
+    return total;
+}
+
+// z = x + y on n x n blocks with leading dimensions (row strides) ldz, ldx, ldy.
+template <typename T>
+void add(T* z, int ldz, const T* x, int ldx, const T* y, int ldy, int n) {
+    for (int i = 0; i < n; ++i) {
+        T* out = z + static_cast<size_t>(i) * ldz;
+        const T* a = x + static_cast<size_t>(i) * ldx;
+        const T* b = y + static_cast<size_t>(i) * ldy;
+        for (int j = 0; j < n; ++j) {
+            out[j] = a[j] + b[j];
+        }
+    }
+}
+
+// z = x - y on n x n blocks.
+template <typename T>
+void subtract(T* z, int ldz, const T* x, int ldx, const T* y, int ldy, int n) {
+    for (int i = 0; i < n; ++i) {
+        T* out = z + static_cast<size_t>(i) * ldz;
+        const T* a = x + static_cast<size_t>(i) * ldx;
+        const T* b = y + static_cast<size_t>(i) * ldy;
+        for (int j = 0; j < n; ++j) {
+            out[j] = a[j] - b[j];
+        }
+    }
+}
+
+// c = a * b with the classical i-k-j kernel.
+template <typename T>
+void multiplyClassical(const T* a, int lda, const T* b, int ldb, T* c, int ldc, int n) {
+    for (int i = 0; i < n; ++i) {
+        T* out = c + static_cast<size_t>(i) * ldc;
+        std::fill(out, out + n, T());
+        const T* row = a + static_cast<size_t>(i) * lda;
+        for (int k = 0; k < n; ++k) {
+            const T scale = row[k];
+            const T* right = b + static_cast<size_t>(k) * ldb;
+            for (int j = 0; j < n; ++j) {
+                out[j] += scale * right[j];
+            }
+        }
+    }
+}
+
+// c = a * b on n x n blocks, work holding workspaceSize(n, crossover) elements.
+template <typename T>
+void multiplyRecursive(const T* a, int lda, const T* b, int ldb, T* c, int ldc, int n, int crossover, T* work) {
+    if (n <= crossover) {
+        multiplyClassical(a, lda, b, ldb, c, ldc, n);
+        return;
+    }
+    if (n % 2 == 1) {
+        // Dynamic peeling: multiply the even leading block recursively, then add the
+        // contributions of the last row and column of A and B directly.
+        const int m = n - 1;
+        multiplyRecursive(a, lda, b, ldb, c, ldc, m, crossover, work);
+        const T* aLastRow = a + static_cast<size_t>(m) * lda;
+        const T* bLastRow = b + static_cast<size_t>(m) * ldb;
+        T* cLastRow = c + static_cast<size_t>(m) * ldc;
+        // C11 += a12 * b21 (rank one), c12 = A11 * b12 + a12 * b22.
+        for (int i = 0; i < m; ++i) {
+            const T* row = a + static_cast<size_t>(i) * lda;
+            T* out = c + static_cast<size_t>(i) * ldc;
+            const T lastColumn = row[m];
+            for (int j = 0; j < m; ++j) {
+                out[j] += lastColumn * bLastRow[j];
+            }
+            T sum = T();
+            for (int k = 0; k < n; ++k) {
+                sum += row[k] * b[static_cast<size_t>(k) * ldb + m];
+            }
+            out[m] = sum;
+        }
+        // c21 = a21 * B11 + a22 * b21, c22 = a21 * b12 + a22 * b22.
+        std::fill(cLastRow, cLastRow + n, T());
+        for (int k = 0; k < n; ++k) {
+            const T scale = aLastRow[k];
+            const T* right = b + static_cast<size_t>(k) * ldb;
+            for (int j = 0; j < n; ++j) {
+                cLastRow[j] += scale * right[j];
+            }
+        }
+        return;
+    }
+
+    const int h = n / 2;
+    const T* a11 = a;
+    const T* a12 = a + h;
+    const T* a21 = a + static_cast<size_t>(h) * lda;
+    const T* a22 = a21 + h;
+    const T* b11 = b;
+    const T* b12 = b + h;
+    const T* b21 = b + static_cast<size_t>(h) * ldb;
+    const T* b22 = b21 + h;
+    T* c11 = c;
+    T* c12 = c + h;
+    T* c21 = c + static_cast<size_t>(h) * ldc;
+    T* c22 = c21 + h;
+    T* x = work;
+    T* y = work + static_cast<size_t>(h) * h;
+    T* deeper = y + static_cast<size_t>(h) * h;
+
+    // Winograd's schedule with two temporaries, the quadrants of C holding the rest.
+    subtract(x, h, a11, lda, a21, lda, h);                        // S3 = A11 - A21
+    subtract(y, h, b22, ldb, b12, ldb, h);                        // T3 = B22 - B12
+    multiplyRecursive(x, h, y, h, c21, ldc, h, crossover, deeper); // P7 = S3 * T3
+    add(x, h, a21, lda, a22, lda, h);                             // S1 = A21 + A22
+    subtract(y, h, b12, ldb, b11, ldb, h);                        // T1 = B12 - B11
+    multiplyRecursive(x, h, y, h, c22, ldc, h, crossover, deeper); // P5 = S1 * T1
+    subtract(x, h, x, h, a11, lda, h);                            // S2 = S1 - A11
+    subtract(y, h, b22, ldb, y, h, h);                            // T2 = B22 - T1
+    multiplyRecursive(x, h, y, h, c12, ldc, h, crossover, deeper); // P6 = S2 * T2
+    subtract(x, h, a12, lda, x, h, h);                            // S4 = A12 - S2
+    multiplyRecursive(x, h, b22, ldb, c11, ldc, h, crossover, deeper); // P3 = S4 * B22
+    multiplyRecursive(a11, lda, b11, ldb, x, h, h, crossover, deeper); // P1 = A11 * B11
+    add(c12, ldc, x, h, c12, ldc, h);                             // U2 = P1 + P6
+    add(c21, ldc, c12, ldc, c21, ldc, h);                         // U3 = U2 + P7
+    add(c12, ldc, c12, ldc, c22, ldc, h);                         // U4 = U2 + P5
+    add(c22, ldc, c21, ldc, c22, ldc, h);                         // U7 = U3 + P5 = C22
+    add(c12, ldc, c12, ldc, c11, ldc, h);                         // U5 = U4 + P3 = C12
+    subtract(y, h, y, h, b21, ldb, h);                            // T4 = T2 - B21
+    multiplyRecursive(a22, lda, y, h, c11, ldc, h, crossover, deeper); // P4 = A22 * T4
+    subtract(c21, ldc, c21, ldc, c11, ldc, h);                    // U6 = U3 - P4 = C21
+    multiplyRecursive(a12, lda, b21, ldb, c11, ldc, h, crossover, deeper); // P2 = A12 * B21
+    add(c11, ldc, x, h, c11, ldc, h);                             // U1 = P1 + P2 = C11
+}
+
+} // namespace
+
+// Multiplies two matrices with the Strassen-Winograd algorithm.
+template <typename T>
+BasicSquareMat<T> multiplyStrassen(const BasicSquareMat<T>& left, const BasicSquareMat<T>& right, int crossover) {
+    BasicSquareMat<T> result(left.getSize());
+    multiplyStrassen(left, right, result, crossover);
+    return result;
+}
+
+// Multiplies two matrices with the Strassen-Winograd algorithm into result.
+template <typename T>
+void multiplyStrassen(const BasicSquareMat<T>& left, const BasicSquareMat<T>& right, BasicSquareMat<T>& result,
+                      int crossover) {
+    const int n = left.getSize();
+    if (right.getSize() != n || result.getSize() != n) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    if (crossover < 1) {
+        throw std::invalid_argument("Crossover must be a positive integer.");
+    }
+    if (&result == &left || &result == &right) {
+        throw std::invalid_argument("Result must not be an operand.");
+    }
+    // Each matrix is one block with a row stride of n, as the recursion addresses its quadrants.
+    std::vector<T> work(workspaceSize(n, crossover));
+    multiplyRecursive(left[0], n, right[0], n, result[0], n, n, crossover, work.data());
+}
+
+template BasicSquareMat<float> multiplyStrassen(const BasicSquareMat<float>&, const BasicSquareMat<float>&, int);
+template BasicSquareMat<double> multiplyStrassen(const BasicSquareMat<double>&, const BasicSquareMat<double>&, int);
+template BasicSquareMat<std::int32_t> multiplyStrassen(const BasicSquareMat<std::int32_t>&,
+                                                       const BasicSquareMat<std::int32_t>&, int);
+template BasicSquareMat<std::int64_t> multiplyStrassen(const BasicSquareMat<std::int64_t>&,
+                                                       const BasicSquareMat<std::int64_t>&, int);
+template BasicSquareMat<std::complex<double>> multiplyStrassen(const BasicSquareMat<std::complex<double>>&,
+                                                               const BasicSquareMat<std::complex<double>>&, int);
+template void multiplyStrassen(const BasicSquareMat<float>&, const BasicSquareMat<float>&, BasicSquareMat<float>&, int);
+template void multiplyStrassen(const BasicSquareMat<double>&, const BasicSquareMat<double>&, BasicSquareMat<double>&,
+                               int);
+template void multiplyStrassen(const BasicSquareMat<std::int32_t>&, const BasicSquareMat<std::int32_t>&,
+                               BasicSquareMat<std::int32_t>&, int);
+template void multiplyStrassen(const BasicSquareMat<std::int64_t>&, const BasicSquareMat<std::int64_t>&,
+                               BasicSquareMat<std::int64_t>&, int);
+template void multiplyStrassen(const BasicSquareMat<std::complex<double>>&, const BasicSquareMat<std::complex<double>>&,
+                               BasicSquareMat<std::complex<double>>&, int);
+
+} // namespace matrix
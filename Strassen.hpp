@@ -0,0 +1,39 @@
+#ifndef STRASSEN_HPP
+#define STRASSEN_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * @brief Default size at or below which multiplyStrassen() switches to the classical product.
+ */
+const int STRASSEN_CROSSOVER = 128;
+
+/**
+ * @brief Multiplies two matrices with the Strassen-Winograd algorithm: 7 half-size products
+ * and 15 additions per level instead of 8 products, O(n^2.81) overall.
+ *
+ * The recursion stops at crossover and uses the classical i-k-j kernel below. Odd sizes
+ * peel off the last row and column (fixed up with O(n^2) work) instead of padding to a
+ * power of two, and all the temporaries of every level come from one workspace
+ * allocated up front (about 2/3 n^2 elements). The error bound is weaker than the
+ * classical one (it grows with the depth of the recursion, relative to max|A| max|B|
+ * instead of elementwise), integer products are exact.
+ */
+template <typename T>
+BasicSquareMat<T> multiplyStrassen(const BasicSquareMat<T>& left, const BasicSquareMat<T>& right,
+                                   int crossover = STRASSEN_CROSSOVER);
+
+/**
+ * @brief Multiplies two matrices with the Strassen-Winograd algorithm into result, which
+ * must have their size and is overwritten; the recursion runs directly on the contiguous
+ * storage of the three matrices. Throws std::invalid_argument if result is an operand.
+ */
+template <typename T>
+void multiplyStrassen(const BasicSquareMat<T>& left, const BasicSquareMat<T>& right, BasicSquareMat<T>& result,
+                      int crossover = STRASSEN_CROSSOVER);
+
+} // namespace matrix
+
+#endif // STRASSEN_HPP
@@ -0,0 +1,448 @@
+#include "StructuredMat.hpp"
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace matrix {
+
+// Private helper function to get the number of stored elements.
+int StructuredMat::storageSize(Structure structure, int size, int bandwidth) {
+    switch (structure) {
+    case Structure::Diagonal:
+        return size;
+    case Structure::Banded:
+        return size * (2 * bandwidth + 1);
+    default:
+        return size * (size + 1) / 2;
+    }
+}
+
+// Private helper function to map (row, col) to its position in data.
+int StructuredMat::index(int row, int col) const {
+    switch (structure) {
+    case Structure::Diagonal:
+        return row == col ? row : -1;
+    case Structure::Banded:
+        if (col < row - bandwidth || col > row + bandwidth) {
+            return -1;
+        }
+        return row * (2 * bandwidth + 1) + (col - row + bandwidth);
+    case Structure::LowerTriangular:
+        return col <= row ? row * (row + 1) / 2 + col : -1;
+    case Structure::UpperTriangular:
+        // Row i starts after the i previous rows of lengths n, n - 1, ..., n - i + 1.
+        return col >= row ? row * size - row * (row - 1) / 2 + (col - row) : -1;
+    case Structure::Symmetric:
+        if (col > row) {
+            std::swap(row, col);
+        }
+        return row * (row + 1) / 2 + col;
+    }
+    return -1;
+}
+
+// Private helper function to get the columns of a row that may be non-zero.
+void StructuredMat::rowRange(int row, int& begin, int& end) const {
+    switch (structure) {
+    case Structure::Diagonal:
+        begin = row;
+        end = row + 1;
+        break;
+    case Structure::Banded:
+        begin = std::max(0, row - bandwidth);
+        end = std::min(size, row + bandwidth + 1);
+        break;
+    case Structure::LowerTriangular:
+        begin = 0;
+        end = row + 1;
+        break;
+    case Structure::UpperTriangular:
+        begin = row;
+        end = size;
+        break;
+    case Structure::Symmetric:
+        begin = 0;
+        end = size;
+        break;
+    }
+}
+
+// Private helper function to get the first stored element of a row.
+const double* StructuredMat::rowData(int row) const {
+    int begin = 0;
+    int end = 0;
+    rowRange(row, begin, end);
+    return data + index(row, begin);
+}
+
+// Constructor that creates a zero matrix of the given structure.
+StructuredMat::StructuredMat(Structure structure, int size, int bandwidth)
+    : structure(structure), size(size), bandwidth(0), data(nullptr) {
+    if (size <= 0) {
+        throw std::invalid_argument("Matrix size must be a positive integer.");
+    }
+    if (structure == Structure::Banded) {
+        if (bandwidth < 0 || bandwidth >= size) {
+            throw std::invalid_argument("Bandwidth must be in the range [0, size).");
+        }
+        this->bandwidth = bandwidth;
+    }
+    int count = storageSize(structure, size, this->bandwidth);
+    data = new double[count];
+    for (int i = 0; i < count; ++i) {
+        data[i] = 0.0;
+    }
+}
+
+// Copy constructor
+StructuredMat::StructuredMat(const StructuredMat& other)
+    : structure(other.structure), size(other.size), bandwidth(other.bandwidth), data(nullptr) {
+    int count = getStoredCount();
+    data = new double[count];
+    for (int i = 0; i < count; ++i) {
+        data[i] = other.data[i];
+    }
+}
+
+// Assignment operator
+StructuredMat& StructuredMat::operator=(const StructuredMat& other) {
+    if (this == &other) {
+        return *this;
+    }
+    int count = other.getStoredCount();
+    if (getStoredCount() != count) {
+        delete[] data;
+        data = nullptr;
+        data = new double[count];
+    }
+    structure = other.structure;
+    size = other.size;
+    bandwidth = other.bandwidth;
+    for (int i = 0; i < count; ++i) {
+        data[i] = other.data[i];
+    }
+    return *this;
+}
+
+// Destructor
+StructuredMat::~StructuredMat() {
+    delete[] data;
+    data = nullptr;
+}
+
+// Converts a dense matrix, validating that it has the requested structure.
+StructuredMat StructuredMat::fromDense(const SquareMat& matrix, Structure structure, int bandwidth) {
+    StructuredMat result(structure, matrix.getSize(), bandwidth);
+    int n = result.size;
+    for (int i = 0; i < n; ++i) {
+        const double* row = matrix[i];
+        for (int j = 0; j < n; ++j) {
+            int position = result.index(i, j);
+            if (position < 0) {
+                if (row[j] != 0.0) {
+                    throw std::invalid_argument("Matrix has non-zero elements outside the requested structure.");
+                }
+            } else if (structure == Structure::Symmetric && j > i) {
+                if (row[j] != matrix[j][i]) {
+                    throw std::invalid_argument("Matrix is not symmetric.");
+                }
+            } else {
+                result.data[position] = row[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Converts the matrix to a dense SquareMat.
+SquareMat StructuredMat::toDense() const {
+    SquareMat result(size);
+    for (int i = 0; i < size; ++i) {
+        double* row = result[i];
+        int begin = 0;
+        int end = 0;
+        rowRange(i, begin, end);
+        for (int j = begin; j < end; ++j) {
+            row[j] = data[index(i, j)];
+        }
+    }
+    return result;
+}
+
+// Method to get the structure of the matrix
+Structure StructuredMat::getStructure() const {
+    return structure;
+}
+
+// Method to get the size of the matrix
+int StructuredMat::getSize() const {
+    return size;
+}
+
+// Method to get the bandwidth of the matrix
+int StructuredMat::getBandwidth() const {
+    return bandwidth;
+}
+
+// Method to get the number of stored elements
+int StructuredMat::getStoredCount() const {
+    return storageSize(structure, size, bandwidth);
+}
+
+// Method to get the value of a matrix element
+double StructuredMat::get(int row, int col) const {
+    if (row < 0 || row >= size || col < 0 || col >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    int position = index(row, col);
+    return position < 0 ? 0.0 : data[position];
+}
+
+// Method to set the value of a matrix element
+void StructuredMat::set(int row, int col, double value) {
+    if (row < 0 || row >= size || col < 0 || col >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    int position = index(row, col);
+    if (position < 0) {
+        if (value != 0.0) {
+            throw std::invalid_argument("Cannot set a non-zero element outside the matrix structure.");
+        }
+        return;
+    }
+    data[position] = value;
+}
+
+// Multiplies by a dense matrix: result row i is the combination of the rows of
+// other selected by the stored elements of row i.
+SquareMat StructuredMat::operator*(const SquareMat& other) const {
+    if (size != other.getSize()) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    SquareMat result(size);
+    multiplyInto(other, result);
+    return result;
+}
+
+// Multiplies a dense matrix by a structured one.
+SquareMat operator*(const SquareMat& matrix, const StructuredMat& structured) {
+    if (matrix.getSize() != structured.size) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    SquareMat result(structured.size);
+    structured.multiplyLeftInto(matrix, result);
+    return result;
+}
+
+// Computes this * other into result.
+void StructuredMat::multiplyInto(const SquareMat& other, SquareMat& result) const {
+    if (size != other.getSize() || size != result.getSize()) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    for (int i = 0; i < size; ++i) {
+        double* out = result[i];
+        std::fill(out, out + size, 0.0);
+        int begin = 0;
+        int end = 0;
+        rowRange(i, begin, end);
+        const double* stored = structure == Structure::Symmetric ? nullptr : rowData(i);
+        for (int k = begin; k < end; ++k) {
+            const double a = stored ? stored[k - begin] : data[index(i, k)];
+            if (a == 0.0) {
+                continue;
+            }
+            const double* right = other[k];
+            for (int j = 0; j < size; ++j) {
+                out[j] += a * right[j];
+            }
+        }
+    }
+}
+
+// Computes matrix * this into result: result row i accumulates matrix[i][k] times
+// the stored part of row k.
+void StructuredMat::multiplyLeftInto(const SquareMat& matrix, SquareMat& result) const {
+    if (size != matrix.getSize() || size != result.getSize()) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    for (int i = 0; i < size; ++i) {
+        double* out = result[i];
+        std::fill(out, out + size, 0.0);
+        const double* left = matrix[i];
+        for (int k = 0; k < size; ++k) {
+            const double a = left[k];
+            if (a == 0.0) {
+                continue;
+            }
+            int begin = 0;
+            int end = 0;
+            rowRange(k, begin, end);
+            if (structure == Structure::Symmetric) {
+                for (int j = begin; j < end; ++j) {
+                    out[j] += a * data[index(k, j)];
+                }
+            } else {
+                const double* stored = rowData(k) - begin;
+                for (int j = begin; j < end; ++j) {
+                    out[j] += a * stored[j];
+                }
+            }
+        }
+    }
+}
+
+// Gets the structure of a product of two structured matrices.
+bool StructuredMat::productStructure(Structure left, int leftBandwidth, Structure right, int rightBandwidth,
+                                     int size, Structure& structure, int& bandwidth) {
+    if (left == Structure::Symmetric || right == Structure::Symmetric) {
+        return false;
+    }
+    bandwidth = 0;
+    if (left == Structure::Diagonal || right == Structure::Diagonal) {
+        structure = left == Structure::Diagonal ? right : left;
+        bandwidth = left == Structure::Diagonal ? rightBandwidth : leftBandwidth;
+        return true;
+    }
+    if (left == Structure::Banded && right == Structure::Banded) {
+        structure = Structure::Banded;
+        bandwidth = leftBandwidth + rightBandwidth;
+        return 2 * bandwidth + 1 <= size;
+    }
+    if (left == right) {
+        structure = left;
+        return true;
+    }
+    return false;
+}
+
+// Multiplies two structured matrices: row i of the product combines the stored rows of
+// other selected by the stored elements of row i, all inside the product's row range.
+StructuredMat StructuredMat::multiplyStructured(const StructuredMat& other) const {
+    if (size != other.size) {
+        throw std::invalid_argument("Matrices must have the same size for multiplication.");
+    }
+    Structure productKind = Structure::Diagonal;
+    int productBandwidth = 0;
+    if (!productStructure(structure, bandwidth, other.structure, other.bandwidth, size,
+                          productKind, productBandwidth)) {
+        throw std::invalid_argument("The product of these structures has no structure.");
+    }
+    StructuredMat result(productKind, size, productBandwidth);
+    for (int i = 0; i < size; ++i) {
+        int begin = 0;
+        int end = 0;
+        rowRange(i, begin, end);
+        const double* stored = rowData(i) - begin;
+        int outBegin = 0;
+        int outEnd = 0;
+        result.rowRange(i, outBegin, outEnd);
+        double* out = result.data + result.index(i, outBegin) - outBegin;
+        for (int k = begin; k < end; ++k) {
+            const double a = stored[k];
+            if (a == 0.0) {
+                continue;
+            }
+            int rowBegin = 0;
+            int rowEnd = 0;
+            other.rowRange(k, rowBegin, rowEnd);
+            const double* right = other.rowData(k) - rowBegin;
+            for (int j = rowBegin; j < rowEnd; ++j) {
+                out[j] += a * right[j];
+            }
+        }
+    }
+    return result;
+}
+
+// Overloads the bitwise NOT operator (~) for transpose.
+StructuredMat StructuredMat::operator~() const {
+    Structure transposed = structure;
+    if (structure == Structure::LowerTriangular) {
+        transposed = Structure::UpperTriangular;
+    } else if (structure == Structure::UpperTriangular) {
+        transposed = Structure::LowerTriangular;
+    }
+    if (transposed == structure && structure != Structure::Banded) {
+        return *this; // Diagonal and symmetric matrices are their own transpose.
+    }
+    StructuredMat result(transposed, size, bandwidth);
+    for (int i = 0; i < size; ++i) {
+        int begin = 0;
+        int end = 0;
+        rowRange(i, begin, end);
+        for (int j = begin; j < end; ++j) {
+            result.data[result.index(j, i)] = data[index(i, j)];
+        }
+    }
+    return result;
+}
+
+// Overloads the logical NOT operator (!) to calculate the determinant.
+double StructuredMat::operator!() const {
+    if (structure == Structure::Symmetric) {
+        return !toDense();
+    }
+    if (structure != Structure::Banded || bandwidth == 0) {
+        // Diagonal and triangular: the product of the diagonal.
+        double det = 1.0;
+        for (int i = 0; i < size; ++i) {
+            det *= data[index(i, i)];
+        }
+        return det;
+    }
+    // Banded: Gaussian elimination with partial pivoting. Row swaps can grow the
+    // upper bandwidth up to 2 * bandwidth, so each work row holds the columns
+    // [row - bandwidth, row + 2 * bandwidth].
+    const int width = 3 * bandwidth + 1;
+    std::vector<double> work(static_cast<size_t>(size) * width, 0.0);
+    auto at = [&](int row, int col) -> double& {
+        return work[static_cast<size_t>(row) * width + (col - row + bandwidth)];
+    };
+    for (int i = 0; i < size; ++i) {
+        int begin = 0;
+        int end = 0;
+        rowRange(i, begin, end);
+        for (int j = begin; j < end; ++j) {
+            at(i, j) = data[index(i, j)];
+        }
+    }
+    double det = 1.0;
+    for (int k = 0; k < size; ++k) {
+        int lastRow = std::min(size - 1, k + bandwidth);
+        int lastCol = std::min(size - 1, k + 2 * bandwidth);
+        int pivot = k;
+        for (int i = k + 1; i <= lastRow; ++i) {
+            if (std::fabs(at(i, k)) > std::fabs(at(pivot, k))) {
+                pivot = i;
+            }
+        }
+        if (at(pivot, k) == 0.0) {
+            return 0.0;
+        }
+        if (pivot != k) {
+            for (int j = k; j <= lastCol; ++j) {
+                std::swap(at(k, j), at(pivot, j));
+            }
+            det = -det;
+        }
+        det *= at(k, k);
+        for (int i = k + 1; i <= lastRow; ++i) {
+            double factor = at(i, k) / at(k, k);
+            if (factor == 0.0) {
+                continue;
+            }
+            for (int j = k; j <= lastCol; ++j) {
+                at(i, j) -= factor * at(k, j);
+            }
+        }
+    }
+    return det;
+}
+
+// Overloads the output stream operator (<<) for the StructuredMat class.
+std::ostream& operator<<(std::ostream& os, const StructuredMat& matrix) {
+    return os << matrix.toDense();
+}
+
+} // namespace matrix
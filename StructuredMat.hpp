@@ -0,0 +1,177 @@
+#ifndef STRUCTURED_MAT_HPP
+#define STRUCTURED_MAT_HPP
+
+#include "SquareMat.hpp"
+
+namespace matrix {
+
+/**
+ * @brief The sparsity structure of a StructuredMat.
+ */
+enum class Structure {
+    Diagonal,        // Only the main diagonal, n elements.
+    Banded,          // |row - col| <= bandwidth, n * (2 * bandwidth + 1) elements.
+    LowerTriangular, // col <= row, packed n * (n + 1) / 2 elements.
+    UpperTriangular, // col >= row, packed n * (n + 1) / 2 elements.
+    Symmetric        // Lower triangle of a symmetric matrix, packed n * (n + 1) / 2 elements.
+};
+
+/**
+ * @brief Represents a square matrix with a known structure, storing only the elements
+ * the structure allows to be non-zero.
+ *
+ * Every stored row is contiguous (except for the mirrored upper part of a symmetric
+ * matrix), so the products with a dense SquareMat only touch the stored elements:
+ * diagonal x dense is O(n^2), banded x dense is O(n^2 * bandwidth) and triangular x
+ * dense does half of the dense work.
+ */
+class StructuredMat {
+private:
+    Structure structure;
+    int size;
+    int bandwidth;
+    double* data;
+
+    /**
+     * @brief Number of elements stored for the given structure.
+     */
+    static int storageSize(Structure structure, int size, int bandwidth);
+
+    /**
+     * @brief Index of the element in data, or -1 if it is a structural zero.
+     */
+    int index(int row, int col) const;
+
+    /**
+     * @brief Gets the half-open column range [begin, end) that may be non-zero in a row.
+     */
+    void rowRange(int row, int& begin, int& end) const;
+
+    /**
+     * @brief Pointer to the stored element (row, begin of the row range).
+     * Not valid for symmetric matrices, whose rows are not stored contiguously.
+     */
+    const double* rowData(int row) const;
+
+public:
+/**
+ * @brief Constructor that creates a zero matrix of the given structure.
+ * The bandwidth is only used by Structure::Banded.
+ */
+StructuredMat(Structure structure, int size, int bandwidth = 0);
+
+/**
+ * @brief Copy constructor for the StructuredMat class.
+ */
+StructuredMat(const StructuredMat& other);
+
+/**
+ * @brief Assignment operator for the StructuredMat class.
+ */
+StructuredMat& operator=(const StructuredMat& other);
+
+/**
+ * @brief Destructor for the StructuredMat class.
+ */
+~StructuredMat();
+
+/**
+ * @brief Converts a dense matrix, throwing if it has non-zeros outside the structure
+ * (or, for Structure::Symmetric, if it is not symmetric).
+ */
+static StructuredMat fromDense(const SquareMat& matrix, Structure structure, int bandwidth = 0);
+
+/**
+ * @brief Converts the matrix to a dense SquareMat.
+ */
+SquareMat toDense() const;
+
+/**
+ * @brief Gets the structure of the matrix.
+ */
+Structure getStructure() const;
+
+/**
+ * @brief Gets the size (dimension) of the matrix.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the bandwidth of a banded matrix (0 for the other structures).
+ */
+int getBandwidth() const;
+
+/**
+ * @brief Gets the number of stored elements.
+ */
+int getStoredCount() const;
+
+/**
+ * @brief Gets the value of the element at the specified row and column.
+ */
+double get(int row, int col) const;
+
+/**
+ * @brief Sets the value of the element at the specified row and column.
+ * Setting a non-zero outside the structure throws std::invalid_argument.
+ * For a symmetric matrix, (row, col) and (col, row) are set together.
+ */
+void set(int row, int col, double value);
+
+/**
+ * @brief Multiplies by a dense matrix (structured * dense), touching only stored elements.
+ */
+SquareMat operator*(const SquareMat& other) const;
+
+/**
+ * @brief Multiplies a dense matrix by a structured one (dense * structured).
+ */
+friend SquareMat operator*(const SquareMat& matrix, const StructuredMat& structured);
+
+/**
+ * @brief Computes result = this * other into an existing matrix of the same size, without
+ * allocating.
+ */
+void multiplyInto(const SquareMat& other, SquareMat& result) const;
+
+/**
+ * @brief Computes result = matrix * this into an existing matrix of the same size, without
+ * allocating.
+ */
+void multiplyLeftInto(const SquareMat& matrix, SquareMat& result) const;
+
+/**
+ * @brief Gets the structure of the product of a left and a right operand of the given
+ * structures. Returns false if the product has no structure, or one that would store more
+ * elements than a dense matrix: diagonal and banded products are banded (bandwidths add),
+ * triangular products of the same orientation stay triangular and a diagonal factor keeps
+ * the structure of the other one, except for symmetric matrices.
+ */
+static bool productStructure(Structure left, int leftBandwidth, Structure right, int rightBandwidth,
+                             int size, Structure& structure, int& bandwidth);
+
+/**
+ * @brief Multiplies two structured matrices into the structure given by productStructure(),
+ * touching only stored elements. Throws std::invalid_argument if the product has no structure.
+ */
+StructuredMat multiplyStructured(const StructuredMat& other) const;
+
+/**
+ * @brief Overloads the bitwise NOT operator (~) for transpose.
+ * Triangular matrices swap between lower and upper.
+ */
+StructuredMat operator~() const;
+
+/**
+ * @brief Overloads the logical NOT operator (!) to calculate the determinant.
+ * Diagonal and triangular matrices use the product of the diagonal, banded matrices
+ * an O(n * bandwidth^2) elimination.
+ */
+double operator!() const;
+
+friend std::ostream& operator<<(std::ostream& os, const StructuredMat& matrix);
+};
+
+} // namespace matrix
+
+#endif // STRUCTURED_MAT_HPP
@@ -0,0 +1,262 @@
+#include "TaskScheduler.hpp"
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+// The scheduler and worker index of the calling thread, set by each worker at start.
+thread_local const TaskScheduler* threadScheduler = nullptr;
+thread_local int threadWorker = -1;
+} // namespace
+
+// Constructor that starts the worker threads.
+TaskScheduler::TaskScheduler(int threadCount) : queued(0), stopping(false), nextWorker(0) {
+    if (threadCount < 0) {
+        throw std::invalid_argument("Thread count must be a non-negative integer.");
+    }
+    if (threadCount == 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount == 0) {
+            threadCount = 1;
+        }
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        workers.push_back(new Worker());
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        threads.push_back(std::thread(&TaskScheduler::workerLoop, this, i));
+    }
+}
+
+// Destructor
+TaskScheduler::~TaskScheduler() {
+    while (queued.load() > 0) {
+        if (!tryRunOne(-1)) {
+            std::this_thread::yield();
+        }
+    }
+    stopping.store(true);
+    notifyAll();
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        delete workers[i];
+    }
+}
+
+// Gets the scheduler shared by the library.
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+// Method to get the number of worker threads
+int TaskScheduler::getThreadCount() const {
+    return static_cast<int>(workers.size());
+}
+
+// Private helper function to get the worker index of the calling thread.
+int TaskScheduler::currentWorker() const {
+    return threadScheduler == this ? threadWorker : -1;
+}
+
+// Queues a task on the own deque of a worker, or round robin from other threads.
+void TaskScheduler::submit(const std::function<void()>& task) {
+    int self = currentWorker();
+    int target = self >= 0 ? self : static_cast<int>(nextWorker++ % workers.size());
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->tasks.push_back(task);
+    }
+    ++queued;
+    {
+        // Taking the lock orders the increment before a sleeper's predicate check.
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+// Private helper function to run one task, own deque first, then stealing.
+bool TaskScheduler::tryRunOne(int self) {
+    std::function<void()> task;
+    bool found = false;
+    if (self >= 0) {
+        std::lock_guard<std::mutex> lock(workers[self]->mutex);
+        if (!workers[self]->tasks.empty()) {
+            task.swap(workers[self]->tasks.back());
+            workers[self]->tasks.pop_back();
+            found = true;
+        }
+    }
+    const int count = static_cast<int>(workers.size());
+    const int start = self >= 0 ? self + 1 : static_cast<int>(nextWorker.load() % count);
+    for (int offset = 0; !found && offset < count; ++offset) {
+        int victim = (start + offset) % count;
+        if (victim == self) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(workers[victim]->mutex);
+        if (!workers[victim]->tasks.empty()) {
+            task.swap(workers[victim]->tasks.front());
+            workers[victim]->tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    --queued;
+    task();
+    return true;
+}
+
+// Private helper function with the main loop of a worker thread.
+void TaskScheduler::workerLoop(int index) {
+    threadScheduler = this;
+    threadWorker = index;
+    while (true) {
+        if (tryRunOne(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return queued.load() > 0 || stopping.load(); });
+        if (stopping.load() && queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+// Blocks until pending reaches zero, helping with queued tasks meanwhile.
+void TaskScheduler::waitFor(const std::atomic<int>& pending) {
+    int self = currentWorker();
+    while (pending.load() > 0) {
+        if (tryRunOne(self)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this, &pending] { return queued.load() > 0 || pending.load() == 0; });
+    }
+}
+
+// Wakes every sleeping thread.
+void TaskScheduler::notifyAll() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_all();
+}
+
+// Adds a task to the graph.
+int TaskGraph::addTask(const std::function<void()>& task) {
+    work.push_back(task);
+    successors.push_back(std::vector<int>());
+    dependencyCount.push_back(0);
+    return static_cast<int>(work.size()) - 1;
+}
+
+// Adds a dependency between two tasks.
+void TaskGraph::addDependency(int before, int after) {
+    int count = getTaskCount();
+    if (before < 0 || before >= count || after < 0 || after >= count || before == after) {
+        throw std::invalid_argument("Invalid task dependency.");
+    }
+    successors[before].push_back(after);
+    ++dependencyCount[after];
+}
+
+// Method to get the number of tasks
+int TaskGraph::getTaskCount() const {
+    return static_cast<int>(work.size());
+}
+
+namespace {
+
+// State of one run of a graph, shared by its tasks.
+struct GraphRun {
+    const std::vector<std::function<void()>>* work;
+    const std::vector<std::vector<int>>* successors;
+    std::vector<std::atomic<int>> remaining;
+    std::atomic<int> pending;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    TaskScheduler* scheduler;
+
+    explicit GraphRun(int count) : remaining(count), pending(count) {}
+
+    void execute(int node) {
+        try {
+            (*work)[node]();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+        const std::vector<int>& next = (*successors)[node];
+        for (size_t i = 0; i < next.size(); ++i) {
+            if (--remaining[next[i]] == 0) {
+                release(next[i]);
+            }
+        }
+        // The waiting thread may destroy this state as soon as pending reaches zero.
+        TaskScheduler* owner = scheduler;
+        if (--pending == 0) {
+            owner->notifyAll();
+        }
+    }
+
+    void release(int node) {
+        scheduler->submit([this, node] { execute(node); });
+    }
+};
+
+} // namespace
+
+// Runs the graph and blocks until it finished.
+void TaskGraph::run(TaskScheduler& scheduler) const {
+    const int count = getTaskCount();
+    if (count == 0) {
+        return;
+    }
+    // Kahn's topological pass: a task on or behind a cycle is never reached.
+    std::vector<int> indegree(dependencyCount);
+    std::vector<int> ready;
+    for (int i = 0; i < count; ++i) {
+        if (indegree[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    int reached = 0;
+    while (!ready.empty()) {
+        const int node = ready.back();
+        ready.pop_back();
+        ++reached;
+        for (size_t i = 0; i < successors[node].size(); ++i) {
+            if (--indegree[successors[node][i]] == 0) {
+                ready.push_back(successors[node][i]);
+            }
+        }
+    }
+    if (reached < count) {
+        throw std::invalid_argument("Task graph has a cycle.");
+    }
+    GraphRun state(count);
+    state.work = &work;
+    state.successors = &successors;
+    state.scheduler = &scheduler;
+    for (int i = 0; i < count; ++i) {
+        state.remaining[i].store(dependencyCount[i]);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (dependencyCount[i] == 0) {
+            state.release(i);
+        }
+    }
+    scheduler.waitFor(state.pending);
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+} // namespace matrix
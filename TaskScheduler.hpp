@@ -0,0 +1,134 @@
+#ifndef TASK_SCHEDULER_HPP
+#define TASK_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matrix {
+
+/**
+ * @brief A pool of worker threads with work stealing.
+ *
+ * Every worker owns a deque of tasks: it pushes and pops at the back (LIFO, so the
+ * task it just released runs next while its data is still in cache) and idle workers
+ * steal from the front of the other deques (FIFO, the oldest and usually largest work).
+ */
+class TaskScheduler {
+private:
+    struct Worker {
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<Worker*> workers;
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> queued;          // Tasks pushed and not yet popped.
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> nextWorker; // Round robin target of external submissions.
+
+    /**
+     * @brief Index of the calling thread in this scheduler, or -1 for other threads.
+     */
+    int currentWorker() const;
+
+    /**
+     * @brief Pops a task from the own deque or steals one, and runs it.
+     * Returns false if every deque was empty.
+     */
+    bool tryRunOne(int self);
+
+    /**
+     * @brief Main loop of worker thread index.
+     */
+    void workerLoop(int index);
+
+    TaskScheduler(const TaskScheduler&);
+    TaskScheduler& operator=(const TaskScheduler&);
+
+public:
+/**
+ * @brief Starts threadCount workers, or one per hardware thread if threadCount is 0.
+ */
+explicit TaskScheduler(int threadCount = 0);
+
+/**
+ * @brief Runs the remaining tasks and joins the workers.
+ */
+~TaskScheduler();
+
+/**
+ * @brief Gets the scheduler shared by the library, created on first use.
+ */
+static TaskScheduler& instance();
+
+/**
+ * @brief Gets the number of worker threads.
+ */
+int getThreadCount() const;
+
+/**
+ * @brief Queues a task. From a worker it goes to the worker's own deque.
+ */
+void submit(const std::function<void()>& task);
+
+/**
+ * @brief Blocks until pending reaches zero, running queued tasks meanwhile so that
+ * waiting from inside a task cannot deadlock the pool.
+ */
+void waitFor(const std::atomic<int>& pending);
+
+/**
+ * @brief Wakes every thread blocked in waitFor() so it can check its condition again.
+ */
+void notifyAll();
+};
+
+/**
+ * @brief A directed acyclic graph of tasks, each task starting once all the tasks it
+ * depends on have finished.
+ */
+class TaskGraph {
+private:
+    std::vector<std::function<void()>> work;
+    std::vector<std::vector<int>> successors;
+    std::vector<int> dependencyCount;
+
+public:
+/**
+ * @brief Adds a task and returns its identifier.
+ */
+int addTask(const std::function<void()>& task);
+
+/**
+ * @brief Makes task after wait for task before.
+ *
+ * When a task finishes, the successors it releases are queued in the order their
+ * dependencies were added, and the last one runs next on the same worker; add the
+ * edge to the most urgent successor last.
+ */
+void addDependency(int before, int after);
+
+/**
+ * @brief Gets the number of tasks in the graph.
+ */
+int getTaskCount() const;
+
+/**
+ * @brief Runs the graph on the scheduler and blocks until every task finished.
+ * The first exception thrown by a task is rethrown here. Throws std::invalid_argument,
+ * before running any task, if the dependencies form a cycle.
+ */
+void run(TaskScheduler& scheduler = TaskScheduler::instance()) const;
+};
+
+} // namespace matrix
+
+#endif // TASK_SCHEDULER_HPP
@@ -0,0 +1,307 @@
+#include "Vector.hpp"
+#include "TaskScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace matrix {
+
+namespace {
+
+// Elements handled by one task.
+const int CHUNK = 1 << 14;
+
+// Runs body(begin, end) over [0, count) in chunks of chunk indices, in parallel on the
+// shared scheduler when the work reaches Vector::PARALLEL_THRESHOLD elements.
+template <typename Body>
+void forChunks(int count, int chunk, long work, const Body& body) {
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    if (work < Vector::PARALLEL_THRESHOLD || count <= chunk || scheduler.getThreadCount() < 2) {
+        for (int begin = 0; begin < count; begin += chunk) {
+            body(begin, std::min(count, begin + chunk));
+        }
+        return;
+    }
+    TaskGraph graph;
+    for (int begin = 0; begin < count; begin += chunk) {
+        const int end = std::min(count, begin + chunk);
+        graph.addTask([&body, begin, end] { body(begin, end); });
+    }
+    graph.run(scheduler);
+}
+
+// Sums the partial results of the chunks of a reduction in chunk order, so the result
+// does not depend on how the chunks were scheduled.
+template <typename Partial>
+double reduceChunks(int count, const Partial& partial) {
+    const int chunks = (count + CHUNK - 1) / CHUNK;
+    std::vector<double> sums(chunks, 0.0);
+    forChunks(count, CHUNK, count, [&sums, &partial](int begin, int end) {
+        sums[begin / CHUNK] = partial(begin, end);
+    });
+    double total = 0.0;
+    for (int i = 0; i < chunks; ++i) {
+        total += sums[i];
+    }
+    return total;
+}
+
+// Dot product of two arrays with four independent partial sums: a single running sum
+// is a serial dependency chain that the compiler may not reorder into SIMD lanes.
+double dotKernel(const double* x, const double* y, int count) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+    }
+    for (; i < count; ++i) {
+        s0 += x[i] * y[i];
+    }
+    return (s0 + s2) + (s1 + s3);
+}
+
+void checkSameSize(int size, int otherSize, const char* message) {
+    if (size != otherSize) {
+        throw std::invalid_argument(message);
+    }
+}
+
+} // namespace
+
+// Constructor that creates a zero vector.
+Vector::Vector(int size) : size(size), data(nullptr) {
+    if (size <= 0) {
+        throw std::invalid_argument("Vector size must be a positive integer.");
+    }
+    data = new double[size]();
+}
+
+// Constructor that copies a std::vector.
+Vector::Vector(const std::vector<double>& values) : Vector(static_cast<int>(values.size())) {
+    std::copy(values.begin(), values.end(), data);
+}
+
+// Copy constructor
+Vector::Vector(const Vector& other) : size(other.size), data(new double[other.size]) {
+    std::copy(other.data, other.data + size, data);
+}
+
+// Assignment operator
+Vector& Vector::operator=(const Vector& other) {
+    if (this != &other) {
+        double* copy = new double[other.size];
+        std::copy(other.data, other.data + other.size, copy);
+        delete[] data;
+        data = copy;
+        size = other.size;
+    }
+    return *this;
+}
+
+// Destructor
+Vector::~Vector() {
+    delete[] data;
+}
+
+// Method to get the number of elements
+int Vector::getSize() const {
+    return size;
+}
+
+// Method to get the value of an element
+double Vector::get(int index) const {
+    if (index < 0 || index >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    return data[index];
+}
+
+// Method to set the value of an element
+void Vector::set(int index, double value) {
+    if (index < 0 || index >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    data[index] = value;
+}
+
+// Overloads the subscript operator [] (non-const version).
+double& Vector::operator[](int index) {
+    if (index < 0 || index >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    return data[index];
+}
+
+// Overloads the subscript operator [] (const version).
+const double& Vector::operator[](int index) const {
+    if (index < 0 || index >= size) {
+        throw std::out_of_range("Index out of bounds.");
+    }
+    return data[index];
+}
+
+// Method to convert to a std::vector
+std::vector<double> Vector::toStdVector() const {
+    return std::vector<double>(data, data + size);
+}
+
+// Overloads the addition operator (+).
+Vector Vector::operator+(const Vector& other) const {
+    Vector result(*this);
+    result.axpy(1.0, other);
+    return result;
+}
+
+// Overloads the subtraction operator (-).
+Vector Vector::operator-(const Vector& other) const {
+    Vector result(*this);
+    result.axpy(-1.0, other);
+    return result;
+}
+
+// Overloads the multiplication operator (*) for scalar multiplication.
+Vector Vector::operator*(double scalar) const {
+    Vector result(size);
+    const double* in = data;
+    double* out = result.data;
+    forChunks(size, CHUNK, size, [in, out, scalar](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            out[i] = in[i] * scalar;
+        }
+    });
+    return result;
+}
+
+// Overloads the equality operator (==).
+bool Vector::operator==(const Vector& other) const {
+    return size == other.size && std::equal(data, data + size, other.data);
+}
+
+// Overloads the inequality operator (!=).
+bool Vector::operator!=(const Vector& other) const {
+    return !(*this == other);
+}
+
+// Calculates the dot product.
+double Vector::dot(const Vector& other) const {
+    checkSameSize(size, other.size, "Vectors must have the same size for the dot product.");
+    const double* x = data;
+    const double* y = other.data;
+    return reduceChunks(size, [x, y](int begin, int end) {
+        return dotKernel(x + begin, y + begin, end - begin);
+    });
+}
+
+// Computes this += alpha * x.
+Vector& Vector::axpy(double alpha, const Vector& x) {
+    checkSameSize(size, x.size, "Vectors must have the same size for axpy.");
+    const double* in = x.data;
+    double* out = data;
+    forChunks(size, CHUNK, size, [in, out, alpha](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            out[i] += alpha * in[i];
+        }
+    });
+    return *this;
+}
+
+// Calculates the sum of the absolute values.
+double Vector::norm1() const {
+    const double* x = data;
+    return reduceChunks(size, [x](int begin, int end) {
+        double sum = 0.0;
+        for (int i = begin; i < end; ++i) {
+            sum += std::fabs(x[i]);
+        }
+        return sum;
+    });
+}
+
+// Calculates the Euclidean norm, dividing by the largest element first so that the
+// squares can neither overflow nor underflow.
+double Vector::norm2() const {
+    const double largest = normInf();
+    if (largest == 0.0 || std::isinf(largest)) {
+        return largest;
+    }
+    const double scale = 1.0 / largest;
+    const double* x = data;
+    double sum = reduceChunks(size, [x, scale](int begin, int end) {
+        double partial = 0.0;
+        for (int i = begin; i < end; ++i) {
+            const double scaled = x[i] * scale;
+            partial += scaled * scaled;
+        }
+        return partial;
+    });
+    return largest * std::sqrt(sum);
+}
+
+// Calculates the largest absolute value.
+double Vector::normInf() const {
+    double largest = 0.0;
+    for (int i = 0; i < size; ++i) {
+        largest = std::max(largest, std::fabs(data[i]));
+    }
+    return largest;
+}
+
+// Overloads the multiplication operator (*) for scalar multiplication (scalar * vector).
+Vector operator*(double scalar, const Vector& vector) {
+    return vector * scalar;
+}
+
+// Computes A * x, one dot product per row; the tasks take blocks of rows.
+Vector operator*(const SquareMat& matrix, const Vector& vector) {
+    const int n = matrix.getSize();
+    checkSameSize(n, vector.getSize(), "Matrix and vector sizes must match for multiplication.");
+    Vector result(n);
+    const double* x = &vector[0];
+    double* y = &result[0];
+    const int rowsPerTask = std::max(1, CHUNK / n);
+    forChunks(n, rowsPerTask, static_cast<long>(n) * n, [&matrix, x, y, n](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            y[i] = dotKernel(matrix[i], x, n);
+        }
+    });
+    return result;
+}
+
+// Computes x^T * A as a sum of rows of A scaled by x, so every access stays contiguous;
+// the tasks take blocks of columns and never write to the same element.
+Vector operator*(const Vector& vector, const SquareMat& matrix) {
+    const int n = matrix.getSize();
+    checkSameSize(n, vector.getSize(), "Matrix and vector sizes must match for multiplication.");
+    Vector result(n);
+    const double* x = &vector[0];
+    double* y = &result[0];
+    const int columnsPerTask = std::max(256, CHUNK / 16);
+    forChunks(n, columnsPerTask, static_cast<long>(n) * n, [&matrix, x, y, n](int begin, int end) {
+        for (int i = 0; i < n; ++i) {
+            const double scale = x[i];
+            if (scale == 0.0) {
+                continue;
+            }
+            const double* row = matrix[i];
+            for (int j = begin; j < end; ++j) {
+                y[j] += scale * row[j];
+            }
+        }
+    });
+    return result;
+}
+
+// Overloads the output stream operator (<<) for the Vector class.
+std::ostream& operator<<(std::ostream& os, const Vector& vector) {
+    os << "V_" << vector.getSize() << ":\n[ ";
+    for (int i = 0; i < vector.getSize(); ++i) {
+        os << vector[i] << (i == vector.getSize() - 1 ? "" : " ");
+    }
+    os << " ]\n";
+    return os;
+}
+
+} // namespace matrix
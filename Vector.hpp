@@ -0,0 +1,157 @@
+#ifndef VECTOR_HPP
+#define VECTOR_HPP
+
+#include "SquareMat.hpp"
+#include <iostream>
+#include <vector>
+
+namespace matrix {
+
+/**
+ * @brief Represents a dense column vector of doubles.
+ *
+ * Products with a SquareMat cost O(n^2). The loops are contiguous so the compiler
+ * vectorizes them, and from PARALLEL_THRESHOLD elements (of the vector, or of the matrix
+ * for products) the work is split into fixed chunks run on the shared TaskScheduler;
+ * the chunks do not depend on the thread count, so results are reproducible.
+ */
+class Vector {
+private:
+    int size;
+    double* data;
+
+public:
+/**
+ * @brief Number of elements from which the operations run in parallel.
+ */
+static const int PARALLEL_THRESHOLD = 1 << 16;
+
+/**
+ * @brief Constructor that creates a zero vector.
+ */
+explicit Vector(int size);
+
+/**
+ * @brief Constructor that copies the elements of a std::vector.
+ */
+explicit Vector(const std::vector<double>& values);
+
+/**
+ * @brief Copy constructor for the Vector class.
+ */
+Vector(const Vector& other);
+
+/**
+ * @brief Assignment operator for the Vector class.
+ */
+Vector& operator=(const Vector& other);
+
+/**
+ * @brief Destructor for the Vector class.
+ */
+~Vector();
+
+/**
+ * @brief Gets the number of elements.
+ */
+int getSize() const;
+
+/**
+ * @brief Gets the value of the element at the specified index.
+ */
+double get(int index) const;
+
+/**
+ * @brief Sets the value of the element at the specified index.
+ */
+void set(int index, double value);
+
+/**
+ * @brief Overloads the subscript operator [] for accessing elements (non-const version).
+ */
+double& operator[](int index);
+
+/**
+ * @brief Overloads the subscript operator [] for accessing elements (const version).
+ */
+const double& operator[](int index) const;
+
+/**
+ * @brief Converts to a std::vector, e.g. for matrix::solve().
+ */
+std::vector<double> toStdVector() const;
+
+/**
+ * @brief Overloads the addition operator (+) for vector addition.
+ */
+Vector operator+(const Vector& other) const;
+
+/**
+ * @brief Overloads the subtraction operator (-) for vector subtraction.
+ */
+Vector operator-(const Vector& other) const;
+
+/**
+ * @brief Overloads the multiplication operator (*) for scalar multiplication.
+ */
+Vector operator*(double scalar) const;
+
+/**
+ * @brief Overloads the equality operator (==): same size and elements.
+ */
+bool operator==(const Vector& other) const;
+
+/**
+ * @brief Overloads the inequality operator (!=).
+ */
+bool operator!=(const Vector& other) const;
+
+/**
+ * @brief Calculates the dot product with another vector.
+ */
+double dot(const Vector& other) const;
+
+/**
+ * @brief Computes this += alpha * x in place (BLAS axpy).
+ */
+Vector& axpy(double alpha, const Vector& x);
+
+/**
+ * @brief Calculates the sum of the absolute values of the elements.
+ */
+double norm1() const;
+
+/**
+ * @brief Calculates the Euclidean norm, scaled so that it cannot overflow or underflow.
+ */
+double norm2() const;
+
+/**
+ * @brief Calculates the largest absolute value of the elements.
+ */
+double normInf() const;
+};
+
+/**
+ * @brief Overloads the multiplication operator (*) for scalar multiplication (scalar * vector).
+ */
+Vector operator*(double scalar, const Vector& vector);
+
+/**
+ * @brief Computes the matrix-vector product A * x.
+ */
+Vector operator*(const SquareMat& matrix, const Vector& vector);
+
+/**
+ * @brief Computes the vector-matrix product x^T * A, that is A^T * x, without transposing A.
+ */
+Vector operator*(const Vector& vector, const SquareMat& matrix);
+
+/**
+ * @brief Overloads the output stream operator (<<) for the Vector class.
+ */
+std::ostream& operator<<(std::ostream& os, const Vector& vector);
+
+} // namespace matrix
+
+#endif // VECTOR_HPP
@@ -0,0 +1,890 @@
+#include "SquareMat.hpp"
+#include "Decomposition.hpp"
+#include "TaskScheduler.hpp"
+#include "ModMat.hpp"
+#include "MixedPrecision.hpp"
+#include "Strassen.hpp"
+#include "Batch.hpp"
+#include "Vector.hpp"
+#include "Chain.hpp"
+#include "Async.hpp"
+#include "Lazy.hpp"
+#include "MatrixFunctions.hpp"
+#include "Eigen.hpp"
+#include "ExactDeterminant.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Fills a matrix with reproducible pseudo-random values in [-1, 1].
+matrix::SquareMat randomMatrix(int size, unsigned seed) {
+    matrix::SquareMat result(size);
+    std::srand(seed);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            result[i][j] = 2.0 * std::rand() / RAND_MAX - 1.0;
+        }
+    }
+    return result;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Counts the data TLB load misses of this thread in user space with perf_event_open, where
+// the kernel and the hardware allow it (perf_event_paranoid <= 2, a PMU exposed to the VM).
+class TlbMissCounter {
+private:
+    int fd;
+
+public:
+    TlbMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~TlbMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool isAvailable() const {
+        return fd >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Returns the misses since start(), -1 without a counter.
+    long long stop() {
+        long long count = -1;
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+                count = -1;
+            }
+        }
+#endif
+        return count;
+    }
+};
+
+// LU factorization, reuse for a single right-hand side, and inverse.
+void benchLinearSolve(int size) {
+    matrix::SquareMat a = randomMatrix(size, 42);
+    std::vector<double> b(size, 1.0);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::LUDecomposition lu(a);
+    double factorTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<double> x = lu.solve(b);
+    double solveTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::SquareMat inverse = lu.inverse();
+    double inverseTime = secondsSince(start);
+
+    double residual = 0.0;
+    for (int i = 0; i < size; ++i) {
+        double sum = -b[i];
+        for (int j = 0; j < size; ++j) {
+            sum += a[i][j] * x[j];
+        }
+        residual = std::max(residual, std::abs(sum));
+    }
+    double gflops = (2.0 / 3.0) * size * static_cast<double>(size) * size / factorTime * 1e-9;
+    std::cout << "n=" << size
+              << "  LU " << factorTime << " s (" << gflops << " GFLOP/s)"
+              << "  solve " << solveTime * 1e3 << " ms"
+              << "  inverse " << inverseTime << " s"
+              << "  max residual " << residual << std::endl;
+}
+
+// The task graph LU on one thread against the shared scheduler.
+void benchParallelLU(int size) {
+    matrix::SquareMat a = randomMatrix(size, 7);
+    matrix::TaskScheduler& scheduler = matrix::TaskScheduler::instance();
+    matrix::TaskScheduler single(1);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::LUDecomposition serial(a, single, 128);
+    double serialTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::LUDecomposition parallel(a, scheduler, 128);
+    double parallelTime = secondsSince(start);
+
+    std::cout << "n=" << size
+              << "  LU on 1 thread " << serialTime << " s"
+              << "  task graph LU " << parallelTime << " s on "
+              << scheduler.getThreadCount() << " threads"
+              << "  (speedup " << serialTime / parallelTime << ")" << std::endl;
+}
+
+// Float LU with refinement against the double LU, on a random matrix and on the same
+// matrix with columns scaled over eight orders of magnitude (condition number ~1e8).
+void benchRefinedSolve(int size) {
+    const char* labels[] = {"random", "ill-conditioned"};
+    for (int variant = 0; variant < 2; ++variant) {
+        matrix::SquareMat a = randomMatrix(size, 21);
+        if (variant == 1) {
+            for (int i = 0; i < size; ++i) {
+                for (int j = 0; j < size; ++j) {
+                    a[i][j] *= std::pow(10.0, -8.0 * j / size);
+                }
+            }
+        }
+        std::vector<double> b(size, 1.0);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<double> direct = matrix::LUDecomposition(a).solve(b);
+        double directTime = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        matrix::RefinedLUSolver refined(a);
+        std::vector<double> x = refined.solve(b);
+        double refinedTime = secondsSince(start);
+
+        double difference = 0.0;
+        double magnitude = 0.0;
+        for (int i = 0; i < size; ++i) {
+            difference = std::max(difference, std::abs(x[i] - direct[i]));
+            magnitude = std::max(magnitude, std::abs(direct[i]));
+        }
+        std::cout << "n=" << size << " " << labels[variant]
+                  << "  double LU solve " << directTime << " s"
+                  << "  float LU + refinement " << refinedTime << " s"
+                  << " (" << refined.getIterations() << " steps"
+                  << (refined.usedFallback() ? ", fell back to double" : "") << ")"
+                  << "  relative difference " << difference / magnitude << std::endl;
+    }
+}
+
+// C += A * B * 0.5 with the operators (three temporaries) against one gemm call.
+void benchGemm(int size) {
+    matrix::SquareMat a = randomMatrix(size, 41);
+    matrix::SquareMat b = randomMatrix(size, 42);
+    matrix::SquareMat c = randomMatrix(size, 43);
+    matrix::SquareMat d(c);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    c += a * b * 0.5;
+    double operatorTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::gemm(0.5, a, b, 1.0, d);
+    double gemmTime = secondsSince(start);
+
+    std::cout << "n=" << size << "  C += A * B * 0.5 " << operatorTime << " s"
+              << "  gemm " << gemmTime << " s" << std::endl;
+}
+
+// A * x emulated with a one-column matrix and operator* against the Vector products.
+void benchMatrixVector(int size) {
+    matrix::SquareMat a = randomMatrix(size, 51);
+    matrix::SquareMat column(size);
+    matrix::Vector x(size);
+    for (int i = 0; i < size; ++i) {
+        x[i] = std::sin(i + 1.0);
+        column[i][0] = x[i];
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SquareMat emulated = a * column;
+    double emulatedTime = secondsSince(start);
+
+    const int repeats = 10;
+    start = std::chrono::steady_clock::now();
+    matrix::Vector y(size);
+    for (int r = 0; r < repeats; ++r) {
+        y = a * x;
+    }
+    double gemvTime = secondsSince(start) / repeats;
+
+    start = std::chrono::steady_clock::now();
+    matrix::Vector yt(size);
+    for (int r = 0; r < repeats; ++r) {
+        yt = x * a;
+    }
+    double transposedTime = secondsSince(start) / repeats;
+
+    double difference = 0.0;
+    for (int i = 0; i < size; ++i) {
+        difference = std::max(difference, std::fabs(y[i] - emulated[i][0]));
+    }
+    std::cout << "n=" << size << "  one-column operator* " << emulatedTime << " s"
+              << "  A * x " << gemvTime << " s  x * A " << transposedTime << " s"
+              << "  max difference " << difference << std::endl;
+}
+
+// A * D1 * D2 * T * B with diagonal D1, D2 and tridiagonal T: operator* on the dense forms
+// against a MatrixChain of the structured factors.
+void benchChain(int size) {
+    matrix::SquareMat a = randomMatrix(size, 61);
+    matrix::SquareMat b = randomMatrix(size, 62);
+    matrix::StructuredMat d1(matrix::Structure::Diagonal, size);
+    matrix::StructuredMat d2(matrix::Structure::Diagonal, size);
+    matrix::StructuredMat t(matrix::Structure::Banded, size, 1);
+    for (int i = 0; i < size; ++i) {
+        d1.set(i, i, 1.0 + (i % 5));
+        d2.set(i, i, 1.0 / (1.0 + (i % 3)));
+        for (int j = std::max(0, i - 1); j <= std::min(size - 1, i + 1); ++j) {
+            t.set(i, j, i == j ? 2.0 : -1.0);
+        }
+    }
+    matrix::SquareMat d1Dense = d1.toDense();
+    matrix::SquareMat d2Dense = d2.toDense();
+    matrix::SquareMat tDense = t.toDense();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SquareMat eager = a * d1Dense * d2Dense * tDense * b;
+    double eagerTime = secondsSince(start);
+
+    matrix::MatrixChain chain;
+    chain.append(a).append(d1).append(d2).append(t).append(b);
+    start = std::chrono::steady_clock::now();
+    matrix::SquareMat planned = chain.evaluate();
+    double chainTime = secondsSince(start);
+
+    double difference = 0.0;
+    double magnitude = 0.0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            difference = std::max(difference, std::fabs(eager[i][j] - planned[i][j]));
+            magnitude = std::max(magnitude, std::fabs(eager[i][j]));
+        }
+    }
+    std::cout << "n=" << size << "  dense operator* chain " << eagerTime << " s"
+              << "  MatrixChain " << chain.getOrder() << " " << chainTime << " s"
+              << "  relative difference " << difference / magnitude << std::endl;
+}
+
+// Four independent products and their determinants one after the other against the
+// futures of the async API, which overlap them on the scheduler's workers.
+void benchAsync(int size) {
+    std::vector<matrix::SquareMat> left, right;
+    for (int i = 0; i < 4; ++i) {
+        left.push_back(randomMatrix(size, 71 + i));
+        right.push_back(randomMatrix(size, 81 + i));
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<double> serial;
+    for (int i = 0; i < 4; ++i) {
+        serial.push_back(!(left[i] * right[i]));
+    }
+    double serialTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<matrix::Future<double>> determinants;
+    for (int i = 0; i < 4; ++i) {
+        determinants.push_back(matrix::asyncDeterminant(matrix::asyncMultiply(left[i], right[i])));
+    }
+    int matching = 0;
+    for (int i = 0; i < 4; ++i) {
+        matching += determinants[i].get() == serial[i] ? 1 : 0;
+    }
+    double asyncTime = secondsSince(start);
+
+    std::cout << "n=" << size << "  4 x det(A * B) serial " << serialTime << " s"
+              << "  async " << asyncTime << " s on " << matrix::TaskScheduler::instance().getThreadCount()
+              << " threads  " << matching << "/4 identical determinants" << std::endl;
+}
+
+// (A * B) + (A * B) % C + ~A * ~A evaluated eagerly against a LazyGraph, which computes
+// A * B and ~A once.
+void benchLazy(int size) {
+    matrix::SquareMat a = randomMatrix(size, 91);
+    matrix::SquareMat b = randomMatrix(size, 92);
+    matrix::SquareMat c = randomMatrix(size, 93);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SquareMat eager = (a * b) + (a * b) % c + ~a * ~a;
+    double eagerTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::LazyGraph graph;
+    matrix::LazyMat la = graph.input(a), lb = graph.input(b), lc = graph.input(c);
+    matrix::SquareMat lazy = graph.evaluate((la * lb) + (la * lb) % lc + ~la * ~la);
+    double lazyTime = secondsSince(start);
+
+    double difference = 0.0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            difference = std::max(difference, std::fabs(eager[i][j] - lazy[i][j]));
+        }
+    }
+    std::cout << "n=" << size << "  eager " << eagerTime << " s  lazy " << lazyTime << " s ("
+              << graph.getEvaluatedCount() << " of " << graph.getRequestedCount() << " operations, "
+              << graph.getBufferCount() << " buffers)  max difference " << difference << std::endl;
+}
+
+// e^A for ||A||_1 = 2: the Taylor series summing A^k / k! with operator^ until the terms
+// vanish, against expm. The product counts are those of operator^'s repeated squaring.
+void benchExpm(int size) {
+    matrix::SquareMat a = randomMatrix(size, 101);
+    double norm = 0.0;
+    for (int j = 0; j < size; ++j) {
+        double column = 0.0;
+        for (int i = 0; i < size; ++i) {
+            column += std::fabs(a[i][j]);
+        }
+        norm = std::max(norm, column);
+    }
+    a = a * (2.0 / norm);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SquareMat series(size);
+    for (int i = 0; i < size; ++i) {
+        series[i][i] = 1.0;
+    }
+    int seriesProducts = 0;
+    double factorial = 1.0;
+    for (int k = 1; k < 60; ++k) {
+        factorial *= k;
+        matrix::SquareMat term = (a ^ k) / factorial;
+        for (int bits = k; bits > 1; bits >>= 1) {
+            seriesProducts += (bits & 1) ? 2 : 1;
+        }
+        series += term;
+        if (std::pow(2.0, k) / factorial < 1e-17) {
+            break;
+        }
+    }
+    double seriesTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::FunctionCost cost = {0, 0, 0};
+    matrix::SquareMat pade = matrix::expm(a, &cost);
+    double padeTime = secondsSince(start);
+
+    double difference = 0.0;
+    double magnitude = 0.0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            difference = std::max(difference, std::fabs(series[i][j] - pade[i][j]));
+            magnitude = std::max(magnitude, std::fabs(pade[i][j]));
+        }
+    }
+    std::cout << "n=" << size << "  Taylor series " << seriesProducts << " products " << seriesTime << " s"
+              << "  expm " << cost.products << " products + " << cost.solves << " solve " << padeTime << " s"
+              << "  relative difference " << difference / magnitude << std::endl;
+}
+
+// Power of a symmetric diffusion kernel, (I - L / 4)^k for the Laplacian L of a random
+// graph: repeated squaring against the eigendecomposition, for growing k.
+void benchSymmetricPower(int size) {
+    matrix::SquareMat kernel(size);
+    std::srand(303);
+    for (int i = 0; i < size; ++i) {
+        kernel[i][i] = 1.0;
+    }
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < i; ++j) {
+            if (std::rand() % size < 4) {
+                const double weight = 0.25 / 8.0;
+                kernel[i][j] = kernel[j][i] = weight;
+                kernel[i][i] -= weight;
+                kernel[j][j] -= weight;
+            }
+        }
+    }
+    const int exponents[] = {16, 1000, 100000};
+    for (int e = 0; e < 3; ++e) {
+        const int k = exponents[e];
+        matrix::SquareMat::setSpectralPowerThreshold(0);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        matrix::SquareMat squared = kernel ^ k;
+        double squaringTime = secondsSince(start);
+        int products = -1;
+        for (int bits = k; bits > 0; bits >>= 1) {
+            products += (bits & 1) ? 2 : 1;
+        }
+
+        matrix::SquareMat::setSpectralPowerThreshold(1);
+        start = std::chrono::steady_clock::now();
+        matrix::SquareMat spectral = kernel ^ k;
+        double spectralTime = secondsSince(start);
+        matrix::SquareMat::setSpectralPowerThreshold(0);
+
+        double difference = 0.0;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                difference = std::max(difference, std::fabs(squared[i][j] - spectral[i][j]));
+            }
+        }
+        std::cout << "n=" << size << " k=" << k << "  squaring " << products << " products " << squaringTime << " s"
+                  << "  eigendecomposition " << spectralTime << " s"
+                  << "  (speedup " << squaringTime / spectralTime << ")"
+                  << "  max difference " << difference << std::endl;
+    }
+}
+
+// Construction of a matrix with each NUMA placement, and the parallel matrix-vector
+// products that then stream it: on a multi-socket machine the calling-thread fill leaves
+// every page behind one memory controller.
+void benchNumaPlacement(int size) {
+    const matrix::NumaPlacement savedPlacement = matrix::FormatPolicy::getNumaPlacement();
+    const int savedNode = matrix::FormatPolicy::getNumaNode();
+    const matrix::NumaPlacement placements[3] = {matrix::NumaPlacement::CallingThread,
+                                                 matrix::NumaPlacement::FirstTouch,
+                                                 matrix::NumaPlacement::Interleave};
+    const char* names[3] = {"calling thread", "first touch", "interleave"};
+    matrix::Vector x(size);
+    for (int i = 0; i < size; ++i) {
+        x[i] = 1.0 / (i + 1);
+    }
+    for (int p = 0; p < 3; ++p) {
+        matrix::FormatPolicy::setNumaPlacement(placements[p]);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        matrix::SquareMat a(size);
+        double fillTime = secondsSince(start);
+        for (int i = 0; i < size; ++i) {
+            a[i][i] = 1.0;
+        }
+
+        const int products = 10;
+        start = std::chrono::steady_clock::now();
+        double checksum = 0.0;
+        for (int k = 0; k < products; ++k) {
+            checksum += (a * x)[size - 1];
+        }
+        double productTime = secondsSince(start) / products;
+
+        std::cout << "n=" << size << "  " << names[p] << "  construction " << fillTime << " s"
+                  << "  matrix-vector product " << productTime << " s"
+                  << "  (" << matrix::getNumaNodeCount() << " nodes, "
+                  << matrix::TaskScheduler::instance().getThreadCount() << " threads, checksum " << checksum << ")"
+                  << std::endl;
+    }
+    matrix::FormatPolicy::setNumaPlacement(savedPlacement, savedNode);
+}
+
+// Transpose, a column-order sweep and a product of a random matrix on regular and on
+// transparent huge pages. From n = 512 every element of a column sweep is on its own 4 KiB
+// page, while a 2 MiB page holds 2 MiB / (8 n) rows; the transpose writes the same way.
+void benchHugePages(int size) {
+    const matrix::PageBacking savedPages = matrix::FormatPolicy::getHugePages();
+    const std::size_t savedThreshold = matrix::FormatPolicy::getHugePageThreshold();
+    matrix::FormatPolicy::setHugePageThreshold(0);
+    const matrix::PageBacking modes[2] = {matrix::PageBacking::Regular, matrix::PageBacking::TransparentHuge};
+    const char* names[2] = {"4 KiB pages", "huge pages"};
+    TlbMissCounter counter;
+    for (int m = 0; m < 2; ++m) {
+        matrix::FormatPolicy::setHugePages(modes[m]);
+        const matrix::SquareMat a = randomMatrix(size, 909);
+
+        counter.start();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        matrix::SquareMat t = ~a;
+        double transposeTime = secondsSince(start);
+        long long transposeMisses = counter.stop();
+
+        counter.start();
+        start = std::chrono::steady_clock::now();
+        double sum = 0.0;
+        for (int j = 0; j < size; ++j) {
+            for (int i = 0; i < size; ++i) {
+                sum += a[i][j];
+            }
+        }
+        double sweepTime = secondsSince(start);
+        long long sweepMisses = counter.stop();
+
+        const char* granted = a.getPageBacking() == modes[m] ? "granted" : "refused";
+        std::cout << "n=" << size << "  " << names[m] << " (" << granted << ")  transpose " << transposeTime << " s";
+        if (counter.isAvailable()) {
+            std::cout << ", " << transposeMisses << " dTLB misses";
+        }
+        std::cout << "  column sweep " << sweepTime << " s";
+        if (counter.isAvailable()) {
+            std::cout << ", " << sweepMisses << " dTLB misses";
+        }
+        // The product takes a minute and more beyond n = 2048.
+        if (size <= 2048) {
+            counter.start();
+            start = std::chrono::steady_clock::now();
+            matrix::SquareMat product = a * t;
+            double productTime = secondsSince(start);
+            long long productMisses = counter.stop();
+            std::cout << "  product " << productTime << " s";
+            if (counter.isAvailable()) {
+                std::cout << ", " << productMisses << " dTLB misses";
+            }
+            sum += product[0][0];
+        }
+        std::cout << "  (checksum " << sum + t[0][0] << ")" << std::endl;
+    }
+    if (!counter.isAvailable()) {
+        std::cout << "  (no dTLB counter: perf_event_open is not permitted or the CPU exposes no PMU)" << std::endl;
+    }
+    matrix::FormatPolicy::setHugePages(savedPages);
+    matrix::FormatPolicy::setHugePageThreshold(savedThreshold);
+}
+
+// Replacing one row of a random matrix after another and reading the log-determinant: a new
+// LU factorization per change against the Sherman-Morrison updates of InverseUpdater.
+void benchInverseUpdate(int size) {
+    matrix::SquareMat a = randomMatrix(size, 707);
+    matrix::SquareMat rows = randomMatrix(size, 808);
+    const int changes = 8;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::LogDeterminant det = {0, 0.0};
+    for (int k = 0; k < changes; ++k) {
+        std::copy(rows[k], rows[k] + size, a[k]);
+        det = a.logAbsDet();
+    }
+    double factorTime = secondsSince(start) / changes;
+
+    matrix::InverseUpdater updater(randomMatrix(size, 707));
+    updater.setRefreshInterval(0);
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; k < changes; ++k) {
+        updater.replaceRow(k, std::vector<double>(rows[k], rows[k] + size));
+    }
+    double updateTime = secondsSince(start) / changes;
+
+    std::cout << "n=" << size << "  per change: LU " << factorTime << " s"
+              << "  Sherman-Morrison " << updateTime << " s"
+              << "  (speedup " << factorTime / updateTime << ")"
+              << "  log|det| difference " << std::fabs(updater.logDeterminant().logAbs - det.logAbs) << std::endl;
+}
+
+// Determinant of the adjacency matrix of a random graph (edge probability 1/2), exact
+// against the double LU, which has lost the low digits from about n = 60 on.
+void benchExactDeterminant(int size) {
+    matrix::BasicSquareMat<std::int64_t> adjacency(size);
+    matrix::SquareMat a(size);
+    std::srand(606);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < i; ++j) {
+            adjacency[i][j] = adjacency[j][i] = std::rand() % 2;
+            a[i][j] = a[j][i] = static_cast<double>(adjacency[i][j]);
+        }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double det = !a;
+    double luTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::ExactDeterminant exact = matrix::exactDeterminant(adjacency);
+    double exactTime = secondsSince(start);
+
+    std::cout << "n=" << size << "  LU " << det << " " << luTime << " s"
+              << "  exact " << exact.getBitLength() << " bits, " << exact.getPrimeCount() << " primes "
+              << exactTime << " s"
+              << "  relative error of LU " << std::fabs(det - exact.toDouble()) / std::fabs(exact.toDouble())
+              << std::endl;
+}
+
+// Determinant of a random matrix, whose magnitude leaves the double range near n = 350:
+// operator! against logAbsDet(), both from one LU factorization.
+void benchLogDeterminant(int size) {
+    matrix::SquareMat a = randomMatrix(size, 505);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double det = !a;
+    double detTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::LogDeterminant logDet = a.logAbsDet();
+    double logTime = secondsSince(start);
+
+    std::cout << "n=" << size << "  operator! " << det << " " << detTime << " s"
+              << "  logAbsDet sign " << logDet.sign << " log|det| " << logDet.logAbs << " " << logTime << " s"
+              << std::endl;
+}
+
+// Spectral decompositions of a random matrix: the symmetric eigensolver on A + A^T, the
+// Jacobi SVD with and without vectors, and the 1-norm condition number from the LU inverse.
+void benchSpectral(int size) {
+    matrix::SquareMat a = randomMatrix(size, 404);
+    matrix::SquareMat symmetric = a + ~a;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SymmetricEigen eigen(symmetric);
+    double eigenTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::SingularValueDecomposition svd(a);
+    double svdTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    double condition = matrix::conditionNumber(a);
+    double valuesTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::SquareMat inverse = matrix::LUDecomposition(a).inverse();
+    double norm = 0.0;
+    double inverseNorm = 0.0;
+    for (int j = 0; j < size; ++j) {
+        double column = 0.0;
+        double inverseColumn = 0.0;
+        for (int i = 0; i < size; ++i) {
+            column += std::fabs(a[i][j]);
+            inverseColumn += std::fabs(inverse[i][j]);
+        }
+        norm = std::max(norm, column);
+        inverseNorm = std::max(inverseNorm, inverseColumn);
+    }
+    double luTime = secondsSince(start);
+
+    std::cout << "n=" << size << "  SymmetricEigen " << eigenTime << " s"
+              << "  SVD " << svdTime << " s (" << svd.getSweepCount() << " sweeps)"
+              << "  singular values only " << valuesTime << " s"
+              << "  cond_2 " << condition << "  LU cond_1 " << norm * inverseNorm << " " << luTime << " s" << std::endl;
+}
+
+// A batch of small products, one operator* per pair against multiplyBatch. The batch holds
+// about the same number of elements as one size x size matrix.
+void benchBatch(int size) {
+    const int smallSizes[] = {3, 8, 16, 32};
+    for (int s = 0; s < 4; ++s) {
+        const int n = smallSizes[s];
+        const int count = std::max(64, size * size / (n * n));
+        std::vector<matrix::SquareMat> left, right, results;
+        for (int e = 0; e < count; ++e) {
+            left.push_back(randomMatrix(n, 100 + e));
+            right.push_back(randomMatrix(n, 200 + e));
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int e = 0; e < count; ++e) {
+            results.push_back(left[e] * right[e]);
+        }
+        double pairTime = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        matrix::multiplyBatch(left, right, results);
+        double batchTime = secondsSince(start);
+
+        std::cout << count << " x " << n << "x" << n
+                  << "  operator* per pair " << pairTime << " s"
+                  << "  multiplyBatch " << batchTime << " s"
+                  << "  (speedup " << pairTime / batchTime << ")" << std::endl;
+    }
+}
+
+// Classical product against Strassen-Winograd with a range of crossovers; the error is
+// the largest deviation from the classical product relative to its largest element.
+void benchStrassen(int size) {
+    matrix::SquareMat a = randomMatrix(size, 31);
+    matrix::SquareMat b = randomMatrix(size, 32);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SquareMat classical = a * b;
+    double classicalTime = secondsSince(start);
+    double magnitude = 0.0;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            magnitude = std::max(magnitude, std::abs(classical[i][j]));
+        }
+    }
+
+    std::cout << "n=" << size << "  classical " << classicalTime << " s";
+    const int crossovers[] = {64, 128, 256, 512};
+    for (int c = 0; c < 4; ++c) {
+        if (crossovers[c] >= size) {
+            continue;
+        }
+        start = std::chrono::steady_clock::now();
+        matrix::SquareMat fast = matrix::multiplyStrassen(a, b, crossovers[c]);
+        double time = secondsSince(start);
+        double error = 0.0;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                error = std::max(error, std::abs(fast[i][j] - classical[i][j]));
+            }
+        }
+        std::cout << "  strassen/" << crossovers[c] << " " << time << " s (error " << error / magnitude << ")";
+    }
+    std::cout << std::endl;
+}
+
+// Double operator* against the float-storage products and their largest deviation from it.
+void benchMixedPrecision(int size) {
+    matrix::SquareMat a = randomMatrix(size, 11);
+    matrix::SquareMat b = randomMatrix(size, 12);
+    matrix::FloatMat fa = matrix::toFloat(a);
+    matrix::FloatMat fb = matrix::toFloat(b);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::SquareMat reference = a * b;
+    double doubleTime = secondsSince(start);
+
+    std::cout << "n=" << size << "  double " << doubleTime << " s";
+    const matrix::Accumulation modes[] = {matrix::Accumulation::Double, matrix::Accumulation::Compensated,
+                                          matrix::Accumulation::Float};
+    const char* names[] = {"float/double-acc", "float/kahan", "float"};
+    for (int m = 0; m < 3; ++m) {
+        start = std::chrono::steady_clock::now();
+        matrix::SquareMat product = matrix::multiplyToDouble(fa, fb, modes[m]);
+        double time = secondsSince(start);
+        double error = 0.0;
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                error = std::max(error, std::abs(product[i][j] - reference[i][j]));
+            }
+        }
+        std::cout << "  " << names[m] << " " << time << " s (max error " << error << ")";
+    }
+    std::cout << std::endl;
+}
+
+// A^64 mod p by repeated squaring, against the naive loop of int64 products followed by %.
+void benchModularPower(int size) {
+    const std::uint64_t prime = 1000000007ULL;
+    matrix::ModMat a(size, prime);
+    matrix::BasicSquareMat<std::int64_t> plain(size);
+    std::srand(3);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            std::int64_t value = std::rand() % 1000;
+            a.set(i, j, value);
+            plain[i][j] = value;
+        }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    matrix::ModMat power = a ^ 64;
+    double modTime = secondsSince(start);
+
+    // One product then %: the reference a user needs when elements stay below ~3e9.
+    start = std::chrono::steady_clock::now();
+    matrix::BasicSquareMat<std::int64_t> product = (plain * plain) % static_cast<std::int64_t>(prime);
+    double plainTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    matrix::ModMat square = a * a;
+    double squareTime = secondsSince(start);
+
+    bool same = true;
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            same = same && static_cast<std::int64_t>(square.get(i, j)) == product[i][j];
+        }
+    }
+    std::cout << "n=" << size
+              << "  A^64 mod p " << modTime << " s"
+              << "  A*A mod p " << squareTime << " s"
+              << "  int64 A*A then % " << plainTime << " s"
+              << (same ? "" : "  MISMATCH") << (power.get(0, 0) < prime ? "" : "  UNREDUCED") << std::endl;
+}
+
+} // namespace
+
+// Usage: ./bench_runner [size...], defaulting to 256 512 1024 2048 4096.
+int main(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        int defaults[] = {256, 512, 1024, 2048, 4096};
+        sizes.assign(defaults, defaults + 5);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchLinearSolve(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchParallelLU(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchRefinedSolve(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchMixedPrecision(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchStrassen(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchGemm(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchMatrixVector(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchChain(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchAsync(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchLazy(sizes[i]);
+    }
+    // The Taylor series takes about 100 products: minutes beyond n = 512.
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        if (sizes[i] <= 512) {
+            benchExpm(sizes[i]);
+        }
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchSymmetricPower(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchNumaPlacement(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchHugePages(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchInverseUpdate(sizes[i]);
+    }
+    // About n / 8 primes of O(n^3) each: minutes beyond n = 512.
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        if (sizes[i] <= 512) {
+            benchExactDeterminant(sizes[i]);
+        }
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchLogDeterminant(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchSpectral(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchBatch(sizes[i]);
+    }
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        benchModularPower(sizes[i]);
+    }
+    return 0;
+}
@@ -1,8 +1,32 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "SquareMat.hpp"
+#include "StructuredMat.hpp"
+#include "Decomposition.hpp"
+#include "TaskScheduler.hpp"
+#include "ModMat.hpp"
+#include "MixedPrecision.hpp"
+#include "Strassen.hpp"
+#include "Batch.hpp"
+#include "Vector.hpp"
+#include "Chain.hpp"
+#include "Async.hpp"
+#include "Coroutine.hpp"
+#include "Lazy.hpp"
+#include "MatrixFunctions.hpp"
+#include "Eigen.hpp"
+#include "ExactDeterminant.hpp"
 #include <iostream>
 #include <stdexcept>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 // Helper function to compare matrices for equality (within a tolerance)
 bool areMatricesEqual(const matrix::SquareMat& mat1, const matrix::SquareMat& mat2, double tolerance = 1e-6) {
@@ -288,4 +312,1667 @@ TEST_CASE("SquareMat Output Stream") {
     ss << mat1;
     std::string expectedOutput = "M_2x2:\n[ 1 2 ]\n[ 3 4 ]\n";
     CHECK(ss.str() == expectedOutput);
-}
\ No newline at end of file
+}
+
+TEST_CASE("SquareMat Density and Format Switching") {
+    matrix::SquareMat sparse(4);
+    sparse[0][0] = 2.0;
+    sparse[1][2] = 3.0;
+    CHECK(sparse.density() == doctest::Approx(2.0 / 16.0));
+
+    matrix::SquareMat dense(4);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            dense[i][j] = i * 4 + j + 1;
+        }
+    }
+    CHECK(dense.density() == 1.0);
+
+    matrix::SquareMat::setFormatMode(matrix::FormatMode::ForceDense);
+    matrix::SquareMat expected = sparse * dense;
+    matrix::SquareMat expectedReversed = dense * sparse;
+
+    matrix::SquareMat::resetFormatStats();
+    matrix::SquareMat::setFormatMode(matrix::FormatMode::Automatic);
+    matrix::SquareMat::setSparseThreshold(0.2);
+    matrix::SquareMat product = sparse * dense;
+    CHECK(areMatricesEqual(product, expected));
+    CHECK(areMatricesEqual(dense * sparse, expectedReversed));
+    matrix::FormatStats stats = matrix::SquareMat::getFormatStats();
+    CHECK(stats.sparseProducts == 2);
+    CHECK(stats.denseProducts == 0);
+    CHECK(stats.lastFormat == matrix::StorageFormat::Sparse);
+    CHECK(stats.lastLeftDensity == 1.0);
+
+    // Fill-in: the dense operands switch the decision back to the dense kernel.
+    matrix::SquareMat denseProduct = dense * dense;
+    stats = matrix::SquareMat::getFormatStats();
+    CHECK(stats.denseProducts == 1);
+    CHECK(stats.lastFormat == matrix::StorageFormat::Dense);
+
+    matrix::SquareMat::setFormatMode(matrix::FormatMode::ForceSparse);
+    CHECK(areMatricesEqual(dense * dense, denseProduct));
+    CHECK(matrix::SquareMat::getFormatStats().sparseProducts == 3);
+
+    CHECK_THROWS_AS(matrix::SquareMat::setSparseThreshold(1.5), std::invalid_argument);
+    matrix::SquareMat::setFormatMode(matrix::FormatMode::Automatic);
+    matrix::SquareMat::setSparseThreshold(0.1);
+    matrix::SquareMat::resetFormatStats();
+}
+
+TEST_CASE("StructuredMat Storage and Operators") {
+    matrix::SquareMat dense(4);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            dense[i][j] = i * 4 + j + 1;
+        }
+    }
+
+    matrix::StructuredMat diag(matrix::Structure::Diagonal, 4);
+    for (int i = 0; i < 4; ++i) {
+        diag.set(i, i, i + 1.0);
+    }
+    CHECK(diag.getStoredCount() == 4);
+    CHECK(diag.get(1, 2) == 0.0);
+    CHECK_THROWS_AS(diag.set(1, 2, 1.0), std::invalid_argument);
+    CHECK_THROWS_AS(diag.get(4, 0), std::out_of_range);
+    CHECK(areMatricesEqual(diag * dense, diag.toDense() * dense));
+    CHECK(areMatricesEqual(dense * diag, dense * diag.toDense()));
+    CHECK(!diag == 24.0);
+
+    matrix::SquareMat lowerDense(4);
+    lowerDense[0][0] = 2.0;
+    lowerDense[1][0] = 1.0;
+    lowerDense[1][1] = 3.0;
+    lowerDense[2][1] = -1.0;
+    lowerDense[2][2] = 4.0;
+    lowerDense[3][0] = 5.0;
+    lowerDense[3][3] = 0.5;
+    matrix::StructuredMat lower = matrix::StructuredMat::fromDense(lowerDense, matrix::Structure::LowerTriangular);
+    CHECK(lower.getStoredCount() == 10);
+    CHECK(areMatricesEqual(lower.toDense(), lowerDense));
+    CHECK(areMatricesEqual(lower * dense, lowerDense * dense));
+    CHECK(areMatricesEqual(dense * lower, dense * lowerDense));
+    CHECK(!lower == 12.0);
+    matrix::StructuredMat upper = ~lower;
+    CHECK(upper.getStructure() == matrix::Structure::UpperTriangular);
+    CHECK(areMatricesEqual(upper.toDense(), ~lowerDense));
+    CHECK(areMatricesEqual(upper * dense, (~lowerDense) * dense));
+    CHECK(areMatricesEqual(dense * upper, dense * ~lowerDense));
+    CHECK_THROWS_AS(matrix::StructuredMat::fromDense(dense, matrix::Structure::LowerTriangular), std::invalid_argument);
+
+    matrix::SquareMat tridiagonal(5);
+    for (int i = 0; i < 5; ++i) {
+        tridiagonal[i][i] = 2.0 + i;
+        if (i + 1 < 5) {
+            tridiagonal[i][i + 1] = -1.0;
+            tridiagonal[i + 1][i] = 3.0;
+        }
+    }
+    matrix::StructuredMat band = matrix::StructuredMat::fromDense(tridiagonal, matrix::Structure::Banded, 1);
+    CHECK(band.getBandwidth() == 1);
+    CHECK(areMatricesEqual(band.toDense(), tridiagonal));
+    CHECK(areMatricesEqual((~band).toDense(), ~tridiagonal));
+    CHECK(!band == doctest::Approx(!tridiagonal));
+    matrix::SquareMat dense5 = tridiagonal * tridiagonal + tridiagonal;
+    CHECK(areMatricesEqual(band * dense5, tridiagonal * dense5));
+    CHECK(areMatricesEqual(dense5 * band, dense5 * tridiagonal));
+    CHECK_THROWS_AS(matrix::StructuredMat(matrix::Structure::Banded, 3, 3), std::invalid_argument);
+
+    matrix::SquareMat symmetricDense = dense + ~dense;
+    matrix::StructuredMat symmetric = matrix::StructuredMat::fromDense(symmetricDense, matrix::Structure::Symmetric);
+    CHECK(symmetric.getStoredCount() == 10);
+    CHECK(symmetric.get(0, 3) == symmetric.get(3, 0));
+    CHECK(areMatricesEqual(symmetric.toDense(), symmetricDense));
+    CHECK(areMatricesEqual(symmetric * dense, symmetricDense * dense));
+    CHECK(areMatricesEqual(dense * symmetric, dense * symmetricDense));
+    CHECK(!symmetric == doctest::Approx(!symmetricDense));
+    CHECK_THROWS_AS(matrix::StructuredMat::fromDense(dense, matrix::Structure::Symmetric), std::invalid_argument);
+}
+
+TEST_CASE("SquareMat Linear Solve and Inverse") {
+    matrix::SquareMat a(5);
+    double values[5][5] = {{2, -1, 0, 3, 1},
+                           {4, 1, -2, 0, 5},
+                           {-3, 2, 6, 1, 0},
+                           {1, 0, 2, 7, -1},
+                           {0, 3, -1, 2, 4}};
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            a[i][j] = values[i][j];
+        }
+    }
+    matrix::SquareMat identity(5);
+    for (int i = 0; i < 5; ++i) {
+        identity[i][i] = 1.0;
+    }
+
+    // Reference determinant through cofactor expansion along the first row.
+    double cofactorDet = 0.0;
+    for (int j = 0; j < 5; ++j) {
+        matrix::SquareMat minor(4);
+        for (int r = 1; r < 5; ++r) {
+            for (int c = 0, mc = 0; c < 5; ++c) {
+                if (c != j) {
+                    minor[r - 1][mc++] = a[r][c];
+                }
+            }
+        }
+        double sign = (j % 2 == 0) ? 1.0 : -1.0;
+        matrix::LUDecomposition minorLu(minor);
+        cofactorDet += sign * a[0][j] * minorLu.determinant();
+    }
+
+    matrix::LUDecomposition lu(a, 2);
+    CHECK_FALSE(lu.isSingular());
+    CHECK(lu.determinant() == doctest::Approx(cofactorDet));
+    CHECK(!a == doctest::Approx(cofactorDet));
+
+    // P * A == L * U
+    matrix::SquareMat permuted(5);
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            permuted[i][j] = a[lu.getPivots()[i]][j];
+        }
+    }
+    CHECK(areMatricesEqual(lu.getLower() * lu.getUpper(), permuted));
+
+    std::vector<double> b(5);
+    for (int i = 0; i < 5; ++i) {
+        b[i] = i + 1.0;
+    }
+    std::vector<double> x = matrix::solve(a, b);
+    for (int i = 0; i < 5; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < 5; ++j) {
+            sum += a[i][j] * x[j];
+        }
+        CHECK(sum == doctest::Approx(b[i]));
+    }
+
+    matrix::SquareMat rhs = a * a;
+    CHECK(areMatricesEqual(matrix::solve(a, rhs), a));
+    CHECK(areMatricesEqual(a * a.inverse(), identity));
+    CHECK(areMatricesEqual(lu.inverse(), a.inverse()));
+
+    // Symmetric positive definite: A^T * A + I goes through Cholesky.
+    matrix::SquareMat spd = ~a * a + identity;
+    matrix::CholeskyDecomposition cholesky(spd);
+    const matrix::SquareMat& l = cholesky.getLower();
+    CHECK(areMatricesEqual(l * ~l, spd));
+    CHECK(cholesky.determinant() == doctest::Approx(!spd));
+    CHECK(areMatricesEqual(spd * cholesky.inverse(), identity));
+    std::vector<double> y = cholesky.solve(b);
+    std::vector<double> yLu = matrix::LUDecomposition(spd).solve(b);
+    for (int i = 0; i < 5; ++i) {
+        CHECK(y[i] == doctest::Approx(yLu[i]));
+    }
+    CHECK(areMatricesEqual(matrix::solve(spd, rhs), matrix::LUDecomposition(spd).solve(rhs)));
+    CHECK_THROWS_AS(matrix::CholeskyDecomposition(a).determinant(), std::invalid_argument);
+
+    matrix::SquareMat singular(4);
+    singular[0][0] = 1.0;
+    singular[1][1] = 1.0;
+    singular[2][2] = 1.0;
+    matrix::LUDecomposition singularLu(singular);
+    CHECK(singularLu.isSingular());
+    CHECK(!singular == 0.0);
+    CHECK_THROWS_AS(singular.inverse(), std::invalid_argument);
+    CHECK_THROWS_AS(singularLu.solve(std::vector<double>(4, 1.0)), std::invalid_argument);
+    CHECK_THROWS_AS(lu.solve(std::vector<double>(3, 1.0)), std::invalid_argument);
+}
+
+TEST_CASE("Factorization Objects and Cached LU") {
+    matrix::SquareMat a(4);
+    double values[4][4] = {{4, -2, 1, 3},
+                           {2, 5, -1, 0},
+                           {-1, 3, 6, 2},
+                           {0, 1, -2, 7}};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            a[i][j] = values[i][j];
+        }
+    }
+    matrix::SquareMat identity(4);
+    for (int i = 0; i < 4; ++i) {
+        identity[i][i] = 1.0;
+    }
+
+    matrix::LUDecomposition lu(a);
+    matrix::QRDecomposition qr(a);
+    double det = lu.determinant();
+    CHECK(qr.determinant() == doctest::Approx(det));
+    CHECK(areMatricesEqual(qr.getQ() * qr.getR(), a));
+    CHECK(areMatricesEqual(qr.getQ() * ~qr.getQ(), identity));
+    CHECK(areMatricesEqual(qr.inverse(), lu.inverse()));
+    CHECK(areMatricesEqual(qr.solve(a * a), a));
+    std::vector<double> b(4, 1.0);
+    std::vector<double> xLu = lu.solve(b);
+    std::vector<double> xQr = qr.solve(b);
+    for (int i = 0; i < 4; ++i) {
+        CHECK(xQr[i] == doctest::Approx(xLu[i]));
+    }
+
+    matrix::LogDeterminant logLu = lu.logDeterminant();
+    matrix::LogDeterminant logQr = qr.logDeterminant();
+    CHECK(logLu.sign * std::exp(logLu.logAbs) == doctest::Approx(det));
+    CHECK(logQr.sign == logLu.sign);
+    CHECK(logQr.logAbs == doctest::Approx(logLu.logAbs));
+    long exponent = 0;
+    const double mantissa = lu.scaledDeterminant(exponent);
+    CHECK(std::fabs(mantissa) >= 0.5);
+    CHECK(std::fabs(mantissa) < 1.0);
+    CHECK(std::ldexp(mantissa, static_cast<int>(exponent)) == lu.determinant());
+    matrix::SquareMat spd = ~a * a;
+    matrix::LogDeterminant logCholesky = matrix::CholeskyDecomposition(spd).logDeterminant();
+    CHECK(logCholesky.sign == 1);
+    CHECK(logCholesky.logAbs == doctest::Approx(2.0 * logLu.logAbs));
+
+    matrix::SquareMat singular(4);
+    singular[0][0] = 1.0;
+    CHECK(matrix::LUDecomposition(singular).logDeterminant().sign == 0);
+    CHECK(matrix::LUDecomposition(singular).scaledDeterminant(exponent) == 0.0);
+    CHECK(exponent == 0);
+    CHECK(matrix::QRDecomposition(singular).isSingular());
+    CHECK(matrix::QRDecomposition(singular).determinant() == 0.0);
+
+    // The cache is filled on demand and dropped by every kind of mutation.
+    CHECK_FALSE(a.hasCachedFactorization());
+    CHECK(a.getLU().determinant() == doctest::Approx(det));
+    CHECK(a.hasCachedFactorization());
+    CHECK(!a == doctest::Approx(det));
+    a.set(0, 0, 5.0);
+    CHECK_FALSE(a.hasCachedFactorization());
+    CHECK(!a == doctest::Approx(matrix::LUDecomposition(a).determinant()));
+
+    a.setFactorCaching(true);
+    double changedDet = !a;
+    CHECK(a.hasCachedFactorization());
+    CHECK(areMatricesEqual(a * a.inverse(), identity));
+    CHECK(a.hasCachedFactorization());
+    a[1][1] = 6.0;
+    CHECK_FALSE(a.hasCachedFactorization());
+    CHECK(!a != doctest::Approx(changedDet));
+    ++a;
+    CHECK_FALSE(a.hasCachedFactorization());
+    a.getLU();
+    a += identity;
+    CHECK_FALSE(a.hasCachedFactorization());
+    a.getLU();
+    a *= identity;
+    CHECK_FALSE(a.hasCachedFactorization());
+    a.getLU();
+    a /= 2.0;
+    CHECK_FALSE(a.hasCachedFactorization());
+    CHECK(!a == doctest::Approx(matrix::LUDecomposition(a).determinant()));
+    CHECK(a.hasCachedFactorization());
+    // Copies take the setting of their source, whether constructed or assigned.
+    matrix::SquareMat constructed = a;
+    matrix::SquareMat assigned(3);
+    assigned = a;
+    CHECK_FALSE(constructed.hasCachedFactorization());
+    CHECK_FALSE(assigned.hasCachedFactorization());
+    CHECK(!constructed == doctest::Approx(!a));
+    CHECK(!assigned == doctest::Approx(!a));
+    CHECK(constructed.hasCachedFactorization());
+    CHECK(assigned.hasCachedFactorization());
+
+    a.setFactorCaching(false);
+    CHECK_FALSE(a.hasCachedFactorization());
+    assigned = a;
+    CHECK(!assigned == doctest::Approx(!a));
+    CHECK_FALSE(assigned.hasCachedFactorization());
+
+    const matrix::SquareMat constant(a);
+    CHECK_FALSE(constant.hasCachedFactorization());
+    CHECK(constant[0][0] == a[0][0]);
+    constant.getLU();
+    CHECK(constant[0][0] == a[0][0]);
+    CHECK(constant.hasCachedFactorization());
+}
+
+TEST_CASE("TaskScheduler and Parallel LU") {
+    matrix::TaskScheduler scheduler(4);
+    CHECK(scheduler.getThreadCount() == 4);
+
+    // A diamond: 0 -> {1, 2} -> 3, recording the order of execution.
+    std::mutex orderMutex;
+    std::vector<int> order;
+    matrix::TaskGraph graph;
+    for (int i = 0; i < 4; ++i) {
+        graph.addTask([i, &order, &orderMutex] {
+            std::lock_guard<std::mutex> lock(orderMutex);
+            order.push_back(i);
+        });
+    }
+    graph.addDependency(0, 1);
+    graph.addDependency(0, 2);
+    graph.addDependency(1, 3);
+    graph.addDependency(2, 3);
+    graph.run(scheduler);
+    REQUIRE(order.size() == 4);
+    CHECK(order.front() == 0);
+    CHECK(order.back() == 3);
+    CHECK_THROWS_AS(graph.addDependency(0, 0), std::invalid_argument);
+
+    // A root beside a cycle: nothing may run, not even the root.
+    std::atomic<int> started(0);
+    matrix::TaskGraph cyclic;
+    for (int i = 0; i < 3; ++i) {
+        cyclic.addTask([&started] { ++started; });
+    }
+    cyclic.addDependency(1, 2);
+    cyclic.addDependency(2, 1);
+    CHECK_THROWS_AS(cyclic.run(scheduler), std::invalid_argument);
+    CHECK(started.load() == 0);
+
+    matrix::TaskGraph failing;
+    failing.addTask([] { throw std::runtime_error("task failed"); });
+    CHECK_THROWS_AS(failing.run(scheduler), std::runtime_error);
+
+    // Many independent tasks, some waiting on nested graphs from inside a worker.
+    std::atomic<int> counter(0);
+    matrix::TaskGraph wide;
+    for (int i = 0; i < 64; ++i) {
+        wide.addTask([&counter, &scheduler] {
+            matrix::TaskGraph inner;
+            inner.addTask([&counter] { ++counter; });
+            inner.run(scheduler);
+        });
+    }
+    wide.run(scheduler);
+    CHECK(counter.load() == 64);
+
+    const int n = 150;
+    matrix::SquareMat a(n);
+    unsigned seed = 12345;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            seed = seed * 1103515245u + 12345u;
+            a[i][j] = static_cast<double>((seed >> 16) % 2001) / 1000.0 - 1.0;
+        }
+    }
+    matrix::LUDecomposition serial(a, 16);
+    matrix::LUDecomposition parallel(a, scheduler, 16);
+    CHECK(parallel.getPivots() == serial.getPivots());
+    CHECK(parallel.determinant() == serial.determinant());
+    matrix::SquareMat serialUpper = serial.getUpper();
+    matrix::SquareMat parallelUpper = parallel.getUpper();
+    matrix::SquareMat serialLower = serial.getLower();
+    matrix::SquareMat parallelLower = parallel.getLower();
+    bool identical = true;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            identical = identical && serialUpper[i][j] == parallelUpper[i][j] &&
+                        serialLower[i][j] == parallelLower[i][j];
+        }
+    }
+    CHECK(identical);
+
+    matrix::SquareMat singular(40);
+    for (int i = 0; i < 39; ++i) {
+        singular[i][i] = 1.0;
+    }
+    CHECK(matrix::LUDecomposition(singular, scheduler, 8).isSingular());
+}
+
+TEST_CASE("BasicSquareMat Element Types") {
+    // 64-bit integers: exact arithmetic well beyond the range of int.
+    matrix::BasicSquareMat<std::int64_t> big(2);
+    big[0][0] = 3000000000LL; big[0][1] = 7;
+    big[1][0] = 3;            big[1][1] = 2000000000LL;
+    matrix::BasicSquareMat<std::int64_t> rem = big % 2500000000LL;
+    CHECK(rem[0][0] == 500000000LL);
+    CHECK(rem[1][1] == 2000000000LL);
+    CHECK(!big == 3000000000LL * 2000000000LL - 21);
+    CHECK_THROWS_AS(big % 0, std::invalid_argument);
+
+    // Integer determinant beyond 3x3 is fraction-free and exact.
+    matrix::BasicSquareMat<std::int64_t> ints(5);
+    for (int i = 0; i < 5; ++i) {
+        for (int j = 0; j < 5; ++j) {
+            ints[i][j] = (i == j) ? 2 : (j == i + 1 ? -1 : 0);
+        }
+    }
+    CHECK(!ints == 32);
+    ints[0][0] = 0;
+    ints[1][0] = 1;
+    CHECK(!ints == 8); // Needs a row swap on the zero pivot.
+
+    // 32-bit integers and float share the same kernels.
+    matrix::BasicSquareMat<std::int32_t> small(3);
+    small[0][0] = 1; small[1][1] = 2; small[2][2] = 3;
+    CHECK((small * small)[2][2] == 9);
+    CHECK((2 * small)[1][1] == 4);
+
+    matrix::BasicSquareMat<float> f(4);
+    for (int i = 0; i < 4; ++i) {
+        f[i][i] = 0.5f;
+    }
+    CHECK(!f == doctest::Approx(0.0625));
+    CHECK((f / 0.5f)[3][3] == doctest::Approx(1.0f));
+
+    // Complex numbers: ordered by magnitude, no modulo.
+    typedef std::complex<double> Complex;
+    matrix::BasicSquareMat<Complex> c(2);
+    c[0][0] = Complex(0, 1); c[0][1] = Complex(1, 0);
+    c[1][0] = Complex(1, 0); c[1][1] = Complex(0, -1);
+    Complex det = !c;
+    CHECK(det.real() == doctest::Approx(0.0));
+    CHECK(det.imag() == doctest::Approx(0.0));
+    matrix::BasicSquareMat<Complex> squared = c * c;
+    CHECK(squared[0][0].real() == doctest::Approx(0.0));
+    CHECK(squared[0][1].real() == doctest::Approx(0.0));
+    CHECK(std::abs(squared[1][1]) == doctest::Approx(0.0));
+    CHECK_THROWS_AS(c % Complex(2, 0), std::invalid_argument);
+    matrix::BasicSquareMat<Complex> larger = c * Complex(0, 2);
+    CHECK(larger > c);
+    matrix::BasicSquareMat<Complex> c5(5);
+    for (int i = 0; i < 5; ++i) {
+        c5[i][i] = Complex(0, 1);
+    }
+    Complex det5 = !c5;
+    CHECK(det5.real() == doctest::Approx(0.0));
+    CHECK(det5.imag() == doctest::Approx(1.0));
+
+    // SquareMat stays the double instantiation.
+    CHECK((std::is_same<matrix::SquareMat, matrix::BasicSquareMat<double>>::value));
+}
+
+TEST_CASE("ModMat Modular Arithmetic") {
+    const std::uint64_t prime = 1000000007ULL;
+
+    // Fibonacci: [[1,1],[1,0]]^n holds F(n+1), F(n), F(n - 1).
+    matrix::ModMat fib(2, prime);
+    fib.set(0, 0, 1); fib.set(0, 1, 1);
+    fib.set(1, 0, 1);
+    CHECK(fib.getReduction() == matrix::ModReduction::Montgomery);
+    matrix::ModMat f90 = fib ^ 90;
+    CHECK(f90.get(0, 1) == 2880067194370816120ULL % prime); // F(90) fits in int64.
+    matrix::ModMat huge = fib ^ 1000000000000000000LL;
+    CHECK(huge.get(0, 1) == 209783453ULL); // F(10^18) mod 1e9+7
+    CHECK((fib ^ 0).get(1, 1) == 1);
+    CHECK_THROWS_AS(fib ^ -1, std::invalid_argument);
+
+    // Negative inputs, addition, subtraction and negation stay in [0, m).
+    matrix::ModMat a(2, 7);
+    a.set(0, 0, -1); a.set(0, 1, 10);
+    a.set(1, 0, INT64_MIN); a.set(1, 1, 6);
+    CHECK(a.get(0, 0) == 6);
+    CHECK(a.get(0, 1) == 3);
+    CHECK(a.get(1, 0) == 6); // -2^63 = -(7 * 1317624576693539401 + 1)
+    CHECK((a + a).get(1, 1) == 5);
+    CHECK((a - a * 2).get(0, 1) == 4);
+    CHECK((-a).get(0, 0) == 1);
+    CHECK((a * -1) == -a);
+    CHECK_THROWS_AS(a + fib, std::invalid_argument);
+    CHECK_THROWS_AS(a.get(2, 0), std::out_of_range);
+    CHECK_THROWS_AS(matrix::ModMat(2, 1), std::invalid_argument);
+
+    // Near 2^63 several partial reductions happen per element; compare with the
+    // reduction of each product taken separately.
+    const std::uint64_t moduli[] = {9223372036854775783ULL, 9223372036854775806ULL, 4294967296ULL};
+    for (int m = 0; m < 3; ++m) {
+        const int n = 9;
+        matrix::ModMat x(n, moduli[m]);
+        matrix::ModMat y(n, moduli[m]);
+        unsigned seed = 99;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                seed = seed * 1103515245u + 12345u;
+                x.set(i, j, -static_cast<std::int64_t>(seed) * 2147483647LL);
+                y.set(i, j, static_cast<std::int64_t>(seed) * 4294967291LL + (i == j ? INT64_MAX / 2 : 0));
+            }
+        }
+        CHECK(x.getReduction() == (moduli[m] % 2 ? matrix::ModReduction::Montgomery : matrix::ModReduction::Barrett));
+        matrix::ModMat product = x * y;
+        bool exact = true;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                __extension__ typedef unsigned __int128 Wide;
+                Wide expected = 0;
+                for (int k = 0; k < n; ++k) {
+                    expected = (expected + static_cast<Wide>(x.get(i, k)) * y.get(k, j)) % moduli[m];
+                }
+                exact = exact && product.get(i, j) == static_cast<std::uint64_t>(expected);
+            }
+        }
+        CHECK(exact);
+        CHECK((x ^ 5) == x * x * x * x * x);
+    }
+
+    // Conversion from and to integer matrices.
+    matrix::BasicSquareMat<std::int64_t> ints(2);
+    ints[0][0] = -8; ints[1][1] = 15;
+    matrix::ModMat reduced(ints, 5);
+    CHECK(reduced.toMatrix()[0][0] == 2);
+    CHECK(reduced.toMatrix()[1][1] == 0);
+}
+
+TEST_CASE("Mixed-Precision Multiplication") {
+    const int n = 96;
+    matrix::SquareMat a(n);
+    matrix::SquareMat b(n);
+    unsigned seed = 2024;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            seed = seed * 1103515245u + 12345u;
+            a[i][j] = static_cast<double>((seed >> 8) % 20001) / 10000.0 - 1.0;
+            seed = seed * 1103515245u + 12345u;
+            b[i][j] = static_cast<double>((seed >> 8) % 20001) / 10000.0 - 1.0;
+        }
+    }
+    matrix::FloatMat fa = matrix::toFloat(a);
+    matrix::FloatMat fb = matrix::toFloat(b);
+    matrix::SquareMat exact = matrix::toDouble(fa) * matrix::toDouble(fb); // Same operands, double throughout.
+    matrix::SquareMat reference = a * b;                                  // Operands before rounding.
+
+    // |A| * |B| scales the error bounds of each element.
+    matrix::SquareMat absA(n), absB(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            absA[i][j] = std::abs(a[i][j]);
+            absB[i][j] = std::abs(b[i][j]);
+        }
+    }
+    matrix::SquareMat scale = absA * absB;
+
+    const double floatEps = 1.0 / (1 << 24);
+    const double doubleEps = floatEps * floatEps / (1 << 5);
+    matrix::SquareMat viaDouble = matrix::multiplyToDouble(fa, fb, matrix::Accumulation::Double);
+    matrix::SquareMat viaKahan = matrix::multiplyToDouble(fa, fb, matrix::Accumulation::Compensated);
+    matrix::SquareMat viaFloat = matrix::multiplyToDouble(fa, fb, matrix::Accumulation::Float);
+    matrix::FloatMat rounded = matrix::multiply(fa, fb, matrix::Accumulation::Compensated);
+    bool withinBounds = true;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            const double s = scale[i][j];
+            withinBounds = withinBounds && std::abs(viaDouble[i][j] - exact[i][j]) <= 2 * n * doubleEps * s;
+            withinBounds = withinBounds && std::abs(viaKahan[i][j] - exact[i][j]) <= 4 * floatEps * s;
+            withinBounds = withinBounds && std::abs(viaFloat[i][j] - exact[i][j]) <= n * floatEps * s;
+            withinBounds = withinBounds && std::abs(rounded[i][j] - exact[i][j]) <= 6 * floatEps * s;
+            // Against the double product of the unrounded operands, only the operand rounding remains.
+            withinBounds = withinBounds && std::abs(viaDouble[i][j] - reference[i][j]) <= 3 * floatEps * s;
+        }
+    }
+    CHECK(withinBounds);
+
+    // Long sums of 0.1f: compensation removes the drift of plain float accumulation.
+    const int m = 2048;
+    matrix::FloatMat ones(m), tenths(m);
+    for (int k = 0; k < m; ++k) {
+        ones[0][k] = 1.0f;
+        tenths[k][0] = 0.1f;
+    }
+    const double target = m * static_cast<double>(0.1f);
+    double floatError = std::abs(matrix::multiply(ones, tenths, matrix::Accumulation::Float)[0][0] - target);
+    double kahanError = std::abs(matrix::multiply(ones, tenths, matrix::Accumulation::Compensated)[0][0] - target);
+    double doubleError = std::abs(matrix::multiplyToDouble(ones, tenths, matrix::Accumulation::Double)[0][0] - target);
+    CHECK(kahanError < floatError);
+    CHECK(kahanError <= floatEps * target);
+    CHECK(doubleError < 1e-12);
+
+    CHECK_THROWS_AS(matrix::multiply(fa, ones, matrix::Accumulation::Double), std::invalid_argument);
+}
+
+TEST_CASE("Refined Single-Precision LU Solve") {
+    const int n = 120;
+    matrix::SquareMat a(n);
+    std::vector<double> b(n);
+    unsigned seed = 77;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            seed = seed * 1103515245u + 12345u;
+            a[i][j] = static_cast<double>((seed >> 8) % 20001) / 10000.0 - 1.0;
+        }
+        a[i][i] += 8.0;
+        b[i] = std::sin(i + 1.0);
+    }
+    matrix::RefinedLUSolver refined(a);
+    std::vector<double> x = refined.solve(b);
+    std::vector<double> expected = matrix::LUDecomposition(a).solve(b);
+    double maxDifference = 0.0;
+    for (int i = 0; i < n; ++i) {
+        maxDifference = std::max(maxDifference, std::abs(x[i] - expected[i]));
+    }
+    CHECK(maxDifference < 1e-13);
+    CHECK(!refined.usedFallback());
+    CHECK(refined.getIterations() >= 1);
+    CHECK(refined.getIterations() <= 5);
+
+    // Matrix right-hand side: the inverse, residual through operator*.
+    matrix::SquareMat identity(n);
+    for (int i = 0; i < n; ++i) {
+        identity[i][i] = 1.0;
+    }
+    matrix::SquareMat inverse = refined.solve(identity);
+    CHECK(!refined.usedFallback());
+    CHECK(areMatricesEqual(a * inverse, identity, 1e-12));
+
+    std::vector<double> viaMode = matrix::solve(a, b, matrix::SolvePrecision::Refined);
+    CHECK(std::abs(viaMode[7] - expected[7]) < 1e-13);
+
+    // Hilbert matrix: condition number ~1e13, beyond float; refinement stalls and falls back.
+    const int h = 10;
+    matrix::SquareMat hilbert(h);
+    std::vector<double> ones(h, 1.0);
+    for (int i = 0; i < h; ++i) {
+        for (int j = 0; j < h; ++j) {
+            hilbert[i][j] = 1.0 / (i + j + 1);
+        }
+    }
+    matrix::RefinedLUSolver illConditioned(hilbert);
+    std::vector<double> y = illConditioned.solve(ones);
+    CHECK(illConditioned.usedFallback());
+    std::vector<double> direct = matrix::LUDecomposition(hilbert).solve(ones);
+    CHECK(y == direct);
+
+    matrix::SquareMat singular(3);
+    singular[0][0] = 1.0;
+    matrix::RefinedLUSolver noSolution(singular);
+    CHECK_THROWS_AS(noSolution.solve(std::vector<double>(3, 1.0)), std::invalid_argument);
+    CHECK_THROWS_AS(refined.solve(std::vector<double>(3, 1.0)), std::invalid_argument);
+}
+
+TEST_CASE("Strassen-Winograd Multiplication") {
+    // Odd sizes on the way down exercise the peeling at several levels.
+    const int sizes[] = {1, 2, 7, 16, 45, 100};
+    for (int s = 0; s < 6; ++s) {
+        const int n = sizes[s];
+        matrix::BasicSquareMat<std::int64_t> a(n), b(n);
+        matrix::SquareMat da(n), db(n);
+        unsigned seed = 5 + n;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                seed = seed * 1103515245u + 12345u;
+                a[i][j] = static_cast<std::int64_t>((seed >> 8) % 2001) - 1000;
+                seed = seed * 1103515245u + 12345u;
+                b[i][j] = static_cast<std::int64_t>((seed >> 8) % 2001) - 1000;
+                da[i][j] = a[i][j] / 1000.0;
+                db[i][j] = b[i][j] / 1000.0;
+            }
+        }
+        // Integer products are exact whatever the order of the operations.
+        matrix::BasicSquareMat<std::int64_t> exact = a * b;
+        matrix::BasicSquareMat<std::int64_t> fast = matrix::multiplyStrassen(a, b, 4);
+        bool same = true;
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                same = same && exact[i][j] == fast[i][j];
+            }
+        }
+        CHECK(same);
+        // Floating point: within a small multiple of the classical error.
+        CHECK(areMatricesEqual(matrix::multiplyStrassen(da, db, 3), da * db, 1e-11 * n));
+    }
+
+    // operator* switches to Strassen above the crossover once enabled.
+    matrix::SquareMat a(40), b(40);
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 40; ++j) {
+            a[i][j] = (i * 7 + j * 3) % 11 - 5;
+            b[i][j] = (i * 5 + j) % 13 - 6;
+        }
+    }
+    matrix::SquareMat classical = a * b;
+    matrix::SquareMat::setStrassenCrossover(8);
+    CHECK(matrix::SquareMat::getStrassenCrossover() == 8);
+    matrix::SquareMat viaOperator = a * b;
+    matrix::SquareMat::setStrassenCrossover(0);
+    CHECK(areMatricesEqual(viaOperator, classical, 1e-9)); // Small integers: exact in double too.
+    CHECK_THROWS_AS(matrix::SquareMat::setStrassenCrossover(-1), std::invalid_argument);
+    CHECK_THROWS_AS(matrix::multiplyStrassen(a, b, 0), std::invalid_argument);
+
+    // Into a caller's matrix, overwriting it, but never into an operand.
+    matrix::SquareMat into(40);
+    into[3][4] = 1e9;
+    matrix::multiplyStrassen(a, b, into, 8);
+    CHECK(areMatricesEqual(into, classical, 1e-9));
+    matrix::SquareMat small(39);
+    CHECK_THROWS_AS(matrix::multiplyStrassen(a, b, small, 8), std::invalid_argument);
+    CHECK_THROWS_AS(matrix::multiplyStrassen(a, b, a, 8), std::invalid_argument);
+}
+
+TEST_CASE("Batched Multiplication") {
+    // Mixed sizes, partial groups of lanes and one entry above BATCH_MAX_SIZE.
+    const int sizes[] = {3, 4, 17, 3, 40, 32};
+    std::vector<matrix::SquareMat> left, right;
+    unsigned seed = 8;
+    for (int e = 0; e < 45; ++e) {
+        const int n = sizes[e % 6];
+        matrix::SquareMat x(n), y(n);
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                seed = seed * 1103515245u + 12345u;
+                x[i][j] = static_cast<double>((seed >> 8) % 2001) / 1000.0 - 1.0;
+                seed = seed * 1103515245u + 12345u;
+                y[i][j] = static_cast<double>((seed >> 8) % 2001) / 1000.0 - 1.0;
+            }
+        }
+        left.push_back(x);
+        right.push_back(y);
+    }
+    matrix::TaskScheduler scheduler(3);
+    std::vector<matrix::SquareMat> results;
+    matrix::multiplyBatch(left, right, results, scheduler);
+    REQUIRE(results.size() == left.size());
+    bool same = true;
+    for (size_t e = 0; e < left.size(); ++e) {
+        same = same && results[e].getSize() == left[e].getSize() &&
+               areMatricesEqual(results[e], left[e] * right[e], 1e-12);
+    }
+    CHECK(same);
+
+    std::vector<matrix::SquareMat> empty;
+    matrix::multiplyBatch(empty, empty, results);
+    CHECK(results.empty());
+    right.pop_back();
+    CHECK_THROWS_AS(matrix::multiplyBatch(left, right, results), std::invalid_argument);
+    right.push_back(matrix::SquareMat(5));
+    CHECK_THROWS_AS(matrix::multiplyBatch(left, right, results), std::invalid_argument);
+}
+
+TEST_CASE("Fused GEMM") {
+    const int n = 9;
+    matrix::SquareMat a(n), b(n), c(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            a[i][j] = (i + 2 * j) % 5 - 2.0;
+            b[i][j] = (3 * i + j) % 7 - 3.0;
+            c[i][j] = i - j;
+        }
+    }
+    matrix::SquareMat expected = a * b * 0.5 + c * 2.0;
+    matrix::SquareMat fused(c);
+    matrix::gemm(0.5, a, b, 2.0, fused);
+    CHECK(areMatricesEqual(fused, expected, 1e-12));
+
+    // C += A * B and C -= A * B.
+    matrix::SquareMat accumulated(c);
+    matrix::gemm(1.0, a, b, 1.0, accumulated);
+    CHECK(areMatricesEqual(accumulated, c + a * b, 1e-12));
+    matrix::gemm(-1.0, a, b, 1.0, accumulated);
+    CHECK(areMatricesEqual(accumulated, c, 1e-12));
+
+    // beta = 0 ignores the previous contents, even NaN.
+    matrix::SquareMat garbage(n);
+    for (int i = 0; i < n; ++i) {
+        garbage[i][i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    matrix::gemm(1.0, a, b, 0.0, garbage);
+    CHECK(areMatricesEqual(garbage, a * b, 1e-12));
+
+    // C aliasing an operand.
+    matrix::SquareMat squared(a);
+    matrix::gemm(1.0, squared, squared, 1.0, squared);
+    CHECK(areMatricesEqual(squared, a * a + a, 1e-12));
+
+    // A cached factorization of C is dropped.
+    matrix::SquareMat target(n);
+    for (int i = 0; i < n; ++i) {
+        target[i][i] = 2.0;
+    }
+    target.getLU();
+    matrix::gemm(1.0, a, b, 1.0, target);
+    CHECK(!target.hasCachedFactorization());
+
+    matrix::BasicSquareMat<std::int64_t> ia(2), ic(2);
+    ia[0][0] = 3; ia[0][1] = 1; ia[1][1] = 2;
+    ic[1][0] = 5;
+    matrix::gemm<std::int64_t>(2, ia, ia, -1, ic);
+    CHECK(ic[0][0] == 18);
+    CHECK(ic[0][1] == 10);
+    CHECK(ic[1][0] == -5);
+    CHECK(ic[1][1] == 8);
+
+    matrix::SquareMat small(2);
+    CHECK_THROWS_AS(matrix::gemm(1.0, a, small, 1.0, c), std::invalid_argument);
+}
+
+TEST_CASE("Vector Operations") {
+    matrix::Vector x(std::vector<double>{3.0, -4.0, 0.0});
+    matrix::Vector y(3);
+    y[0] = 1.0; y[1] = 2.0; y.set(2, 5.0);
+    CHECK(x.getSize() == 3);
+    CHECK(x.dot(y) == -5.0);
+    CHECK(x.norm1() == 7.0);
+    CHECK(x.norm2() == doctest::Approx(5.0));
+    CHECK(x.normInf() == 4.0);
+    CHECK((x + y) == matrix::Vector(std::vector<double>{4.0, -2.0, 5.0}));
+    CHECK((x - y) == matrix::Vector(std::vector<double>{2.0, -6.0, -5.0}));
+    CHECK((2.0 * x) == x * 2.0);
+    matrix::Vector z(x);
+    z.axpy(-2.0, y);
+    CHECK(z == matrix::Vector(std::vector<double>{1.0, -8.0, -10.0}));
+    CHECK(z.toStdVector() == std::vector<double>{1.0, -8.0, -10.0});
+
+    // The scaled Euclidean norm neither overflows nor underflows.
+    matrix::Vector huge(std::vector<double>{3e200, 4e200});
+    CHECK(huge.norm2() == doctest::Approx(5e200));
+    matrix::Vector tiny(std::vector<double>{3e-200, 4e-200});
+    CHECK(tiny.norm2() == doctest::Approx(5e-200));
+
+    // Products against the one-column matrix emulation, large enough for the parallel path.
+    const int sizes[] = {5, 300};
+    for (int s = 0; s < 2; ++s) {
+        const int n = sizes[s];
+        matrix::SquareMat a(n), column(n);
+        matrix::Vector v(n);
+        for (int i = 0; i < n; ++i) {
+            v[i] = (i % 7) - 3.0;
+            column[i][0] = v[i];
+            for (int j = 0; j < n; ++j) {
+                a[i][j] = (i * 3 + j * 5) % 11 - 5.0;
+            }
+        }
+        matrix::Vector ax = a * v;
+        matrix::Vector xa = v * a;
+        matrix::SquareMat expected = a * column;
+        matrix::SquareMat transposed = ~a * column;
+        for (int i = 0; i < n; ++i) {
+            CHECK(ax[i] == expected[i][0]);
+            CHECK(xa[i] == transposed[i][0]);
+        }
+        CHECK(v.dot(ax) == doctest::Approx(xa.dot(v)));
+    }
+
+    std::stringstream ss;
+    ss << y;
+    CHECK(ss.str() == "V_3:\n[ 1 2 5 ]\n");
+
+    CHECK_THROWS_AS(matrix::Vector(0), std::invalid_argument);
+    CHECK_THROWS_AS(x.dot(matrix::Vector(2)), std::invalid_argument);
+    CHECK_THROWS_AS(x.axpy(1.0, matrix::Vector(4)), std::invalid_argument);
+    CHECK_THROWS_AS(matrix::SquareMat(2) * x, std::invalid_argument);
+    CHECK_THROWS_AS(x[3], std::out_of_range);
+    CHECK_THROWS_AS(x.get(-1), std::out_of_range);
+}
+
+TEST_CASE("Matrix Chain Ordering") {
+    const int n = 7;
+    matrix::SquareMat a(n), b(n);
+    matrix::StructuredMat diagonal(matrix::Structure::Diagonal, n);
+    matrix::StructuredMat scale(matrix::Structure::Diagonal, n);
+    matrix::StructuredMat band(matrix::Structure::Banded, n, 1);
+    matrix::StructuredMat lower(matrix::Structure::LowerTriangular, n);
+    matrix::StructuredMat upper(matrix::Structure::UpperTriangular, n);
+    matrix::StructuredMat symmetric(matrix::Structure::Symmetric, n);
+    for (int i = 0; i < n; ++i) {
+        diagonal.set(i, i, i + 1.0);
+        scale.set(i, i, 0.5 * (i % 3) - 1.0);
+        for (int j = 0; j < n; ++j) {
+            a[i][j] = (i * 2 + j) % 5 - 2.0;
+            b[i][j] = (i + 3 * j) % 7 - 3.0;
+            if (j >= i - 1 && j <= i + 1) {
+                band.set(i, j, i - j + 0.25);
+            }
+            if (j <= i) {
+                lower.set(i, j, i + j + 1.0);
+                upper.set(j, i, i - j - 1.5);
+                symmetric.set(i, j, i * j - 2.0);
+            }
+        }
+    }
+
+    // The structured factors are multiplied together before meeting the dense one.
+    matrix::MatrixChain chain;
+    chain.append(a).append(diagonal).append(scale).append(band);
+    CHECK(chain.getLength() == 4);
+    CHECK(chain.getOrder() == "(0 ((1 2) 3))");
+    CHECK(chain.getCost() < chain.getLeftToRightCost());
+    matrix::SquareMat expected = a * diagonal.toDense() * scale.toDense() * band.toDense();
+    CHECK(areMatricesEqual(chain.evaluate(), expected, 1e-9));
+
+    // Dense chains keep the left-to-right order.
+    matrix::MatrixChain dense;
+    dense.append(a).append(b).append(a);
+    CHECK(dense.getOrder() == "((0 1) 2)");
+    CHECK(dense.getCost() == dense.getLeftToRightCost());
+    CHECK(areMatricesEqual(dense.evaluate(), a * b * a, 1e-9));
+
+    // Every combination of structures against operator* on the dense forms.
+    matrix::MatrixChain mixed;
+    mixed.append(lower).append(upper).append(band).append(symmetric).append(lower).append(lower)
+         .append(b).append(diagonal);
+    matrix::SquareMat mixedExpected = lower.toDense() * upper.toDense() * band.toDense() * symmetric.toDense()
+        * lower.toDense() * lower.toDense() * b * diagonal.toDense();
+    CHECK(areMatricesEqual(mixed.evaluate(), mixedExpected, 1e-6 * std::fabs(mixedExpected[0][0]) + 1e-6));
+
+    // Structured products.
+    matrix::StructuredMat lowerSquared = lower.multiplyStructured(lower);
+    CHECK(lowerSquared.getStructure() == matrix::Structure::LowerTriangular);
+    CHECK(areMatricesEqual(lowerSquared.toDense(), lower.toDense() * lower.toDense(), 1e-9));
+    matrix::StructuredMat bandSquared = band.multiplyStructured(band);
+    CHECK(bandSquared.getStructure() == matrix::Structure::Banded);
+    CHECK(bandSquared.getBandwidth() == 2);
+    CHECK(areMatricesEqual(bandSquared.toDense(), band.toDense() * band.toDense(), 1e-9));
+    CHECK_THROWS_AS(lower.multiplyStructured(upper), std::invalid_argument);
+    CHECK_THROWS_AS(bandSquared.multiplyStructured(bandSquared), std::invalid_argument);
+
+    matrix::MatrixChain single;
+    single.append(diagonal);
+    CHECK(single.getOrder() == "0");
+    CHECK(single.evaluate() == diagonal.toDense());
+    CHECK_THROWS_AS(matrix::MatrixChain().evaluate(), std::invalid_argument);
+    CHECK_THROWS_AS(chain.append(matrix::SquareMat(2)), std::invalid_argument);
+}
+
+TEST_CASE("Asynchronous Operations") {
+    matrix::TaskScheduler scheduler(2);
+    matrix::SquareMat a(3), b(3);
+    a[0][0] = 2; a[0][1] = 1; a[1][1] = 3; a[2][0] = 1; a[2][2] = 1;
+    b[0][0] = 1; b[1][0] = 4; b[1][1] = 1; b[2][1] = 2; b[2][2] = 5;
+
+    // A pipeline of dependent steps, each starting when its inputs are ready.
+    matrix::Future<matrix::SquareMat> product = matrix::asyncMultiply(a, b, scheduler);
+    matrix::Future<matrix::SquareMat> squared = matrix::asyncPower(product, 2);
+    matrix::Future<matrix::SquareMat> sum = matrix::asyncAdd(squared, product);
+    matrix::Future<double> determinant = matrix::asyncDeterminant(sum);
+    matrix::Future<matrix::SquareMat> inverse = matrix::asyncInverse(matrix::asyncMultiply(product, squared));
+    matrix::SquareMat expected = (a * b) * (a * b) + a * b;
+    CHECK(areMatricesEqual(sum.get(), expected, 1e-9));
+    CHECK(determinant.get() == doctest::Approx(!expected));
+    matrix::SquareMat identity(3);
+    identity[0][0] = identity[1][1] = identity[2][2] = 1.0;
+    CHECK(areMatricesEqual(inverse.get() * ((a * b) * (a * b) * (a * b)), identity, 1e-9));
+    CHECK(sum.isReady());
+
+    // Continuations, also attached after the value is ready.
+    matrix::Future<double> trace = sum.then([](const matrix::SquareMat& m) { return m[0][0] + m[1][1] + m[2][2]; });
+    matrix::Future<int> rounded = trace.then([](double t) { return static_cast<int>(t + 0.5); });
+    CHECK(rounded.get() == static_cast<int>(expected[0][0] + expected[1][1] + expected[2][2] + 0.5));
+    CHECK(matrix::asyncDeterminant(a, scheduler).get() == doctest::Approx(!a));
+
+    // Exceptions reach get() and skip the continuations.
+    std::atomic<int> ran(0);
+    matrix::Future<matrix::SquareMat> failed = matrix::asyncMultiply(a, matrix::SquareMat(2), scheduler);
+    matrix::Future<int> skipped = failed.then([&ran](const matrix::SquareMat&) { return ++ran; });
+    CHECK_THROWS_AS(skipped.get(), std::invalid_argument);
+    CHECK_THROWS_AS(matrix::asyncAdd(failed, product).get(), std::invalid_argument);
+    CHECK(ran.load() == 0);
+
+    // Waiting from inside a task runs the queued tasks instead of blocking the pool.
+    matrix::TaskScheduler single(1);
+    matrix::Future<int> outer = matrix::runAsync([&single] {
+        return matrix::runAsync([] { return 20; }, single).get() + 1;
+    }, single);
+    CHECK(outer.get() == 21);
+
+    matrix::Promise<int> promise(scheduler);
+    matrix::Future<int> later = promise.getFuture().then([](int x) { return x * 2; });
+    CHECK(!promise.getFuture().isReady());
+    promise.setValue(4);
+    CHECK(later.get() == 8);
+    CHECK_THROWS_AS(promise.setValue(5), std::invalid_argument);
+}
+
+TEST_CASE("Lazy Evaluation and Common Subexpressions") {
+    const int n = 4;
+    matrix::SquareMat a(n), b(n), c(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            a[i][j] = i - 2.0 * j + 1.0;
+            b[i][j] = (i * j) % 3 - 1.0;
+            c[i][j] = i + j;
+        }
+    }
+
+    matrix::LazyGraph graph;
+    matrix::LazyMat la = graph.input(a);
+    matrix::LazyMat lb = graph.input(b);
+    matrix::LazyMat lc = graph.input(c);
+    CHECK(graph.input(a).getNode() == la.getNode());
+
+    // (A * B) + (A * B) % C builds A * B once.
+    matrix::LazyMat expression = (la * lb) + (la * lb) % lc;
+    CHECK(graph.getRequestedCount() == 4);
+    CHECK(graph.getNodeCount() == 6);
+    CHECK((la + lb).getNode() == (lb + la).getNode());
+    CHECK((la - lb).getNode() != (lb - la).getNode());
+    CHECK((la * 2.0).getNode() == (2.0 * la).getNode());
+    CHECK((la * 2.0).getNode() != (la * 3.0).getNode());
+    CHECK((~la).getNode() == (~la).getNode());
+
+    matrix::SquareMat expected = (a * b) + (a * b) % c;
+    CHECK(areMatricesEqual(graph.evaluate(expression), expected, 1e-12));
+    // Only the three operations the result needs, not the unused nodes built above.
+    CHECK(graph.getEvaluatedCount() == 3);
+
+    // Every other operator against the eager result.
+    matrix::LazyMat transposed = ~la;
+    matrix::LazyMat mixed = ((transposed * la) ^ 2) / 4.0 - (-(transposed % lb)) * 0.5 + (lc % 3.0);
+    matrix::SquareMat mixedExpected = ((~a * a) ^ 2) / 4.0 - (-(~a % b)) * 0.5 + (c % 3.0);
+    CHECK(areMatricesEqual(graph.evaluate(mixed), mixedExpected, 1e-9));
+
+    // A long chain reuses its buffers: intermediates die as soon as they are consumed.
+    matrix::LazyMat chain = la;
+    for (int i = 0; i < 20; ++i) {
+        chain = chain * lb + lc * static_cast<double>(i);
+    }
+    matrix::SquareMat chainExpected = a;
+    for (int i = 0; i < 20; ++i) {
+        chainExpected = chainExpected * b + c * static_cast<double>(i);
+    }
+    matrix::SquareMat chainValue = graph.evaluate(chain);
+    CHECK(areMatricesEqual(chainValue, chainExpected, 1e-9 * std::fabs(chainExpected[0][0]) + 1e-9));
+    CHECK(graph.getEvaluatedCount() == 60);
+    CHECK(graph.getBufferCount() <= 3);
+
+    // Several results share their sub-expressions.
+    std::vector<matrix::LazyMat> roots;
+    roots.push_back(la * lb);
+    roots.push_back((la * lb) * lc);
+    std::vector<matrix::SquareMat> values = graph.evaluate(roots);
+    CHECK(graph.getEvaluatedCount() == 2);
+    CHECK(areMatricesEqual(values[1], a * b * c, 1e-9));
+    CHECK(graph.evaluate(la) == a);
+
+    matrix::LazyGraph other;
+    matrix::LazyMat foreign = other.input(a);
+    CHECK_THROWS_AS(la + foreign, std::invalid_argument);
+    CHECK_THROWS_AS(graph.evaluate(foreign), std::invalid_argument);
+    CHECK_THROWS_AS(graph.input(matrix::SquareMat(2)), std::invalid_argument);
+    CHECK_THROWS_AS(la / 0.0, std::invalid_argument);
+}
+
+TEST_CASE("Matrix Functions") {
+    matrix::SquareMat identity(3);
+    identity[0][0] = identity[1][1] = identity[2][2] = 1.0;
+
+    // Diagonal and nilpotent matrices have closed forms.
+    matrix::SquareMat diagonal(3);
+    diagonal[0][0] = 0.5; diagonal[1][1] = -2.0; diagonal[2][2] = 3.0;
+    matrix::SquareMat expDiagonal = matrix::expm(diagonal);
+    CHECK(expDiagonal[0][0] == doctest::Approx(std::exp(0.5)).epsilon(1e-14));
+    CHECK(expDiagonal[1][1] == doctest::Approx(std::exp(-2.0)).epsilon(1e-14));
+    CHECK(expDiagonal[2][2] == doctest::Approx(std::exp(3.0)).epsilon(1e-14));
+    CHECK(expDiagonal[0][1] == 0.0);
+    matrix::SquareMat nilpotent(2);
+    nilpotent[0][1] = 1.0;
+    matrix::SquareMat expNilpotent = matrix::expm(nilpotent);
+    CHECK(expNilpotent[0][0] == doctest::Approx(1.0));
+    CHECK(expNilpotent[0][1] == doctest::Approx(1.0));
+    CHECK(expNilpotent[1][0] == 0.0);
+
+    // A rotation generator with a large norm goes through the squaring phase.
+    const double angles[] = {0.01, 1.0, 40.0};
+    for (int i = 0; i < 3; ++i) {
+        matrix::SquareMat generator(2);
+        generator[0][1] = -angles[i];
+        generator[1][0] = angles[i];
+        matrix::FunctionCost cost = {0, 0, 0};
+        matrix::SquareMat rotation = matrix::expm(generator, &cost);
+        CHECK(rotation[0][0] == doctest::Approx(std::cos(angles[i])).epsilon(1e-12));
+        CHECK(rotation[1][0] == doctest::Approx(std::sin(angles[i])).epsilon(1e-12));
+        CHECK(cost.solves == 1);
+        CHECK((cost.squarings > 0) == (angles[i] > 5.0));
+        if (angles[i] < 0.1) {
+            CHECK(cost.products <= 3);
+        }
+    }
+
+    matrix::SquareMat a(3);
+    a[0][0] = 4; a[0][1] = 1; a[0][2] = 0.5;
+    a[1][0] = 1; a[1][1] = 3; a[1][2] = -0.25;
+    a[2][0] = 0.5; a[2][1] = -0.25; a[2][2] = 2;
+    CHECK(areMatricesEqual(matrix::expm(a) * matrix::expm(-a), identity, 1e-10));
+
+    // Square root and logarithm invert square and exponential.
+    matrix::FunctionCost rootCost = {0, 0, 0};
+    matrix::SquareMat root = matrix::sqrtm(a, &rootCost);
+    CHECK(areMatricesEqual(root * root, a, 1e-12));
+    CHECK(rootCost.solves == rootCost.products);
+    matrix::SquareMat nonSymmetric(a);
+    nonSymmetric[0][2] = 2.0;
+    matrix::SquareMat nonSymmetricRoot = matrix::sqrtm(nonSymmetric);
+    CHECK(areMatricesEqual(nonSymmetricRoot * nonSymmetricRoot, nonSymmetric, 1e-12));
+
+    matrix::SquareMat logarithm = matrix::logm(a);
+    CHECK(areMatricesEqual(matrix::expm(logarithm), a, 1e-12));
+    matrix::SquareMat small = a * 0.1;
+    CHECK(areMatricesEqual(matrix::logm(matrix::expm(small)), small, 1e-13));
+    CHECK(areMatricesEqual(matrix::logm(identity), matrix::SquareMat(3), 1e-15));
+    matrix::SquareMat logDiagonal = matrix::logm(expDiagonal);
+    CHECK(areMatricesEqual(logDiagonal, diagonal, 1e-12));
+
+    // A negative eigenvalue has no real principal square root or logarithm.
+    matrix::SquareMat negative(identity);
+    negative[1][1] = -1.0;
+    CHECK_THROWS_AS(matrix::sqrtm(negative), std::invalid_argument);
+    CHECK_THROWS_AS(matrix::logm(negative), std::invalid_argument);
+    CHECK_THROWS_AS(matrix::sqrtm(matrix::SquareMat(2)), std::invalid_argument);
+}
+
+TEST_CASE("Symmetric Eigen Power") {
+    matrix::SquareMat a(3);
+    a[0][0] = 4; a[0][1] = 1; a[0][2] = 0.5;
+    a[1][0] = 1; a[1][1] = 3; a[1][2] = -0.25;
+    a[2][0] = 0.5; a[2][1] = -0.25; a[2][2] = 2;
+    matrix::SymmetricEigen eigen(a);
+    const std::vector<double>& values = eigen.getEigenvalues();
+    REQUIRE(values.size() == 3);
+    CHECK(values[0] <= values[1]);
+    CHECK(values[1] <= values[2]);
+    CHECK(values[0] + values[1] + values[2] == doctest::Approx(9.0).epsilon(1e-14));
+    CHECK(values[0] * values[1] * values[2] == doctest::Approx(!a).epsilon(1e-13));
+    for (int i = 0; i < 3; ++i) {
+        matrix::Vector v = eigen.getEigenvector(i);
+        CHECK(v.norm2() == doctest::Approx(1.0).epsilon(1e-14));
+        CHECK((a * v - v * values[i]).normInf() < 1e-13);
+    }
+    matrix::SquareMat vectors = eigen.getEigenvectors();
+    matrix::SquareMat identity(3);
+    identity[0][0] = identity[1][1] = identity[2][2] = 1.0;
+    CHECK(areMatricesEqual(~vectors * vectors, identity, 1e-14));
+
+    // Repeated eigenvalues and a larger matrix.
+    matrix::SquareMat repeated(identity);
+    repeated[2][2] = 5.0;
+    CHECK(matrix::SymmetricEigen(repeated).getEigenvalues() == std::vector<double>({1.0, 1.0, 5.0}));
+    const int n = 24;
+    matrix::SquareMat larger(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            larger[i][j] = larger[j][i] = ((i * 7 + j * 3) % 11) - 5.0;
+        }
+    }
+    matrix::SymmetricEigen largerEigen(larger);
+    matrix::SquareMat v = largerEigen.getEigenvectors();
+    matrix::SquareMat scaled(v);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            scaled[i][j] *= largerEigen.getEigenvalues()[j];
+        }
+    }
+    CHECK(areMatricesEqual(scaled * ~v, larger, 1e-12));
+    CHECK(areMatricesEqual(largerEigen.power(1), larger, 1e-12));
+    CHECK(areMatricesEqual(largerEigen.power(0), larger ^ 0, 1e-13));
+
+    // Repeated squaring is exact for integers, like the products it replaces.
+    matrix::BasicSquareMat<std::int64_t> integers(3);
+    integers[0][0] = 1; integers[0][1] = 2; integers[1][0] = -1; integers[2][1] = 3; integers[2][2] = 1;
+    matrix::BasicSquareMat<std::int64_t> product = integers;
+    for (int k = 2; k <= 13; ++k) {
+        product = product * integers;
+        CHECK((integers ^ k) == product);
+    }
+
+    // A diffusion kernel (I - L / 4 for a path graph) to a large power, against squaring.
+    const int nodes = 16;
+    matrix::SquareMat diffusion(nodes);
+    for (int i = 0; i < nodes; ++i) {
+        diffusion[i][i] = 1.0;
+        if (i > 0) {
+            diffusion[i][i - 1] = 0.25;
+            diffusion[i][i] -= 0.25;
+        }
+        if (i + 1 < nodes) {
+            diffusion[i][i + 1] = 0.25;
+            diffusion[i][i] -= 0.25;
+        }
+    }
+    CHECK(matrix::isSymmetric(diffusion));
+    matrix::SquareMat squared = diffusion ^ 1000;
+    matrix::SquareMat::setSpectralPowerThreshold(64);
+    CHECK(matrix::SquareMat::getSpectralPowerThreshold() == 64);
+    matrix::SquareMat spectral = diffusion ^ 1000;
+    CHECK(areMatricesEqual(spectral, squared, 1e-12));
+    CHECK(matrix::isSymmetric(spectral));
+    CHECK(spectral[0][nodes - 1] == doctest::Approx(1.0 / nodes).epsilon(1e-3));
+    // Below the threshold or for a non-symmetric matrix, the products are used.
+    CHECK(areMatricesEqual(diffusion ^ 3, diffusion * diffusion * diffusion, 1e-15));
+    matrix::SquareMat skewed(diffusion);
+    skewed[0][1] = 0.5;
+    skewed[0][0] = 0.25;
+    CHECK(areMatricesEqual(skewed ^ 100, (skewed ^ 50) * (skewed ^ 50), 1e-12));
+    // Symmetric but not finite: the eigensolver refuses it and squaring takes over.
+    matrix::SquareMat infinite(diffusion);
+    infinite[3][3] = std::numeric_limits<double>::infinity();
+    infinite[5][5] = std::numeric_limits<double>::quiet_NaN();
+    CHECK(matrix::isSymmetric(infinite));
+    CHECK_THROWS_AS(matrix::SymmetricEigen{infinite}, std::invalid_argument);
+    matrix::SquareMat fallback = infinite ^ 100;
+    matrix::SquareMat::setSpectralPowerThreshold(0);
+    matrix::SquareMat reference = infinite ^ 100;
+    bool same = true;
+    for (int i = 0; i < nodes; ++i) {
+        for (int j = 0; j < nodes; ++j) {
+            same = same && (fallback[i][j] == reference[i][j]
+                            || (std::isnan(fallback[i][j]) && std::isnan(reference[i][j])));
+        }
+    }
+    CHECK(same);
+
+    CHECK_THROWS_AS(matrix::SymmetricEigen{skewed}, std::invalid_argument);
+    CHECK_THROWS_AS(matrix::SquareMat::setSpectralPowerThreshold(-1), std::invalid_argument);
+    CHECK_THROWS_AS(eigen.getEigenvector(3), std::out_of_range);
+    CHECK_THROWS_AS(eigen.power(-1), std::invalid_argument);
+}
+
+TEST_CASE("Symmetric Eigensolver and SVD") {
+    // Residuals and orthogonality on a matrix large enough for the parallel paths (with more
+    // than one thread) and for several batches of buffered rotations.
+    const int n = 260;
+    matrix::SquareMat symmetric(n);
+    matrix::SquareMat general(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            general[i][j] = std::sin(0.37 * i * i + 1.3 * j) + (i == j ? 2.0 : 0.0);
+        }
+        for (int j = 0; j <= i; ++j) {
+            symmetric[i][j] = symmetric[j][i] = std::cos(0.11 * i * j + 0.7 * (i + j));
+        }
+    }
+    matrix::SquareMat identity(n);
+    for (int i = 0; i < n; ++i) {
+        identity[i][i] = 1.0;
+    }
+    matrix::SymmetricEigen eigen(symmetric);
+    matrix::SquareMat v = eigen.getEigenvectors();
+    matrix::SquareMat av = symmetric * v;
+    double residual = 0.0;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            residual = std::max(residual, std::fabs(av[i][j] - v[i][j] * eigen.getEigenvalues()[j]));
+        }
+    }
+    CHECK(residual < 1e-11);
+    CHECK(areMatricesEqual(~v * v, identity, 1e-12));
+
+    matrix::SingularValueDecomposition svd(general);
+    const std::vector<double>& sigma = svd.getSingularValues();
+    for (int i = 1; i < n; ++i) {
+        CHECK(sigma[i - 1] >= sigma[i]);
+    }
+    matrix::SquareMat u = svd.getU();
+    matrix::SquareMat right = svd.getV();
+    CHECK(areMatricesEqual(~u * u, identity, 1e-12));
+    CHECK(areMatricesEqual(~right * right, identity, 1e-12));
+    matrix::SquareMat scaled(u);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            scaled[i][j] *= sigma[j];
+        }
+    }
+    CHECK(areMatricesEqual(scaled * ~right, general, 1e-11));
+    CHECK(svd.getSweepCount() <= 15);
+    CHECK(svd.getRank() == n);
+    // The squared singular values are the eigenvalues of A^T A.
+    matrix::SymmetricEigen gram(~general * general);
+    CHECK(sigma[0] * sigma[0] == doctest::Approx(gram.getEigenvalues().back()).epsilon(1e-12));
+    CHECK(matrix::SingularValueDecomposition(general, false).getSingularValues() == sigma);
+    CHECK(matrix::conditionNumber(general) == doctest::Approx(sigma[0] / sigma[n - 1]).epsilon(1e-14));
+
+    // Tiny singular values keep their relative accuracy; zero ones give an orthogonal U.
+    matrix::SquareMat graded(3);
+    graded[0][0] = 1.0; graded[0][1] = 1.0;
+    graded[1][1] = 1e-10;
+    graded[2][2] = 1e-20;
+    matrix::SingularValueDecomposition gradedSvd(graded);
+    CHECK(gradedSvd.getSingularValues()[2] == doctest::Approx(1e-20).epsilon(1e-14));
+    CHECK(gradedSvd.getSingularValues()[1] == doctest::Approx(1e-10 / std::sqrt(2.0)).epsilon(1e-12));
+    CHECK(gradedSvd.getConditionNumber() == doctest::Approx(std::sqrt(2.0) / 1e-20).epsilon(1e-12));
+    matrix::SquareMat rankTwo(3);
+    rankTwo[0][0] = 3.0; rankTwo[0][1] = 4.0; rankTwo[1][2] = 2.0;
+    matrix::SingularValueDecomposition rankTwoSvd(rankTwo);
+    CHECK(rankTwoSvd.getSingularValues() == std::vector<double>({5.0, 2.0, 0.0}));
+    CHECK(rankTwoSvd.getRank() == 2);
+    CHECK(rankTwoSvd.getConditionNumber() == std::numeric_limits<double>::infinity());
+    matrix::SquareMat identity3(3);
+    identity3[0][0] = identity3[1][1] = identity3[2][2] = 1.0;
+    CHECK(areMatricesEqual(~rankTwoSvd.getU() * rankTwoSvd.getU(), identity3, 1e-15));
+
+    CHECK_THROWS_AS(matrix::SingularValueDecomposition(general, false).getU(), std::invalid_argument);
+    matrix::SquareMat infinite(2);
+    infinite[1][0] = std::numeric_limits<double>::infinity();
+    CHECK_THROWS_AS(matrix::SingularValueDecomposition{infinite}, std::invalid_argument);
+}
+
+TEST_CASE("Log-Determinant") {
+    // det(100 I + E) is about 10^600 at n = 300: operator! overflows, logAbsDet() does not.
+    const int n = 300;
+    matrix::SquareMat large(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            large[i][j] = (i == j ? 100.0 : 0.0) + std::sin(0.5 * i + 0.3 * j);
+        }
+    }
+    CHECK(std::isinf(!large));
+    matrix::LogDeterminant logDet = large.logAbsDet();
+    CHECK(logDet.sign == 1);
+    CHECK(logDet.logAbs > 600.0 * std::log(10.0) - 10.0);
+    CHECK(logDet.logAbs < 600.0 * std::log(10.0) + 10.0);
+    // Scaling by 1/100 brings the determinant near 1, by 10^-4 down to about 10^-600.
+    matrix::SquareMat scaled = large * 0.01;
+    CHECK(!scaled == doctest::Approx(std::exp(scaled.logAbsDet().logAbs)).epsilon(1e-10));
+    matrix::SquareMat small = large * 1e-4;
+    CHECK(!small == 0.0);
+    CHECK(small.logAbsDet().logAbs == doctest::Approx(logDet.logAbs - n * std::log(1e4)).epsilon(1e-12));
+    // The parallel factorization gives the same result.
+    matrix::TaskScheduler scheduler(4);
+    matrix::LogDeterminant parallel = matrix::LUDecomposition(large, scheduler).logDeterminant();
+    CHECK(parallel.sign == logDet.sign);
+    CHECK(parallel.logAbs == logDet.logAbs);
+
+    // Swapping two rows flips the sign; the cached factorization is used and filled.
+    matrix::SquareMat swapped(large);
+    std::swap_ranges(swapped[0], swapped[0] + n, swapped[1]);
+    swapped.setFactorCaching(true);
+    CHECK(swapped.logAbsDet().sign == -1);
+    CHECK(swapped.hasCachedFactorization());
+    CHECK(swapped.logAbsDet().logAbs == doctest::Approx(logDet.logAbs).epsilon(1e-12));
+
+    // Partial products that overflow no longer spoil a representable determinant.
+    matrix::SquareMat diagonal(4);
+    diagonal[0][0] = 1e300; diagonal[1][1] = 1e300; diagonal[2][2] = -1e-300; diagonal[3][3] = 1e-300;
+    CHECK(!diagonal == doctest::Approx(-1.0).epsilon(1e-12));
+    CHECK(diagonal.logAbsDet().sign == -1);
+    CHECK(diagonal.logAbsDet().logAbs == doctest::Approx(0.0));
+    matrix::SquareMat singular(4);
+    CHECK(singular.logAbsDet().sign == 0);
+    CHECK(singular.logAbsDet().logAbs == -std::numeric_limits<double>::infinity());
+}
+
+TEST_CASE("Exact Determinant") {
+    // ModMat's determinant modulo a prime; a composite modulus without an invertible pivot throws.
+    matrix::ModMat mod(3, 7);
+    const int values[3][3] = {{2, 0, 1}, {1, 3, 2}, {1, 1, 4}};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            mod.set(i, j, values[i][j]);
+        }
+    }
+    CHECK(!mod == 18 % 7);
+    matrix::ModMat even(2, 4);
+    even.set(0, 0, 2); even.set(1, 1, 2);
+    CHECK_THROWS_AS(!even, std::invalid_argument);
+    CHECK(!matrix::ModMat(2, 4) == 0);
+
+    // Small determinants stay on the Bareiss path.
+    matrix::BasicSquareMat<std::int64_t> small(2);
+    small[0][0] = 3000000000LL; small[0][1] = 7;
+    small[1][0] = 3;            small[1][1] = -2000000000LL;
+    matrix::ExactDeterminant det = matrix::exactDeterminant(small);
+    CHECK(det.getMethod() == matrix::ExactMethod::Bareiss);
+    CHECK(det.toInt64() == -3000000000LL * 2000000000LL - 21);
+    CHECK(det.toString() == "-6000000000000000021");
+    CHECK(det.getSign() == -1);
+
+    // A = L U with unit lower L and diag(U) = 10: det A = 10^60, far beyond 128 bits, so it
+    // is reconstructed from its residues.
+    const int n = 60;
+    matrix::BasicSquareMat<std::int64_t> lower(n), upper(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            lower[i][j] = i == j ? 1 : (j < i ? (i * 7 + j * 3) % 5 - 2 : 0);
+            upper[i][j] = i == j ? 10 : (j > i ? (i * 5 + j * 11) % 7 - 3 : 0);
+        }
+    }
+    matrix::BasicSquareMat<std::int64_t> product = lower * upper;
+    det = matrix::exactDeterminant(product);
+    CHECK(det.getMethod() == matrix::ExactMethod::MultiModular);
+    CHECK(det.getPrimeCount() >= 4);
+    CHECK(det.toString() == "1" + std::string(n, '0'));
+    CHECK(det.getBitLength() == 200);
+    CHECK(det.toDouble() == doctest::Approx(1e60).epsilon(1e-12));
+    CHECK_FALSE(det.fitsInt64());
+    CHECK_THROWS_AS(det.toInt64(), std::out_of_range);
+    std::swap_ranges(product[0], product[0] + n, product[1]);
+    matrix::ExactDeterminant negative = matrix::exactDeterminant(product);
+    CHECK(negative.toString() == "-1" + std::string(n, '0'));
+    CHECK(negative != det);
+    std::stringstream printed;
+    printed << negative;
+    CHECK(printed.str() == negative.toString());
+
+    // The element type's determinant is exact, or throws rather than wrapping.
+    CHECK_THROWS_AS(!product, std::out_of_range);
+    matrix::BasicSquareMat<std::int32_t> narrow(2);
+    narrow[0][0] = 100000; narrow[1][1] = 100000;
+    CHECK_THROWS_AS(!narrow, std::out_of_range);
+    narrow[1][1] = 20000;
+    CHECK(!narrow == 2000000000);
+
+    // Integer-valued double matrices, including their singular cases.
+    matrix::SquareMat doubles(4);
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            doubles[i][j] = static_cast<double>((i + 1) * (j + 2) % 5);
+        }
+    }
+    CHECK(matrix::exactDeterminant(doubles).toDouble() == doctest::Approx(!doubles));
+    doubles[3][3] = 0.5;
+    CHECK_THROWS_AS(matrix::exactDeterminant(doubles), std::invalid_argument);
+    CHECK(matrix::exactDeterminant(matrix::SquareMat(5)).getSign() == 0);
+}
+
+TEST_CASE("Inverse Updates") {
+    const int n = 40;
+    matrix::SquareMat a(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            a[i][j] = (i == j ? 4.0 : 0.0) + std::sin(1.3 * i + 0.7 * j);
+        }
+    }
+    matrix::InverseUpdater updater(a);
+    updater.setRefreshInterval(0);
+    std::vector<double> u(n), v(n);
+    for (int i = 0; i < n; ++i) {
+        u[i] = std::cos(0.4 * i);
+        v[i] = 0.1 * std::sin(0.9 * i);
+    }
+    // Each change is checked against a fresh factorization of the resulting matrix.
+    for (int step = 0; step < 4; ++step) {
+        if (step == 0) {
+            updater.rankOneUpdate(u, v);
+        } else if (step == 1) {
+            updater.replaceRow(3, u);
+        } else if (step == 2) {
+            updater.replaceColumn(7, v);
+        } else {
+            updater.set(5, 11, -2.5);
+        }
+        matrix::LUDecomposition lu(updater.getMatrix());
+        CHECK(updater.determinant() == doctest::Approx(lu.determinant()).epsilon(1e-10));
+        CHECK(updater.logDeterminant().sign == lu.logDeterminant().sign);
+        CHECK(areMatricesEqual(updater.getInverse(), lu.inverse(), 1e-10));
+    }
+    CHECK(updater.getMatrix()[3][0] == u[0]);
+    CHECK(updater.getMatrix()[1][7] == v[1]);
+    CHECK(updater.getMatrix()[5][11] == -2.5);
+    CHECK(updater.getFactorCount() == 1);
+    std::vector<double> x = updater.solve(u);
+    std::vector<double> expected = matrix::LUDecomposition(updater.getMatrix()).solve(u);
+    for (int i = 0; i < n; ++i) {
+        CHECK(x[i] == doctest::Approx(expected[i]).epsilon(1e-10));
+    }
+
+    // A duplicated row cancels the determinant lemma exactly: the matrix is factored again,
+    // found singular, and recovers when the row is restored.
+    std::vector<double> saved(updater.getMatrix()[1], updater.getMatrix()[1] + n);
+    updater.replaceRow(1, std::vector<double>(updater.getMatrix()[0], updater.getMatrix()[0] + n));
+    CHECK(updater.isSingular());
+    CHECK(updater.determinant() == 0.0);
+    CHECK(updater.logDeterminant().sign == 0);
+    CHECK_THROWS_AS(updater.getInverse(), std::invalid_argument);
+    CHECK(updater.getFactorCount() == 2);
+    updater.replaceRow(1, saved);
+    CHECK_FALSE(updater.isSingular());
+    CHECK(updater.determinant() == doctest::Approx(matrix::LUDecomposition(updater.getMatrix()).determinant()));
+
+    // Periodic refresh, and bad arguments.
+    updater.setRefreshInterval(2);
+    const int before = updater.getFactorCount();
+    updater.set(0, 0, 5.0);
+    updater.set(0, 1, 1.0);
+    CHECK(updater.getFactorCount() == before + 1);
+    CHECK_THROWS_AS(updater.setRefreshInterval(-1), std::invalid_argument);
+    CHECK_THROWS_AS(updater.replaceRow(n, u), std::out_of_range);
+    CHECK_THROWS_AS(updater.set(0, -1, 1.0), std::out_of_range);
+    CHECK_THROWS_AS(updater.rankOneUpdate(u, std::vector<double>(3)), std::invalid_argument);
+}
+
+TEST_CASE("Huge Page Storage") {
+    const matrix::PageBacking savedPages = matrix::FormatPolicy::getHugePages();
+    const std::size_t savedThreshold = matrix::FormatPolicy::getHugePageThreshold();
+    matrix::FormatPolicy::setHugePageThreshold(0);
+
+    // Regular storage is the reference for every other backing.
+    matrix::FormatPolicy::setHugePages(matrix::PageBacking::Regular);
+    const int n = 300;
+    matrix::SquareMat reference(n);
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            reference[i][j] = std::sin(0.01 * i * j + i);
+        }
+    }
+    CHECK(reference.getPageBacking() == matrix::PageBacking::Regular);
+    const matrix::SquareMat expected = reference * reference;
+
+    const matrix::PageBacking modes[2] = {matrix::PageBacking::TransparentHuge, matrix::PageBacking::ExplicitHuge};
+    for (int m = 0; m < 2; ++m) {
+        matrix::FormatPolicy::setHugePages(modes[m]);
+        matrix::SquareMat zero(n);
+        CHECK(zero[n - 1][n - 1] == 0.0);
+        // TransparentHuge never yields hugetlbfs pages; without reserved ones, ExplicitHuge
+        // falls back to transparent huge pages, and both fall back to the heap.
+        const matrix::PageBacking backing = zero.getPageBacking();
+        if (modes[m] == matrix::PageBacking::TransparentHuge) {
+            CHECK((backing == matrix::PageBacking::TransparentHuge || backing == matrix::PageBacking::Regular));
+        } else {
+            CHECK(backing != matrix::PageBacking::Mapped);
+        }
+        matrix::SquareMat copy(reference);
+        matrix::SquareMat assigned(5);
+        assigned = reference;
+        CHECK(copy == reference);
+        CHECK(areMatricesEqual(copy * assigned, expected, 0.0));
+        matrix::BasicSquareMat<std::complex<double>> complexZero(n);
+        CHECK(complexZero[n - 1][0] == std::complex<double>());
+    }
+#ifdef __linux__
+    // madvise(MADV_HUGEPAGE) only fails on kernels built without transparent huge pages.
+    if (std::ifstream("/sys/kernel/mm/transparent_hugepage/enabled").good()) {
+        matrix::FormatPolicy::setHugePages(matrix::PageBacking::TransparentHuge);
+        CHECK(matrix::SquareMat(n).getPageBacking() == matrix::PageBacking::TransparentHuge);
+    }
+#endif
+
+    // Below the threshold, or with Regular, matrices come from the heap.
+    matrix::FormatPolicy::setHugePageThreshold(static_cast<std::size_t>(n) * n * sizeof(double) + 1);
+    CHECK(matrix::SquareMat(n).getPageBacking() == matrix::PageBacking::Regular);
+    matrix::FormatPolicy::setHugePages(savedPages);
+    matrix::FormatPolicy::setHugePageThreshold(savedThreshold);
+    CHECK(matrix::SquareMat(2).getPageBacking() == matrix::PageBacking::Regular);
+}
+
+TEST_CASE("NUMA Placement") {
+    const matrix::NumaPlacement savedPlacement = matrix::FormatPolicy::getNumaPlacement();
+    const int savedNode = matrix::FormatPolicy::getNumaNode();
+    const int nodes = matrix::getNumaNodeCount();
+    CHECK(nodes >= 1);
+
+    // 1024 x 1024 doubles reach NUMA_THRESHOLD. A node that does not exist falls back to
+    // first touch.
+    const int n = 1024;
+    const matrix::NumaPlacement placements[4] = {matrix::NumaPlacement::FirstTouch, matrix::NumaPlacement::Interleave,
+                                                 matrix::NumaPlacement::Bind, matrix::NumaPlacement::Bind};
+    const int bindNodes[4] = {0, 0, 0, nodes};
+    for (int p = 0; p < 4; ++p) {
+        matrix::FormatPolicy::setNumaPlacement(placements[p], bindNodes[p]);
+        CHECK(matrix::FormatPolicy::getNumaPlacement() == placements[p]);
+        CHECK(matrix::FormatPolicy::getNumaNode() == bindNodes[p]);
+        matrix::SquareMat a(n);
+#ifdef __linux__
+        CHECK(a.getPageBacking() == matrix::PageBacking::Mapped);
+#endif
+        bool zero = true;
+        for (int i = 0; i < n; i += 7) {
+            zero = zero && a[i][0] == 0.0 && a[i][n - 1] == 0.0 && a[n - 1 - i][i] == 0.0;
+        }
+        CHECK(zero);
+        a[n - 1][n - 1] = 2.0;
+        matrix::SquareMat copy(a);
+        CHECK(copy[n - 1][n - 1] == 2.0);
+        matrix::BasicSquareMat<std::int64_t> integers(n);
+        CHECK(integers[n / 2][n / 3] == 0);
+    }
+    matrix::FormatPolicy::setNumaPlacement(matrix::NumaPlacement::CallingThread);
+    CHECK(matrix::SquareMat(n).getPageBacking() == matrix::PageBacking::Regular);
+    CHECK_THROWS_AS(matrix::FormatPolicy::setNumaPlacement(matrix::NumaPlacement::Bind, -1), std::invalid_argument);
+
+    // bindPages() itself: only Interleave and Bind set a policy, on whole pages of existing nodes.
+    // On a mapping, so that the policy goes with it instead of staying on heap pages.
+    const std::size_t bytes = static_cast<std::size_t>(8) << 20;
+    matrix::PageBacking obtained = matrix::PageBacking::Regular;
+    void* buffer = matrix::mapPages(bytes, obtained);
+    CHECK_FALSE(matrix::bindPages(buffer, bytes, matrix::NumaPlacement::FirstTouch, 0));
+    CHECK_FALSE(matrix::bindPages(buffer, bytes, matrix::NumaPlacement::Bind, nodes));
+    CHECK_FALSE(matrix::bindPages(buffer, 100, matrix::NumaPlacement::Bind, 0));
+#ifdef __linux__
+    REQUIRE(buffer != nullptr);
+    CHECK(obtained == matrix::PageBacking::Mapped);
+    if (std::ifstream("/sys/devices/system/node/online").good()) {
+        CHECK(matrix::bindPages(buffer, bytes, matrix::NumaPlacement::Bind, 0));
+        CHECK(matrix::bindPages(buffer, bytes, matrix::NumaPlacement::Interleave, 0));
+    }
+#endif
+    matrix::releasePages(buffer, bytes, obtained);
+    matrix::FormatPolicy::setNumaPlacement(savedPlacement, savedNode);
+}
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+// Coroutine pipelines, built by make test20.
+matrix::Task<matrix::SquareMat> transposedProduct(matrix::SquareMat a, matrix::SquareMat b) {
+    matrix::SquareMat product = co_await matrix::asyncMultiply(~a, b);
+    co_return product;
+}
+
+matrix::Task<double> determinantPipeline(matrix::SquareMat a, matrix::SquareMat b) {
+    matrix::SquareMat product = co_await transposedProduct(a, b);
+    matrix::SquareMat squared = co_await matrix::asyncPower(product, 2);
+    double determinant = co_await matrix::asyncDeterminant(squared);
+    co_return determinant;
+}
+
+matrix::Task<int> gatedStep(const std::atomic<bool>* open) {
+    while (!open->load()) {
+        std::this_thread::yield();
+    }
+    co_return 1;
+}
+
+matrix::Task<int> failingPipeline(matrix::SquareMat a) {
+    matrix::SquareMat product = co_await matrix::asyncMultiply(a, matrix::SquareMat(a.getSize() + 1));
+    co_return product.getSize();
+}
+
+TEST_CASE("Coroutine Pipelines") {
+    matrix::SquareMat a(3), b(3);
+    a[0][0] = 2; a[0][1] = 1; a[1][1] = 3; a[2][0] = 1; a[2][2] = 1;
+    b[0][0] = 1; b[1][0] = 4; b[1][1] = 1; b[2][1] = 2; b[2][2] = 5;
+    const double expected = !((~a * b) ^ 2);
+
+    // Many pipelines in flight at once, none of them blocking a worker.
+    std::vector<matrix::Task<double>> tasks;
+    for (int i = 0; i < 16; ++i) {
+        tasks.push_back(determinantPipeline(a, b));
+    }
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        CHECK(tasks[i].get() == doctest::Approx(expected));
+        CHECK(tasks[i].isReady());
+    }
+
+    // The coroutine is queued, not run by the calling thread (which would spin forever here).
+    std::atomic<bool> open(false);
+    matrix::Task<int> gated = gatedStep(&open);
+    open.store(true);
+    CHECK(gated.get() == 1);
+
+    // A task's future chains with the async API.
+    matrix::Future<bool> positive = determinantPipeline(a, b).getFuture().then([](double d) { return d > 0; });
+    CHECK(positive.get() == (expected > 0));
+
+    CHECK_THROWS_AS(failingPipeline(a).get(), std::invalid_argument);
+}
+#endif